@@ -3,6 +3,20 @@ cbuffer cbPerFrame : register(b0)
     float4x4 viewProjection;
 }
 
+// must match CompactSpriteBatchConstants
+cbuffer cbCompactBatch : register(b1)
+{
+    float2 batchOrigin;
+    float positionStep;
+    float unused;
+}
+
+// set per texture, see SpriteSource::MAX_UV_RECTS
+cbuffer cbUVRects : register(b2)
+{
+    float4 uvRects[4096];
+}
+
 Texture2D g_ColorTexture : register(t0);
 SamplerState g_ColorSampler : register(s0);
 
@@ -21,6 +35,19 @@ struct VSInput
     float rotation : ROTATION;
 };
 
+struct VSInputCompact
+{
+    // per vertex
+    float2 pos : QUAD_POSITION;
+    float2 uv : TEXCOORD;
+
+    // per instance, quantized
+    float4 colorTint : COLOR;
+    int2 position : SPRITE_POSITION;
+    float2 scale : SCALE;
+    uint2 rotationAndUVRect : ROTATION_UV_RECT;
+};
+
 struct PSInput
 {
     float4 pos : SV_POSITION;
@@ -28,7 +55,7 @@ struct PSInput
     float2 uv : TEXCOORD;
 };
 
-PSInput VSMain(VSInput vin)
+PSInput TransformSprite(VSInput vin)
 {
     PSInput vout;
 
@@ -51,6 +78,28 @@ PSInput VSMain(VSInput vin)
     return vout;
 }
 
+PSInput VSMain(VSInput vin)
+{
+    return TransformSprite(vin);
+}
+
+PSInput VSMainCompact(VSInputCompact vin)
+{
+    float4 uvRect = uvRects[vin.rotationAndUVRect.y];
+
+    VSInput expanded;
+    expanded.pos = vin.pos;
+    expanded.uv = vin.uv;
+    expanded.colorTint = vin.colorTint;
+    expanded.position = batchOrigin + float2(vin.position) * positionStep;
+    expanded.uvMin = uvRect.xy;
+    expanded.uvMax = uvRect.zw;
+    expanded.scale = vin.scale;
+    expanded.rotation = float(vin.rotationAndUVRect.x) * (6.28318530718f / 65536.0f);
+
+    return TransformSprite(expanded);
+}
+
 float4 PSMain(PSInput pin) : SV_TARGET
 {
     float4 textureColor = g_ColorTexture.Sample(g_ColorSampler, pin.uv);
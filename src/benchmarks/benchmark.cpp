@@ -0,0 +1,36 @@
+#include <benchmarks/pch.h>
+
+#include <benchmarks/benchmark.h>
+
+namespace cgt::bench
+{
+
+std::vector<Benchmark>& GetBenchmarks()
+{
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+}
+
+// runs all of the benchmarks, or only the ones whose names are passed as arguments
+int GameMain(int argc, char** argv)
+{
+    for (auto& benchmark : cgt::bench::GetBenchmarks())
+    {
+        const bool selected = argc <= 1 || std::any_of(argv + 1, argv + argc, [&](const char* name) {
+            return std::strcmp(name, benchmark.name) == 0;
+        });
+
+        if (!selected)
+        {
+            continue;
+        }
+
+        fmt::print("=== {}\n", benchmark.name);
+        benchmark.function();
+        fmt::print("\n");
+    }
+
+    return 0;
+}
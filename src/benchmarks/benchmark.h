@@ -0,0 +1,52 @@
+#pragma once
+
+namespace cgt::bench
+{
+
+typedef void (*BenchmarkFunction)();
+
+struct Benchmark
+{
+    const char* name;
+    BenchmarkFunction function;
+};
+
+std::vector<Benchmark>& GetBenchmarks();
+
+struct BenchmarkRegistrar
+{
+    BenchmarkRegistrar(const char* name, BenchmarkFunction function)
+    {
+        GetBenchmarks().push_back({ name, function });
+    }
+};
+
+// runs the function the given amount of times and returns the average duration of a single run in milliseconds
+template<typename TFunction>
+double MeasureAverageMs(u32 iterations, TFunction&& function)
+{
+    const u64 start = SDL_GetPerformanceCounter();
+    for (u32 i = 0; i < iterations; ++i)
+    {
+        function();
+    }
+    const u64 end = SDL_GetPerformanceCounter();
+
+    const double totalMs = (end - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+    return totalMs / iterations;
+}
+
+// keeps the compiler from dropping computations whose results are otherwise unused
+template<typename T>
+void KeepAlive(const T& value)
+{
+    static volatile T sink;
+    sink = value;
+}
+
+}
+
+#define CGT_BENCHMARK(name)                                                                     \
+static void name();                                                                             \
+static cgt::bench::BenchmarkRegistrar CGT_BENCHMARK_registrar_##name(#name, &name);             \
+static void name()
@@ -0,0 +1,62 @@
+#include <benchmarks/pch.h>
+
+#include <benchmarks/benchmark.h>
+
+namespace
+{
+
+// enough math per element for the chunks to be dominated by work rather than by scheduling
+float HeavyKernel(u32 idx)
+{
+    float x = (float)idx * 0.001f;
+    for (u32 i = 0; i < 32; ++i)
+    {
+        x = glm::sin(x) * 0.5f + glm::sqrt(x * x + 1.0f);
+    }
+    return x;
+}
+
+}
+
+CGT_BENCHMARK(JobSystemScaling)
+{
+    const u32 ELEMENT_COUNT = 1 << 18;
+    const u32 CHUNK_SIZE = 4096;
+    const u32 ITERATIONS = 10;
+
+    std::vector<float> results(ELEMENT_COUNT);
+    auto kernel = [&](u32 begin, u32 end) {
+        for (u32 i = begin; i < end; ++i)
+        {
+            results[i] = HeavyKernel(i);
+        }
+    };
+
+    const double serialMs = cgt::bench::MeasureAverageMs(ITERATIONS, [&]() { kernel(0, ELEMENT_COUNT); });
+
+    fmt::print("{:>10} {:>12} {:>12}\n", "threads", "ms", "speedup");
+    fmt::print("{:>10} {:>12.3f} {:>11.2f}x\n", "serial", serialMs, 1.0);
+
+    const u32 maxThreads = std::max(std::thread::hardware_concurrency(), 2u);
+    for (u32 threads = 2; threads <= maxThreads; threads *= 2)
+    {
+        cgt::JobSystem jobSystem(threads - 1);
+        const double parallelMs = cgt::bench::MeasureAverageMs(ITERATIONS, [&]() {
+            jobSystem.ParallelFor(ELEMENT_COUNT, CHUNK_SIZE, kernel);
+        });
+        fmt::print("{:>10} {:>12.3f} {:>11.2f}x\n", threads, parallelMs, serialMs / parallelMs);
+    }
+
+    // overhead of the scheduling itself, with jobs that do nothing
+    cgt::JobSystem jobSystem;
+    const u32 EMPTY_JOB_COUNT = 100000;
+    const double emptyJobsMs = cgt::bench::MeasureAverageMs(ITERATIONS, [&]() {
+        cgt::JobCounter counter;
+        for (u32 i = 0; i < EMPTY_JOB_COUNT; ++i)
+        {
+            jobSystem.Schedule([]() {}, &counter);
+        }
+        jobSystem.Wait(counter);
+    });
+    fmt::print("Empty job overhead on {} threads: {:.1f}ns per job\n", jobSystem.GetThreadCount(), emptyJobsMs * 1e6 / EMPTY_JOB_COUNT);
+}
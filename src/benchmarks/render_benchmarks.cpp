@@ -0,0 +1,645 @@
+#include <benchmarks/pch.h>
+
+#include <benchmarks/benchmark.h>
+
+namespace
+{
+
+void FillDrawList(const std::vector<cgt::render::SpriteDrawRequest>& sprites, cgt::render::SpriteDrawList& outDrawList)
+{
+    outDrawList.clear();
+    for (const cgt::render::SpriteDrawRequest& sprite : sprites)
+    {
+        outDrawList.AddSprite() = sprite;
+    }
+}
+
+}
+
+CGT_BENCHMARK(SpriteSort)
+{
+    using namespace cgt::render;
+
+    const u32 LAYER_COUNT = 8;
+    const u32 TEXTURE_COUNT = 32;
+    const u32 SPRITE_COUNTS[] = { 10000, 100000, 1000000 };
+
+    // the std::sort baseline uses the comparator SortForRendering had before the radix sort, fixed to be a strict weak ordering,
+    // the original one (a.layer < b.layer || aKey < bKey) isn't one and may even read out of bounds
+    auto comparator = [](const SpriteDrawRequest& a, const SpriteDrawRequest& b)
+    {
+        return a.layer < b.layer || (a.layer == b.layer && a.src.texture.index < b.src.texture.index);
+    };
+
+    fmt::print("{:>10} {:>14} {:>14} {:>14} {:>10}\n", "sprites", "std::sort ms", "stable ms", "radix ms", "speedup");
+    for (u32 spriteCount : SPRITE_COUNTS)
+    {
+        std::mt19937 random(1337);
+        std::vector<SpriteDrawRequest> sprites(spriteCount);
+        for (SpriteDrawRequest& sprite : sprites)
+        {
+            sprite.layer = (u8)(random() % LAYER_COUNT);
+            sprite.src.texture.index = (u16)(random() % TEXTURE_COUNT + 1);
+            sprite.position = glm::vec2((float)(random() % 1000), (float)(random() % 1000));
+        }
+
+        const u32 iterations = glm::max(1u, 1000000u / spriteCount);
+
+        // every run sorts a fresh copy, the time of the copy alone is subtracted
+        std::vector<SpriteDrawRequest> sortedSprites;
+        const double copyMs = cgt::bench::MeasureAverageMs(iterations, [&]() { sortedSprites = sprites; });
+        const double stdSortMs = cgt::bench::MeasureAverageMs(iterations, [&]() {
+            sortedSprites = sprites;
+            std::sort(sortedSprites.begin(), sortedSprites.end(), comparator);
+        }) - copyMs;
+        const double stableSortMs = cgt::bench::MeasureAverageMs(iterations, [&]() {
+            sortedSprites = sprites;
+            std::stable_sort(sortedSprites.begin(), sortedSprites.end(), comparator);
+        }) - copyMs;
+
+        SpriteDrawList drawList;
+        const double fillMs = cgt::bench::MeasureAverageMs(iterations, [&]() { FillDrawList(sprites, drawList); });
+        const double radixSortMs = cgt::bench::MeasureAverageMs(iterations, [&]() {
+            FillDrawList(sprites, drawList);
+            drawList.SortForRendering();
+        }) - fillMs;
+
+        // the radix sort is stable, so it has to match std::stable_sort exactly
+        for (u32 i = 0; i < spriteCount; ++i)
+        {
+            CGT_ASSERT_ALWAYS_MSG(drawList[i].layer == sortedSprites[i].layer
+                && drawList[i].src.texture == sortedSprites[i].src.texture
+                && drawList[i].position == sortedSprites[i].position,
+                "Radix sort differs from std::stable_sort at {}", i);
+        }
+
+        fmt::print("{:>10} {:>14.3f} {:>14.3f} {:>14.3f} {:>9.2f}x\n", spriteCount, stdSortMs, stableSortMs, radixSortMs, stdSortMs / radixSortMs);
+    }
+}
+
+CGT_BENCHMARK(SpriteDrawListBuild)
+{
+    using namespace cgt::render;
+
+    const u32 SPRITE_COUNT = 100000;
+    const u32 ITERATIONS = 100;
+
+    std::vector<SpriteDrawRequest> sprites(SPRITE_COUNT);
+    for (u32 i = 0; i < SPRITE_COUNT; ++i)
+    {
+        sprites[i].src.texture.index = (u16)(i % 32 + 1);
+        sprites[i].position = glm::vec2((float)i, 0.0f);
+    }
+
+    // sprites are trivially copyable, so building a draw list should run close to a plain memcpy of the same bytes
+    std::vector<SpriteDrawRequest> copy(SPRITE_COUNT);
+    const double memcpyMs = cgt::bench::MeasureAverageMs(ITERATIONS, [&]() {
+        std::memcpy(copy.data(), sprites.data(), sizeof(SpriteDrawRequest) * SPRITE_COUNT);
+        cgt::bench::KeepAlive(copy[SPRITE_COUNT / 2].position.x);
+    });
+
+    SpriteDrawList drawList;
+    const double buildMs = cgt::bench::MeasureAverageMs(ITERATIONS, [&]() {
+        FillDrawList(sprites, drawList);
+        cgt::bench::KeepAlive(drawList[SPRITE_COUNT / 2].position.x);
+    });
+
+    const double megabytes = sizeof(SpriteDrawRequest) * SPRITE_COUNT / (1024.0 * 1024.0);
+    fmt::print("{} sprites, {} bytes each\n", SPRITE_COUNT, sizeof(SpriteDrawRequest));
+    fmt::print("memcpy:     {:.3f}ms ({:.1f}GB/s)\n", memcpyMs, megabytes / memcpyMs);
+    fmt::print("draw list:  {:.3f}ms ({:.1f}GB/s)\n", buildMs, megabytes / buildMs);
+}
+
+CGT_BENCHMARK(SpriteDrawListParallelRecord)
+{
+    using namespace cgt::render;
+
+    const u32 SPRITE_COUNT = 1000000;
+    const u32 CHUNK_SIZE = 4096;
+    const u32 ITERATIONS = 20;
+
+    // some work per sprite, standing in for looking up the entity and its sprite source
+    auto recordSprite = [](u32 i, SpriteDrawRequest& sprite) {
+        const float angle = (float)i * 0.01f;
+        sprite.position = glm::vec2(glm::cos(angle), glm::sin(angle)) * (float)(i % 1000);
+        sprite.rotation = angle;
+        sprite.src.texture.index = (u16)(i % 32 + 1);
+        sprite.layer = (u8)(i % 4);
+    };
+
+    SpriteDrawList serialList;
+    const double serialMs = cgt::bench::MeasureAverageMs(ITERATIONS, [&]() {
+        serialList.clear();
+        for (u32 i = 0; i < SPRITE_COUNT; ++i)
+        {
+            recordSprite(i, serialList.AddSprite());
+        }
+        serialList.SortForRendering();
+    });
+
+    fmt::print("{} sprites, recorded and sorted\n", SPRITE_COUNT);
+    fmt::print("{:>10} {:>12} {:>12}\n", "threads", "ms", "speedup");
+    fmt::print("{:>10} {:>12.3f} {:>11.2f}x\n", "serial", serialMs, 1.0);
+
+    const u32 maxThreads = std::max(std::thread::hardware_concurrency(), 2u);
+    for (u32 threads = 2; threads <= maxThreads; threads *= 2)
+    {
+        cgt::JobSystem jobSystem(threads - 1);
+        SpriteDrawList parallelList;
+        const double parallelMs = cgt::bench::MeasureAverageMs(ITERATIONS, [&]() {
+            parallelList.clear();
+            parallelList.SetSegmentCount((SPRITE_COUNT + CHUNK_SIZE - 1) / CHUNK_SIZE);
+            jobSystem.ParallelFor(SPRITE_COUNT, CHUNK_SIZE, [&](u32 begin, u32 end) {
+                SpriteDrawSegment& segment = parallelList.GetSegment(begin / CHUNK_SIZE);
+                for (u32 i = begin; i < end; ++i)
+                {
+                    recordSprite(i, segment.AddSprite());
+                }
+            });
+            parallelList.SortForRendering();
+        });
+
+        // segments merge in order, so the result has to be the same as recording on one thread
+        CGT_ASSERT_ALWAYS_MSG(parallelList.size() == serialList.size(), "Parallel recording lost sprites");
+        for (u32 i = 0; i < SPRITE_COUNT; ++i)
+        {
+            CGT_ASSERT_ALWAYS_MSG(parallelList[i].layer == serialList[i].layer
+                && parallelList[i].src.texture == serialList[i].src.texture
+                && parallelList[i].position == serialList[i].position,
+                "Parallel recording differs from the serial one at {}", i);
+        }
+
+        fmt::print("{:>10} {:>12.3f} {:>11.2f}x\n", threads, parallelMs, serialMs / parallelMs);
+    }
+}
+
+CGT_BENCHMARK(RetainedSpriteUpdate)
+{
+    using namespace cgt::render;
+
+    const u32 SPRITE_COUNT = 100000;
+    const u32 CHURN_PER_FRAME = 100;
+    const u32 ITERATIONS = 100;
+
+    std::mt19937 random(1337);
+    auto makeSprite = [&]() {
+        SpriteDrawRequest sprite;
+        sprite.src.texture.index = (u16)(random() % 4 + 1);
+        sprite.layer = (u8)(random() % 3);
+        sprite.position = glm::vec2((float)(random() % 1000), (float)(random() % 1000));
+        return sprite;
+    };
+
+    std::vector<SpriteDrawRequest> sprites(SPRITE_COUNT);
+    RetainedSpriteStore store;
+    std::vector<RetainedSpriteHandle> handles(SPRITE_COUNT);
+    for (u32 i = 0; i < SPRITE_COUNT; ++i)
+    {
+        sprites[i] = makeSprite();
+        handles[i] = store.Add(sprites[i]);
+    }
+    store.Flush();
+
+    // what RenderWorld used to do: every sprite recorded again and sorted
+    SpriteDrawList rebuiltList;
+    const double rebuildMs = cgt::bench::MeasureAverageMs(ITERATIONS, [&]() {
+        for (SpriteDrawRequest& sprite : sprites)
+        {
+            sprite.position.x += 0.01f;
+        }
+        FillDrawList(sprites, rebuiltList);
+        rebuiltList.SortForRendering();
+    });
+
+    // churned sprites are replaced by ones of the same layer and texture, like an enemy dying while another one spawns,
+    // or by ones of any layer and texture, which is the worst case
+    auto measureRetained = [&](u32 movedEvery, u32 churn, bool churnKeepsKind) {
+        usize rewritten = 0;
+        const double ms = cgt::bench::MeasureAverageMs(ITERATIONS, [&]() {
+            for (u32 i = 0; i < SPRITE_COUNT; i += movedEvery)
+            {
+                sprites[i].position.x += 0.01f;
+                store.SetTransform(handles[i], sprites[i].position, sprites[i].rotation);
+            }
+            for (u32 i = 0; i < churn; ++i)
+            {
+                const u32 replaced = random() % SPRITE_COUNT;
+                store.Remove(handles[replaced]);
+                SpriteDrawRequest sprite = makeSprite();
+                if (churnKeepsKind)
+                {
+                    sprite.layer = sprites[replaced].layer;
+                    sprite.src.texture = sprites[replaced].src.texture;
+                }
+                sprites[replaced] = sprite;
+                handles[replaced] = store.Add(sprites[replaced]);
+            }
+            rewritten += store.Flush();
+        });
+
+        // the store has to end up with every sprite in it, in the order of layers and textures a full sort gives
+        const SpriteDrawList& retainedList = store.GetDrawList();
+        CGT_ASSERT_ALWAYS_MSG(retainedList.size() == SPRITE_COUNT + store.GetHoleCount(), "Retained store lost sprites");
+        for (u32 i = 1; i < retainedList.size(); ++i)
+        {
+            const SpriteDrawRequest& a = retainedList[i - 1];
+            const SpriteDrawRequest& b = retainedList[i];
+            CGT_ASSERT_ALWAYS_MSG(a.layer < b.layer || (a.layer == b.layer && a.src.texture.index <= b.src.texture.index),
+                "Retained store is out of order at {}", i);
+        }
+
+        return std::make_tuple(ms, rewritten / ITERATIONS, store.GetHoleCount());
+    };
+
+    fmt::print("{} sprites, {} layers, {} textures\n", SPRITE_COUNT, 3, 4);
+    fmt::print("{:<32} {:>10} {:>14} {:>10}\n", "", "ms", "rewritten", "holes");
+    fmt::print("{:<32} {:>10.3f} {:>14} {:>10}\n", "rebuild and sort", rebuildMs, SPRITE_COUNT, 0);
+
+    struct Case
+    {
+        const char* name;
+        u32 movedEvery;
+        u32 churn;
+        bool churnKeepsKind;
+    };
+
+    const Case cases[] = {
+        { "retained, nothing changed", SPRITE_COUNT, 0, true },
+        { "retained, all moved", 1, 0, true },
+        { "retained, 10% moved", 10, 0, true },
+        { "retained, all moved, churn", 1, CHURN_PER_FRAME, true },
+        { "retained, all moved, any churn", 1, CHURN_PER_FRAME, false },
+    };
+    for (const Case& c : cases)
+    {
+        const auto [ms, rewritten, holes] = measureRetained(c.movedEvery, c.churn, c.churnKeepsKind);
+        fmt::print("{:<32} {:>10.3f} {:>14} {:>10}\n", c.name, ms, rewritten, holes);
+    }
+}
+
+CGT_BENCHMARK(SpriteInstanceEncode)
+{
+    using namespace cgt::render;
+
+    const u32 SPRITE_COUNT = 1000000;
+    const u32 ITERATIONS = 20;
+
+    std::mt19937 random(1337);
+    std::uniform_real_distribution<float> distribution(-100.0f, 100.0f);
+    std::vector<SpriteDrawRequest> sprites(SPRITE_COUNT);
+    for (SpriteDrawRequest& sprite : sprites)
+    {
+        sprite.src.uv.min = glm::vec2(distribution(random), distribution(random));
+        sprite.src.uv.max = glm::vec2(distribution(random), distribution(random));
+        sprite.src.baseRotation = distribution(random);
+        sprite.colorTint = glm::vec4(distribution(random), distribution(random), distribution(random), distribution(random));
+        sprite.position = glm::vec2(distribution(random), distribution(random));
+        sprite.scale = glm::vec2(distribution(random), distribution(random));
+        sprite.rotation = distribution(random);
+    }
+
+    // the loop the DX11 backend had before the encoder, one field at a time
+    std::vector<SpriteInstanceData> expected(SPRITE_COUNT);
+    const double scalarMs = cgt::bench::MeasureAverageMs(ITERATIONS, [&]() {
+        for (u32 i = 0; i < SPRITE_COUNT; ++i)
+        {
+            const SpriteDrawRequest& sprite = sprites[i];
+            SpriteInstanceData& instance = expected[i];
+            instance.colorTint = sprite.colorTint;
+            instance.position = sprite.position;
+            instance.uvMin = sprite.src.uv.min;
+            instance.uvMax = sprite.src.uv.max;
+            instance.scale = sprite.scale;
+            instance.rotation = glm::radians(sprite.rotation - sprite.src.baseRotation);
+        }
+        cgt::bench::KeepAlive(expected[SPRITE_COUNT / 2].rotation);
+    });
+
+    std::vector<SpriteInstanceData> encoded(SPRITE_COUNT);
+    auto checkEncoded = [&]()
+    {
+        CGT_ASSERT_ALWAYS_MSG(std::memcmp(encoded.data(), expected.data(), sizeof(SpriteInstanceData) * SPRITE_COUNT) == 0,
+            "Encoded sprite instances differ from the per field conversion");
+        std::fill(encoded.begin(), encoded.end(), SpriteInstanceData {});
+    };
+
+    const double encoderMs = cgt::bench::MeasureAverageMs(ITERATIONS, [&]() {
+        EncodeSpriteInstances(sprites.data(), SPRITE_COUNT, encoded.data());
+        cgt::bench::KeepAlive(encoded[SPRITE_COUNT / 2].rotation);
+    });
+    checkEncoded();
+
+    cgt::JobSystem jobSystem;
+    const double parallelMs = cgt::bench::MeasureAverageMs(ITERATIONS, [&]() {
+        EncodeSpriteInstancesParallel(jobSystem, sprites.data(), SPRITE_COUNT, encoded.data());
+        cgt::bench::KeepAlive(encoded[SPRITE_COUNT / 2].rotation);
+    });
+    checkEncoded();
+
+    const double megabytes = sizeof(SpriteInstanceData) * SPRITE_COUNT / (1024.0 * 1024.0);
+    fmt::print("{} sprites, {} bytes of instance data each, SSE2: {}\n", SPRITE_COUNT, sizeof(SpriteInstanceData), CGT_SIMD_SSE2);
+    fmt::print("per field:          {:.3f}ms ({:.1f}GB/s)\n", scalarMs, megabytes / scalarMs);
+    fmt::print("encoder:            {:.3f}ms ({:.1f}GB/s)\n", encoderMs, megabytes / encoderMs);
+    fmt::print("encoder, {:>2} threads: {:.3f}ms ({:.1f}GB/s)\n", jobSystem.GetThreadCount(), parallelMs, megabytes / parallelMs);
+}
+
+CGT_BENCHMARK(SpriteInstanceCompactEncode)
+{
+    using namespace cgt::render;
+
+    const u32 SPRITE_COUNT = 1000000;
+    const u32 BATCH_SIZE = 1024;
+    const u32 ITERATIONS = 20;
+    const u32 TILES_PER_ROW = 16;
+
+    // a tile map around the camera: grid positions with a bit of movement, tiles out of one atlas page
+    std::mt19937 random(1337);
+    std::uniform_int_distribution<i32> cellDistribution(-30, 30);
+    std::uniform_int_distribution<u32> tileDistribution(0, TILES_PER_ROW * TILES_PER_ROW - 1);
+    std::uniform_real_distribution<float> unitDistribution(0.0f, 1.0f);
+
+    // the uv rect table of the page, built once the way the atlas does it
+    std::vector<cgt::math::AABB> uvRects(TILES_PER_ROW * TILES_PER_ROW);
+    for (u32 tile = 0; tile < uvRects.size(); ++tile)
+    {
+        uvRects[tile].min = glm::vec2(tile % TILES_PER_ROW, tile / TILES_PER_ROW) / (float)TILES_PER_ROW;
+        uvRects[tile].max = uvRects[tile].min + 1.0f / TILES_PER_ROW;
+    }
+
+    std::vector<SpriteDrawRequest> sprites(SPRITE_COUNT);
+    for (SpriteDrawRequest& sprite : sprites)
+    {
+        const u32 tile = tileDistribution(random);
+        sprite.src.uv = uvRects[tile];
+        sprite.src.uvRect = (u16)tile;
+        sprite.colorTint = glm::vec4(unitDistribution(random), unitDistribution(random), unitDistribution(random), 1.0f);
+        sprite.position = glm::vec2(cellDistribution(random), cellDistribution(random)) + unitDistribution(random) * 0.5f;
+        sprite.scale = glm::vec2(1.0f + unitDistribution(random));
+        sprite.rotation = unitDistribution(random) * 360.0f;
+    }
+
+    std::vector<SpriteInstanceData> encoded(BATCH_SIZE);
+    usize fullBytes = 0;
+    const double fullMs = cgt::bench::MeasureAverageMs(ITERATIONS, [&]() {
+        fullBytes = 0;
+        for (u32 begin = 0; begin < SPRITE_COUNT; begin += BATCH_SIZE)
+        {
+            const u32 count = glm::min(BATCH_SIZE, SPRITE_COUNT - begin);
+            EncodeSpriteInstances(sprites.data() + begin, count, encoded.data());
+            fullBytes += count * sizeof(SpriteInstanceData);
+        }
+        cgt::bench::KeepAlive(encoded[BATCH_SIZE / 2].rotation);
+    });
+
+    CompactSpriteEncoder encoder;
+    std::vector<CompactSpriteInstanceData> compactEncoded(BATCH_SIZE);
+    CompactSpriteBatchConstants constants;
+    usize compactBytes = 0;
+    u32 compactBatches = 0;
+    const double compactMs = cgt::bench::MeasureAverageMs(ITERATIONS, [&]() {
+        compactBytes = 0;
+        compactBatches = 0;
+        for (u32 begin = 0; begin < SPRITE_COUNT; begin += BATCH_SIZE)
+        {
+            const u32 count = glm::min(BATCH_SIZE, SPRITE_COUNT - begin);
+            if (encoder.Prepare(sprites.data() + begin, count, (u32)uvRects.size()))
+            {
+                encoder.Encode(compactEncoded.data(), constants);
+                compactBytes += encoder.GetEncodedSize();
+                ++compactBatches;
+            }
+            else
+            {
+                EncodeSpriteInstances(sprites.data() + begin, count, encoded.data());
+                compactBytes += count * sizeof(SpriteInstanceData);
+            }
+        }
+        cgt::bench::KeepAlive(compactEncoded[BATCH_SIZE / 2].rotation);
+    });
+
+    // decodes the last batch the way the shader does and checks it against the quantization limits
+    const u32 lastBatchBegin = (SPRITE_COUNT - 1) / BATCH_SIZE * BATCH_SIZE;
+    const u32 lastBatchCount = SPRITE_COUNT - lastBatchBegin;
+    CGT_ASSERT_ALWAYS_MSG(encoder.Prepare(sprites.data() + lastBatchBegin, lastBatchCount, (u32)uvRects.size()), "Tile map batch doesn't fit the compact format");
+    encoder.Encode(compactEncoded.data(), constants);
+    for (u32 i = 0; i < lastBatchCount; ++i)
+    {
+        const SpriteDrawRequest& sprite = sprites[lastBatchBegin + i];
+        const CompactSpriteInstanceData& instance = compactEncoded[i];
+
+        const glm::vec2 position = constants.origin + glm::vec2(instance.position[0], instance.position[1]) * constants.positionStep;
+        const glm::vec4 tint = glm::vec4(instance.colorTint & 0xFF, (instance.colorTint >> 8) & 0xFF, (instance.colorTint >> 16) & 0xFF, instance.colorTint >> 24) / 255.0f;
+        const cgt::math::AABB& uvRect = uvRects[instance.uvRect];
+        const float rotationError = glm::abs(glm::mod(instance.rotation / 65536.0f * 360.0f - sprite.rotation + 180.0f, 360.0f) - 180.0f);
+
+        const glm::vec2 positionError = glm::abs(position - sprite.position);
+        const glm::vec4 tintError = glm::abs(tint - sprite.colorTint);
+        CGT_ASSERT_ALWAYS_MSG(glm::max(positionError.x, positionError.y) <= constants.positionStep * 0.5f, "Compact position out of tolerance");
+        CGT_ASSERT_ALWAYS_MSG(glm::max(glm::max(tintError.x, tintError.y), glm::max(tintError.z, tintError.w)) <= 0.5f / 255.0f + 1e-6f, "Compact tint out of tolerance");
+        CGT_ASSERT_ALWAYS_MSG(uvRect.min == sprite.src.uv.min && uvRect.max == sprite.src.uv.max, "Compact uv rect differs");
+        CGT_ASSERT_ALWAYS_MSG(rotationError <= 360.0f / 65536.0f, "Compact rotation out of tolerance");
+    }
+
+    const u32 batchCount = (SPRITE_COUNT + BATCH_SIZE - 1) / BATCH_SIZE;
+    fmt::print("{} sprites in {} batches of {}, {} went out compact, {} uv rects in the table\n",
+        SPRITE_COUNT, batchCount, BATCH_SIZE, compactBatches, uvRects.size());
+    fmt::print("full:    {:.3f}ms, {:.2f} bytes per sprite\n", fullMs, (double)fullBytes / SPRITE_COUNT);
+    fmt::print("compact: {:.3f}ms, {:.2f} bytes per sprite with the batch constants\n", compactMs, (double)compactBytes / SPRITE_COUNT);
+}
+
+CGT_BENCHMARK(SpriteCulling)
+{
+    using namespace cgt::render;
+
+    const u32 SPRITE_COUNT = 1000000;
+    const u32 ITERATIONS = 20;
+    const float WORLD_SIZE = 1000.0f;
+
+    // sprites all over a big world with a screen sized view in the middle of it
+    std::mt19937 random(1337);
+    std::uniform_real_distribution<float> worldDistribution(0.0f, WORLD_SIZE);
+    std::uniform_real_distribution<float> unitDistribution(0.0f, 1.0f);
+    std::vector<SpriteDrawRequest> sprites(SPRITE_COUNT);
+    for (SpriteDrawRequest& sprite : sprites)
+    {
+        sprite.src.texture.index = (u16)(random() % 8 + 1);
+        sprite.position = glm::vec2(worldDistribution(random), worldDistribution(random));
+        sprite.scale = glm::vec2(0.5f + unitDistribution(random) * 2.0f, 0.5f + unitDistribution(random));
+        sprite.rotation = unitDistribution(random) * 360.0f;
+    }
+    const cgt::math::AABB viewBounds = { glm::vec2(WORLD_SIZE * 0.5f), glm::vec2(WORLD_SIZE * 0.5f) + glm::vec2(320.0f, 180.0f) };
+
+    std::vector<SpriteDrawRequest> scalarVisible;
+    const double scalarMs = cgt::bench::MeasureAverageMs(ITERATIONS, [&]() {
+        scalarVisible.clear();
+        for (const SpriteDrawRequest& sprite : sprites)
+        {
+            if (cgt::math::AABBOverlap(GetSpriteBounds(sprite), viewBounds))
+            {
+                scalarVisible.push_back(sprite);
+            }
+        }
+        cgt::bench::KeepAlive(scalarVisible.size());
+    });
+
+    SpriteDrawList visible;
+    u32 culledCount = 0;
+    const double cullMs = cgt::bench::MeasureAverageMs(ITERATIONS, [&]() {
+        visible.clear();
+        culledCount = CullSprites(sprites.data(), sprites.size(), viewBounds, visible);
+    });
+
+    CGT_ASSERT_ALWAYS_MSG(visible.size() == scalarVisible.size() && culledCount == SPRITE_COUNT - visible.size(), "Culled sprite counts differ");
+    for (usize i = 0; i < visible.size(); ++i)
+    {
+        CGT_ASSERT_ALWAYS_MSG(visible[i].position == scalarVisible[i].position, "Culled sprites differ at {}", i);
+    }
+
+    // what culling saves: encoding everything against culling and then encoding what's left
+    std::vector<SpriteInstanceData> encoded(SPRITE_COUNT);
+    const double encodeAllMs = cgt::bench::MeasureAverageMs(ITERATIONS, [&]() {
+        EncodeSpriteInstances(sprites.data(), sprites.size(), encoded.data());
+        cgt::bench::KeepAlive(encoded[SPRITE_COUNT / 2].rotation);
+    });
+    const double cullEncodeMs = cgt::bench::MeasureAverageMs(ITERATIONS, [&]() {
+        visible.clear();
+        CullSprites(sprites.data(), sprites.size(), viewBounds, visible);
+        EncodeSpriteInstances(visible.data(), visible.size(), encoded.data());
+        cgt::bench::KeepAlive(encoded[0].rotation);
+    });
+
+    fmt::print("{} sprites, {} visible\n", SPRITE_COUNT, visible.size());
+    fmt::print("scalar cull:      {:.3f}ms\n", scalarMs);
+    fmt::print("cull:             {:.3f}ms ({:.2f}x)\n", cullMs, scalarMs / cullMs);
+    fmt::print("encode all:       {:.3f}ms\n", encodeAllMs);
+    fmt::print("cull and encode:  {:.3f}ms\n", cullEncodeMs);
+}
+
+CGT_BENCHMARK(StaticSpriteBatchCull)
+{
+    using namespace cgt::render;
+
+    const u32 MAP_SIZE = 1000;
+    const u32 LAYER_COUNT = 2;
+    const u32 ITERATIONS = 100;
+
+    // tile layers of a big map, one texture each, with a screen sized view in the middle of it
+    SpriteDrawList tiles;
+    for (u32 layer = 0; layer < LAYER_COUNT; ++layer)
+    {
+        for (u32 y = 0; y < MAP_SIZE; ++y)
+        {
+            for (u32 x = 0; x < MAP_SIZE; ++x)
+            {
+                SpriteDrawRequest& tile = tiles.AddSprite();
+                tile.src.texture.index = (u16)(layer + 1);
+                tile.position = glm::vec2((float)x, (float)y);
+                tile.layer = (u8)layer;
+            }
+        }
+    }
+    const cgt::math::AABB viewBounds = { glm::vec2(MAP_SIZE * 0.5f), glm::vec2(MAP_SIZE * 0.5f) + glm::vec2(32.0f, 18.0f) };
+
+    // the batch of the null and software backends, culling it is the same on every backend
+    CpuStaticSpriteBatch batch(tiles);
+
+    std::vector<StaticSpriteBatch::Draw> draws;
+    u32 staticVisible = 0;
+    const double staticMs = cgt::bench::MeasureAverageMs(ITERATIONS, [&]() {
+        draws.clear();
+        staticVisible = batch.CollectVisibleDraws(viewBounds, draws);
+    });
+
+    // the same map submitted as a dynamic list has to be culled sprite by sprite and then encoded every frame
+    SpriteDrawList visible;
+    std::vector<SpriteInstanceData> encoded(tiles.size());
+    const double dynamicMs = cgt::bench::MeasureAverageMs(ITERATIONS / 10, [&]() {
+        visible.clear();
+        CullSprites(tiles.data(), tiles.size(), viewBounds, visible);
+        EncodeSpriteInstances(visible.data(), visible.size(), encoded.data());
+        cgt::bench::KeepAlive(encoded[0].rotation);
+    });
+
+    CGT_ASSERT_ALWAYS_MSG(staticVisible >= visible.size(), "Static ranges lost visible sprites");
+
+    fmt::print("{} tiles in {} ranges\n", batch.GetSpriteCount(), batch.GetRangeCount());
+    fmt::print("static:  {:.3f}ms, {} draws, {} sprites drawn\n", staticMs, draws.size(), staticVisible);
+    fmt::print("dynamic: {:.3f}ms, {} sprites drawn\n", dynamicMs, visible.size());
+}
+
+CGT_BENCHMARK(SpriteFrameMerge)
+{
+    using namespace cgt::render;
+
+    const u32 LIST_COUNT = 3;
+    const u32 SPRITES_PER_LIST = 100000;
+    const u32 TEXTURE_COUNT = 8;
+    const u32 ITERATIONS = 20;
+
+    // lists sharing textures and layers the way entities and effects do, every one sorted on its own already
+    std::mt19937 random(1337);
+    std::uniform_real_distribution<float> positionDistribution(0.0f, 100.0f);
+    std::vector<SpriteDrawList> drawLists(LIST_COUNT);
+    for (SpriteDrawList& drawList : drawLists)
+    {
+        for (u32 i = 0; i < SPRITES_PER_LIST; ++i)
+        {
+            SpriteDrawRequest& sprite = drawList.AddSprite();
+            sprite.layer = (u8)(random() % 4);
+            sprite.src.texture.index = (u16)(random() % TEXTURE_COUNT + 1);
+            sprite.position = glm::vec2(positionDistribution(random), positionDistribution(random));
+        }
+        drawList.SortForRendering();
+    }
+
+    // the view covers everything, so only the sorting and the batching get compared
+    glm::mat4 viewProjection(1.0f);
+    viewProjection[0][0] = viewProjection[1][1] = 2.0f / 200.0f;
+
+    // what submitting the lists one by one with sorting off goes through
+    SpriteDrawList visible;
+    u32 separateBatches = 0;
+    const double separateMs = cgt::bench::MeasureAverageMs(ITERATIONS, [&]() {
+        separateBatches = 0;
+        for (SpriteDrawList& drawList : drawLists)
+        {
+            RenderStats stats;
+            const SpriteDrawList& sprites = PrepareSpritesForSubmit(drawList, viewProjection, true, false, visible, stats);
+            for (usize spriteIdx = 0; spriteIdx < sprites.size(); spriteIdx = FindSpriteBatchEnd(sprites, spriteIdx, 1024))
+            {
+                ++separateBatches;
+            }
+        }
+    });
+
+    SpriteFrame frame;
+    for (SpriteDrawList& drawList : drawLists)
+    {
+        frame.AddDrawList(drawList);
+    }
+
+    PreparedSpriteFrame preparedFrame;
+    RenderStats frameStats;
+    u32 mergedBatches = 0;
+    const double mergedMs = cgt::bench::MeasureAverageMs(ITERATIONS, [&]() {
+        frameStats = RenderStats();
+        PrepareFrameForSubmit(frame, viewProjection, true, preparedFrame, frameStats);
+
+        mergedBatches = 0;
+        const SpriteDrawList& sprites = preparedFrame.sprites;
+        for (usize spriteIdx = 0; spriteIdx < sprites.size(); spriteIdx = FindSpriteBatchEnd(sprites, spriteIdx, 1024))
+        {
+            ++mergedBatches;
+        }
+    });
+
+    CGT_ASSERT_ALWAYS_MSG(preparedFrame.sprites.size() == LIST_COUNT * SPRITES_PER_LIST, "Merged frame lost sprites");
+    for (usize i = 1; i < preparedFrame.sprites.size(); ++i)
+    {
+        CGT_ASSERT_ALWAYS_MSG(preparedFrame.sprites[i - 1].layer <= preparedFrame.sprites[i].layer, "Merged frame isn't ordered by layer at {}", i);
+    }
+
+    fmt::print("{} lists of {} sprites\n", LIST_COUNT, SPRITES_PER_LIST);
+    fmt::print("separate: {:.3f}ms, {} batches\n", separateMs, separateBatches);
+    fmt::print("merged:   {:.3f}ms, {} batches, {} reported saved\n", mergedMs, mergedBatches, frameStats.mergedDrawcallsSaved);
+}
@@ -0,0 +1,221 @@
+#include <benchmarks/pch.h>
+
+#include <benchmarks/benchmark.h>
+#include <examples/tower_defence/entity_types.h>
+#include <examples/tower_defence/map_data.h>
+#include <examples/tower_defence/game_state.h>
+#include <examples/tower_defence/enemy_soa.h>
+
+namespace
+{
+
+void LoadBenchmarkMap(MapData& outMapData)
+{
+    tson::Tileson mapParser;
+    tson::Map map = mapParser.parse(cgt::AssetPath("examples/maps/tower_defense.json"));
+    CGT_ASSERT_ALWAYS(map.getStatus() == tson::ParseStatus::OK);
+
+    MapData::Load(map, outMapData);
+}
+
+// spreads the enemies evenly along the path, which is roughly what a long running session looks like
+void SpawnEnemiesAlongPath(const MapData& mapData, u32 count, GameState& state)
+{
+    const EnemyPath& path = mapData.enemyPath;
+
+    std::mt19937 random(1337);
+    std::uniform_real_distribution<float> distanceDistribution(0.0f, path.distancesToGoal[0]);
+    std::uniform_real_distribution<float> offsetDistribution(-0.5f, 0.5f);
+
+    for (u32 i = 0; i < count; ++i)
+    {
+        Enemy& enemy = state.enemies.emplace_back();
+        enemy.id = state.nextObjectId++;
+        SetupEnemy(mapData.enemyTypes, i % mapData.enemyTypes.size(), path, enemy);
+
+        const float distanceToGoal = distanceDistribution(random);
+        u32 nextWaypointIdx = 1;
+        while (nextWaypointIdx < path.waypoints.size() - 1 && path.distancesToGoal[nextWaypointIdx] > distanceToGoal)
+        {
+            ++nextWaypointIdx;
+        }
+
+        const glm::vec2 a = path.waypoints[nextWaypointIdx - 1];
+        const glm::vec2 b = path.waypoints[nextWaypointIdx];
+        const float segmentLength = path.distancesToGoal[nextWaypointIdx - 1] - path.distancesToGoal[nextWaypointIdx];
+        const float segmentProgress = 1.0f - (distanceToGoal - path.distancesToGoal[nextWaypointIdx]) / segmentLength;
+
+        const glm::vec2 offset(offsetDistribution(random), offsetDistribution(random));
+        enemy.position = glm::lerp(a, b, segmentProgress) + offset;
+        enemy.nextWaypointIdx = nextWaypointIdx;
+        enemy.distanceToGoal = distanceToGoal;
+    }
+}
+
+void BuildTowersAlongPath(const MapData& mapData, u32 count, GameState& state)
+{
+    const EnemyPath& path = mapData.enemyPath;
+    std::vector<glm::ivec2> occupiedTiles;
+
+    for (u32 i = 1; i < path.waypoints.size() && state.towers.size() < count; ++i)
+    {
+        const glm::vec2 a = path.waypoints[i - 1];
+        const glm::vec2 b = path.waypoints[i];
+        const glm::vec2 direction = glm::normalize(b - a);
+        const glm::vec2 side(-direction.y, direction.x);
+
+        const float segmentLength = glm::distance(a, b);
+        for (float progress = 0.0f; progress < segmentLength && state.towers.size() < count; progress += 2.0f)
+        {
+            for (float sideOffset : { -2.0f, 2.0f })
+            {
+                const glm::vec2 candidate = a + direction * progress + side * sideOffset;
+                const glm::ivec2 tile = mapData.buildableMap.WorldToTile(candidate);
+                const glm::vec2 tilePosition(tile.x, tile.y);
+
+                const bool occupied = std::find(occupiedTiles.begin(), occupiedTiles.end(), tile) != occupiedTiles.end();
+                if (occupied || !mapData.buildableMap.Query(tilePosition) || state.towers.size() >= count)
+                {
+                    continue;
+                }
+
+                occupiedTiles.emplace_back(tile);
+
+                Tower& tower = state.towers.emplace_back();
+                tower.id = state.nextObjectId++;
+                SetupTower(mapData.towerTypes, state.towers.size() % mapData.towerTypes.size(), tilePosition, tower);
+            }
+        }
+    }
+}
+
+}
+
+CGT_BENCHMARK(TowerDefenceTimeStep)
+{
+    MapData mapData;
+    LoadBenchmarkMap(mapData);
+
+    const u32 ENEMY_COUNTS[] = { 100, 500, 1000, 5000, 10000, 25000, 50000, 100000 };
+    const u32 TOWER_COUNT = 16;
+    const float FIXED_DELTA = 1.0f / 30.0f;
+
+    cgt::JobSystem jobSystem;
+
+    auto measureTickMs = [&](u32 enemyCount, cgt::JobSystem* jobs) {
+        GameState states[2];
+        SpawnEnemiesAlongPath(mapData, enemyCount, states[0]);
+        BuildTowersAlongPath(mapData, TOWER_COUNT, states[0]);
+
+        GameCommandQueue commands;
+        GameEventQueue events;
+        TimeStepScratch scratch;
+        u32 currentState = 0;
+        auto step = [&]() {
+            GameState::TimeStep(mapData, states[currentState], states[currentState ^ 1], commands, events, FIXED_DELTA, scratch, jobs);
+            events.clear();
+            currentState ^= 1;
+        };
+
+        // let the flock settle and towers pick up their targets first
+        for (u32 i = 0; i < 5; ++i)
+        {
+            step();
+        }
+
+        const u32 iterations = enemyCount >= 10000 ? 5 : 30;
+        return cgt::bench::MeasureAverageMs(iterations, step);
+    };
+
+    fmt::print("{:>10} {:>12} {:>12} {:>12}\n", "enemies", "serial ms", fmt::format("{} thr. ms", jobSystem.GetThreadCount()), "speedup");
+    for (u32 enemyCount : ENEMY_COUNTS)
+    {
+        const double serialMs = measureTickMs(enemyCount, nullptr);
+        const double parallelMs = measureTickMs(enemyCount, &jobSystem);
+        fmt::print("{:>10} {:>12.3f} {:>12.3f} {:>11.2f}x\n", enemyCount, serialMs, parallelMs, serialMs / parallelMs);
+    }
+}
+
+// flocking accumulation alone, the way TimeStep did it over std::vector<Enemy> against the SoA kernel
+CGT_BENCHMARK(EnemyFlockingLayout)
+{
+    MapData mapData;
+    LoadBenchmarkMap(mapData);
+
+    FlockingParams params;
+    params.sightRange = 3.0f;
+    params.desiredSpacing = 0.7f;
+    params.minimumSpacing = 0.4f;
+
+    const u32 ENEMY_COUNTS[] = { 1000, 10000, 100000 };
+
+    fmt::print("{:>10} {:>12} {:>12} {:>12}\n", "enemies", "AoS ms", "SoA ms", "speedup");
+    for (u32 enemyCount : ENEMY_COUNTS)
+    {
+        GameState state;
+        SpawnEnemiesAlongPath(mapData, enemyCount, state);
+        const std::vector<Enemy>& enemies = state.enemies;
+
+        cgt::SpatialGrid grid(params.sightRange);
+        grid.Build(enemyCount, [&](u32 i) { return enemies[i].position; });
+
+        float checksum = 0.0f;
+        std::vector<u32> queryStorage;
+        const u32 iterations = enemyCount >= 100000 ? 1 : 10;
+
+        const double aosMs = cgt::bench::MeasureAverageMs(iterations, [&]() {
+            for (u32 enemyIdx = 0; enemyIdx < enemyCount; ++enemyIdx)
+            {
+                const Enemy& enemy = enemies[enemyIdx];
+                FlockingSums sums;
+
+                queryStorage.clear();
+                grid.QueryRadius(enemy.position, params.sightRange, queryStorage);
+                for (u32 otherEnemyIdx : queryStorage)
+                {
+                    if (enemyIdx == otherEnemyIdx)
+                    {
+                        continue;
+                    }
+
+                    const Enemy& otherEnemy = enemies[otherEnemyIdx];
+                    const glm::vec2 fromOther = enemy.position - otherEnemy.position;
+                    const float fromOtherDistSqr = cgt::math::LengthSqr(fromOther);
+                    if (otherEnemy.distanceToGoal < enemy.distanceToGoal)
+                    {
+                        ++sums.othersInSight;
+                        sums.othersCumulativePosition += otherEnemy.position;
+                    }
+
+                    if (fromOtherDistSqr < params.desiredSpacing * params.desiredSpacing)
+                    {
+                        const float fromOtherDist = glm::sqrt(fromOtherDistSqr);
+                        const float pushbackForce = 1.0f - glm::smoothstep(params.minimumSpacing, params.desiredSpacing, fromOtherDist);
+                        sums.pushbackDirection += fromOther / fromOtherDist * pushbackForce;
+                    }
+                }
+
+                checksum += sums.pushbackDirection.x + (float)sums.othersInSight;
+            }
+        });
+
+        EnemySoA enemiesSoA;
+        const double soaMs = cgt::bench::MeasureAverageMs(iterations, [&]() {
+            // gathering is a part of every step, so it's measured as well
+            enemiesSoA.Gather(enemies, grid.GetSortedIndices());
+            for (u32 slot = 0; slot < enemyCount; ++slot)
+            {
+                const glm::vec2 position(enemiesSoA.positionsX[slot], enemiesSoA.positionsY[slot]);
+                FlockingSums sums;
+                grid.ForEachCandidateRange(position, params.sightRange, [&](u32 begin, u32 end) {
+                    AccumulateFlocking(enemiesSoA, begin, end, slot, params, sums);
+                });
+
+                checksum += sums.pushbackDirection.x + (float)sums.othersInSight;
+            }
+        });
+
+        cgt::bench::KeepAlive(checksum);
+        fmt::print("{:>10} {:>12.3f} {:>12.3f} {:>11.2f}x\n", enemyCount, aosMs, soaMs, aosMs / soaMs);
+    }
+}
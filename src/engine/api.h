@@ -9,4 +9,11 @@
 #include <engine/clock.h>
 #include <engine/imgui_helper.h>
 #include <engine/tileset_helper.h>
-#include <engine/math.h>
\ No newline at end of file
+#include <engine/math.h>
+#include <engine/spatial_grid.h>
+#include <engine/job_system.h>
+#include <engine/float_environment.h>
+#include <engine/random.h>
+#include <engine/snapshot_history.h>
+#include <engine/triple_buffer.h>
+#include <engine/mpsc_queue.h>
\ No newline at end of file
@@ -1,12 +1,16 @@
 #include <engine/pch.h>
 
-extern int GameMain();
+extern int GameMain(int argc, char** argv);
 
 int main(int argc, char** argv)
 {
-    SDL_Init(SDL_INIT_EVERYTHING);
+    // there's no video or audio on machines without a display, headless windows only need the event queue
+    if (SDL_Init(SDL_INIT_EVERYTHING) != 0)
+    {
+        SDL_Init(SDL_INIT_EVENTS | SDL_INIT_TIMER);
+    }
 
-    return GameMain();
+    return GameMain(argc, argv);
 
     SDL_Quit();
 }
\ No newline at end of file
@@ -0,0 +1,46 @@
+#include <engine/pch.h>
+
+#include <engine/float_environment.h>
+
+#include <cfenv>
+
+namespace cgt
+{
+
+#if CGT_SIMD_SSE2
+
+namespace
+{
+
+// round to nearest, FTZ and DAZ off, all exception flags cleared and masked
+constexpr u32 DEFAULT_MXCSR = 0x1F80;
+
+}
+
+ScopedFloatEnvironment::ScopedFloatEnvironment()
+    : m_SavedState(_mm_getcsr())
+{
+    _mm_setcsr(DEFAULT_MXCSR);
+}
+
+ScopedFloatEnvironment::~ScopedFloatEnvironment()
+{
+    _mm_setcsr(m_SavedState);
+}
+
+#else
+
+ScopedFloatEnvironment::ScopedFloatEnvironment()
+    : m_SavedState((u32)std::fegetround())
+{
+    std::fesetround(FE_TONEAREST);
+}
+
+ScopedFloatEnvironment::~ScopedFloatEnvironment()
+{
+    std::fesetround((i32)m_SavedState);
+}
+
+#endif
+
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+namespace cgt
+{
+
+/*
+ * Forces the default floating point environment for the current thread while in scope:
+ * rounding to nearest, denormals neither flushed nor treated as zero, all exceptions masked.
+ * Code that needs reproducible results (e.g. the simulation) runs under it, since drivers and
+ * third party libraries are known to change these modes on the threads they touch.
+ */
+class ScopedFloatEnvironment : private NonCopyable
+{
+public:
+    ScopedFloatEnvironment();
+    ~ScopedFloatEnvironment();
+
+private:
+    u32 m_SavedState;
+};
+
+}
@@ -4,6 +4,7 @@
 #include <engine/window.h>
 #include <render_core/i_render_context.h>
 #include <render_core/i_camera.h>
+#include <render_core/frame_packet.h>
 
 namespace cgt
 {
@@ -22,12 +23,17 @@ ImGuiHelper::ImGuiHelper(std::shared_ptr<Window> window, std::shared_ptr<render:
 {
     ImGui::CreateContext();
 
-    // TODO: is this the best way to do this?
+    // headless windows have no SDL window for the bindings, NewFrame fills in the display size and time instead
+    if (!m_Window->IsHeadless())
+    {
+        // TODO: is this the best way to do this?
 #ifdef WIN32
-    ImGui_ImplSDL2_InitForD3D(m_Window->GetSDLWindow());
+        ImGui_ImplSDL2_InitForD3D(m_Window->GetSDLWindow());
 #else
-#error "Platform not supported!"
+        // renderers on other platforms don't need any platform specific setup from the SDL bindings
+        ImGui_ImplSDL2_InitForOpenGL(m_Window->GetSDLWindow(), nullptr);
 #endif
+    }
 
     m_Render->ImGuiBindingsInit();
     m_Render->Im3dBindingsInit();
@@ -128,13 +134,25 @@ ImGuiHelper::~ImGuiHelper()
     m_Render->Im3dBindingsShutdown();
     m_Render->ImGuiBindingsShutdown();
 
-    ImGui_ImplSDL2_Shutdown();
+    if (!m_Window->IsHeadless())
+    {
+        ImGui_ImplSDL2_Shutdown();
+    }
 }
 
 void ImGuiHelper::NewFrame(float dt, const render::ICamera& camera)
 {
     m_Render->ImGuiBindingsNewFrame();
-    ImGui_ImplSDL2_NewFrame(m_Window->GetSDLWindow());
+    if (m_Window->IsHeadless())
+    {
+        ImGuiIO& io = ImGui::GetIO();
+        io.DisplaySize = ImVec2((float)m_Window->GetWidth(), (float)m_Window->GetHeight());
+        io.DeltaTime = dt > 0.0f ? dt : 1.0f / 60.0f;
+    }
+    else
+    {
+        ImGui_ImplSDL2_NewFrame(m_Window->GetSDLWindow());
+    }
     ImGui::NewFrame();
 
     Im3d::AppData& ad = Im3d::GetAppData();
@@ -195,11 +213,31 @@ void ImGuiHelper::NewFrame(float dt, const render::ICamera& camera)
 
 void ImGuiHelper::RenderUi(const render::ICamera& camera)
 {
-    m_Render->Im3dBindingsRender(camera);
+    EndUiFrame(camera);
+
+    m_Render->Im3dBindingsRender(camera, Im3d::GetDrawLists(), Im3d::GetDrawListCount());
+    m_Render->ImGuiBindingsRender(ImGui::GetDrawData());
+}
+
+void ImGuiHelper::CaptureUi(const render::ICamera& camera, render::UiPacket& outUi)
+{
+    EndUiFrame(camera);
+
+    outUi.Capture(*ImGui::GetDrawData(), Im3d::GetDrawLists(), Im3d::GetDrawListCount());
+}
+
+void ImGuiHelper::RenderCapturedUi(render::UiPacket& ui, const render::ICamera& camera)
+{
+    m_Render->Im3dBindingsRender(camera, ui.GetIm3dDrawLists(), ui.GetIm3dDrawListCount());
+    m_Render->ImGuiBindingsRender(ui.GetImDrawData());
+}
+
+void ImGuiHelper::EndUiFrame(const render::ICamera& camera)
+{
+    Im3d::EndFrame();
     RenderIm3dText(camera);
 
     ImGui::Render();
-    m_Render->ImGuiBindingsRender(ImGui::GetDrawData());
 }
 
 void ImGuiHelper::BeginInvisibleFullscreenWindow()
@@ -10,6 +10,7 @@ class Window;
 namespace render
 {
 class ICamera;
+class UiPacket;
 }
 
 namespace render
@@ -25,7 +26,12 @@ public:
     ~ImGuiHelper();
 
     void NewFrame(float dt, const render::ICamera& camera);
+    // ends the ImGui and Im3d frames and draws them with the render context right away
     void RenderUi(const render::ICamera& camera);
+    // ends the frames the same way, but copies what they drew, so it can be drawn on the render thread while the next frame starts
+    void CaptureUi(const render::ICamera& camera, render::UiPacket& outUi);
+    // draws a captured frame, on the thread the render context is used on
+    void RenderCapturedUi(render::UiPacket& ui, const render::ICamera& camera);
 
     void BeginInvisibleFullscreenWindow();
     void EndInvisibleFullscreenWindow();
@@ -35,6 +41,8 @@ public:
 private:
     ImGuiHelper(std::shared_ptr<Window> window, std::shared_ptr<render::IRenderContext> render);
 
+    // Im3d text goes into ImGui, so it's added before ImGui renders
+    void EndUiFrame(const render::ICamera& camera);
     void RenderIm3dText(const render::ICamera& camera);
 
     std::shared_ptr<Window> m_Window;
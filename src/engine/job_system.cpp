@@ -0,0 +1,256 @@
+#include <engine/pch.h>
+
+#include <engine/job_system.h>
+
+namespace cgt
+{
+
+namespace
+{
+
+// lets a thread find its own queue, a thread can only be a worker of a single job system
+thread_local const JobSystem* t_OwnerJobSystem = nullptr;
+thread_local u32 t_QueueIdx = 0;
+
+}
+
+JobSystem::JobSystem(u32 workerCount)
+{
+    if (workerCount == 0)
+    {
+        workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    }
+
+    for (u32 i = 0; i < workerCount + 1; ++i)
+    {
+        m_Queues.emplace_back(std::make_unique<JobQueue>());
+    }
+
+    m_Workers.reserve(workerCount);
+    for (u32 i = 0; i < workerCount; ++i)
+    {
+        m_Workers.emplace_back([this, i]() { WorkerLoop(i + 1); });
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_SleepMutex);
+        m_Quit = true;
+    }
+    m_JobsAvailable.notify_all();
+
+    for (std::thread& worker : m_Workers)
+    {
+        worker.join();
+    }
+
+    CGT_ASSERT_MSG(m_QueuedJobs == 0, "Job system destroyed with jobs still in the queues");
+}
+
+void JobSystem::Schedule(JobFunction function, JobCounter* counter, JobCounter* dependency)
+{
+    if (counter)
+    {
+        counter->m_Pending.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Job job { std::move(function), counter };
+    if (dependency)
+    {
+        std::lock_guard<std::mutex> lock(dependency->m_Mutex);
+        if (dependency->m_Pending.load(std::memory_order_acquire) > 0)
+        {
+            dependency->m_Continuations.emplace_back([this, job]() mutable { Enqueue(std::move(job)); });
+            return;
+        }
+    }
+
+    Enqueue(std::move(job));
+}
+
+void JobSystem::ScheduleParallelFor(u32 count, u32 chunkSize, RangeFunction function, JobCounter& counter, JobCounter* dependency)
+{
+    CGT_ASSERT(chunkSize > 0);
+
+    // all of the chunks share the same copy of the function
+    auto sharedFunction = std::make_shared<RangeFunction>(std::move(function));
+    for (u32 begin = 0; begin < count; begin += chunkSize)
+    {
+        const u32 end = std::min(begin + chunkSize, count);
+        Schedule([sharedFunction, begin, end]() { (*sharedFunction)(begin, end); }, &counter, dependency);
+    }
+}
+
+void JobSystem::ParallelFor(u32 count, u32 chunkSize, const RangeFunction& function)
+{
+    ZoneScoped;
+
+    CGT_ASSERT(chunkSize > 0);
+
+    // not worth a round trip through the queues
+    if (count <= chunkSize)
+    {
+        if (count > 0)
+        {
+            function(0, count);
+        }
+        return;
+    }
+
+    // the function outlives the jobs since this call waits for them, so it can be referenced directly
+    JobCounter counter;
+    for (u32 begin = 0; begin < count; begin += chunkSize)
+    {
+        const u32 end = std::min(begin + chunkSize, count);
+        Schedule([&function, begin, end]() { function(begin, end); }, &counter);
+    }
+
+    Wait(counter);
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+    ZoneScoped;
+
+    while (!counter.IsDone())
+    {
+        if (!TryExecuteOne())
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    // the job that finished last might still be releasing the counter
+    std::lock_guard<std::mutex> lock(counter.m_Mutex);
+}
+
+void JobSystem::WorkerLoop(u32 queueIdx)
+{
+    t_OwnerJobSystem = this;
+    t_QueueIdx = queueIdx;
+
+    const std::string threadName = fmt::format("Job Worker {}", queueIdx);
+    tracy::SetThreadName(threadName.c_str());
+
+    for (;;)
+    {
+        if (TryExecuteOne())
+        {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_SleepMutex);
+        m_JobsAvailable.wait(lock, [this]() { return m_Quit || m_QueuedJobs.load(std::memory_order_acquire) > 0; });
+        if (m_Quit)
+        {
+            return;
+        }
+    }
+}
+
+void JobSystem::Enqueue(Job&& job)
+{
+    JobQueue& queue = *m_Queues[GetCurrentQueueIdx()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.emplace_back(std::move(job));
+    }
+
+    // sleeping workers check the amount of queued jobs under this mutex, so the notification can't get lost
+    {
+        std::lock_guard<std::mutex> lock(m_SleepMutex);
+        m_QueuedJobs.fetch_add(1, std::memory_order_release);
+    }
+    m_JobsAvailable.notify_one();
+}
+
+bool JobSystem::TryExecuteOne()
+{
+    Job job;
+    if (!TryPop(job))
+    {
+        return false;
+    }
+
+    Execute(job);
+    return true;
+}
+
+bool JobSystem::TryPop(Job& outJob)
+{
+    if (m_QueuedJobs.load(std::memory_order_acquire) == 0)
+    {
+        return false;
+    }
+
+    // own jobs are taken from the back since they are the most likely to be hot in the cache
+    const u32 ownQueueIdx = GetCurrentQueueIdx();
+    {
+        JobQueue& queue = *m_Queues[ownQueueIdx];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty())
+        {
+            outJob = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+            m_QueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    // while the others are stolen from the front, which are the oldest and usually the biggest ones
+    const u32 queueCount = (u32)m_Queues.size();
+    for (u32 i = 1; i < queueCount; ++i)
+    {
+        JobQueue& queue = *m_Queues[(ownQueueIdx + i) % queueCount];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty())
+        {
+            outJob = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+            m_QueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void JobSystem::Execute(Job& job)
+{
+    {
+        ZoneScopedN("Job");
+        job.function();
+    }
+
+    if (job.counter)
+    {
+        FinishJob(*job.counter);
+    }
+}
+
+void JobSystem::FinishJob(JobCounter& counter)
+{
+    std::vector<std::function<void()>> continuations;
+    {
+        std::lock_guard<std::mutex> lock(counter.m_Mutex);
+        if (counter.m_Pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            continuations.swap(counter.m_Continuations);
+        }
+    }
+
+    // the counter may be gone already at this point, the continuations were moved out of it
+    for (auto& continuation : continuations)
+    {
+        continuation();
+    }
+}
+
+u32 JobSystem::GetCurrentQueueIdx() const
+{
+    return t_OwnerJobSystem == this ? t_QueueIdx : 0;
+}
+
+}
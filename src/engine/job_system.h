@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace cgt
+{
+
+class JobSystem;
+
+/*
+ * Tracks a group of scheduled jobs, it reaches zero once all of them finished.
+ * Jobs scheduled with a counter as their dependency only start after that.
+ * Owned by the caller and has to outlive the jobs that reference it.
+ */
+class JobCounter : private NonCopyable
+{
+public:
+    bool IsDone() const { return m_Pending.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+
+    std::atomic<u32> m_Pending { 0 };
+
+    // guards the continuations and makes sure the last job is done touching the counter before a waiter returns
+    std::mutex m_Mutex;
+    std::vector<std::function<void()>> m_Continuations;
+};
+
+/*
+ * Work stealing job system: every worker owns a deque, pushes and pops its own jobs from the back
+ * and steals from the front of the others when it runs out of work.
+ * Threads that aren't workers share an extra deque and help executing jobs while they wait.
+ */
+class JobSystem : private NonCopyable
+{
+public:
+    typedef std::function<void()> JobFunction;
+    typedef std::function<void(u32, u32)> RangeFunction;
+
+    // 0 workers means one per hardware thread, minus the calling one
+    explicit JobSystem(u32 workerCount = 0);
+    ~JobSystem();
+
+    // counter is incremented right away and decremented when the job finishes,
+    // a job with a dependency is held back until the dependency counter reaches zero
+    void Schedule(JobFunction function, JobCounter* counter = nullptr, JobCounter* dependency = nullptr);
+
+    // splits [0, count) into chunks of chunkSize and schedules function(begin, end) for every chunk.
+    // The chunks are always the same for the same count and chunkSize, only the threads they run on differ.
+    void ScheduleParallelFor(u32 count, u32 chunkSize, RangeFunction function, JobCounter& counter, JobCounter* dependency = nullptr);
+
+    // blocking version of ScheduleParallelFor, the calling thread takes part in the work
+    void ParallelFor(u32 count, u32 chunkSize, const RangeFunction& function);
+
+    // executes pending jobs on the calling thread until the counter reaches zero
+    void Wait(JobCounter& counter);
+
+    // including the thread that created the job system
+    u32 GetThreadCount() const { return (u32)m_Workers.size() + 1; }
+
+private:
+    struct Job
+    {
+        JobFunction function;
+        JobCounter* counter = nullptr;
+    };
+
+    struct JobQueue
+    {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    void WorkerLoop(u32 queueIdx);
+    void Enqueue(Job&& job);
+    bool TryExecuteOne();
+    bool TryPop(Job& outJob);
+    void Execute(Job& job);
+    void FinishJob(JobCounter& counter);
+    u32 GetCurrentQueueIdx() const;
+
+    // queue 0 is shared by all of the threads that aren't workers, worker i owns queue i + 1
+    std::vector<std::unique_ptr<JobQueue>> m_Queues;
+    std::vector<std::thread> m_Workers;
+
+    std::atomic<u32> m_QueuedJobs { 0 };
+    std::mutex m_SleepMutex;
+    std::condition_variable m_JobsAvailable;
+    bool m_Quit = false;
+};
+
+}
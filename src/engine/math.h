@@ -30,7 +30,7 @@ inline bool IsNearlyZero(float f, float max_diff = DEFAULT_MAX_DIFF)
 // when comparing numbers near zero.
 inline bool AreNearlyEqAbs(float a, float b, float max_diff = DEFAULT_MAX_DIFF)
 {
-    const float abs_diff = std::fabsf(a - b);
+    const float abs_diff = std::fabs(a - b);
     return IsNearlyZero(abs_diff, max_diff);
 }
 
@@ -51,11 +51,11 @@ inline bool AreNearlyEqUlps(float a, float b, u32 max_ulps_diff = DEFAULT_MAX_UL
 
 inline bool AreNearlyEqRel(float a, float b, float max_rel_diff = DEFAULT_MAX_REL_DIFF)
 {
-    const float a_abs = std::fabsf(a);
-    const float b_abs = std::fabsf(b);
+    const float a_abs = std::fabs(a);
+    const float b_abs = std::fabs(b);
     const float largest = std::max(a_abs, b_abs);
 
-    const float diff = std::fabsf(a - b);
+    const float diff = std::fabs(a - b);
     return diff <= largest * max_rel_diff;
 }
 
@@ -120,11 +120,17 @@ inline glm::vec2 AABBClosestPoint(glm::vec2 point, AABB aabb)
     return closestPoint;
 }
 
+inline bool AABBOverlap(const AABB& a, const AABB& b)
+{
+    return a.min.x <= b.max.x && b.min.x <= a.max.x
+        && a.min.y <= b.max.y && b.min.y <= a.max.y;
+}
+
 inline float VectorAngle(glm::vec2 vector)
 {
     const float radians = glm::acos(vector.x) * glm::sign(vector.y);
     const float degrees = glm::degrees(radians);
-    const float degreesWrapped = std::fmodf(degrees + 360.0f, 360.0f);
+    const float degreesWrapped = std::fmod(degrees + 360.0f, 360.0f);
     return degreesWrapped;
 }
 
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+
+namespace cgt
+{
+
+/*
+ * Bounded queue any number of threads can push into and one thread pops from, without locks and without allocating after it's created.
+ * Every cell carries a sequence number telling whose turn it is: producers claim cells by bumping the tail,
+ * and the consumer only takes a cell once the producer that claimed it is done writing.
+ * The order of the pushes of every thread on its own is kept, how the pushes of different threads interleave is up to timing.
+ * Based on the bounded MPMC queue by Dmitry Vyukov.
+ */
+template<typename T>
+class MpscQueue : private NonCopyable
+{
+public:
+    // the capacity has to be a power of two
+    explicit MpscQueue(u32 capacity)
+        : m_Cells(new Cell[capacity])
+        , m_Mask(capacity - 1)
+    {
+        CGT_ASSERT_MSG(capacity > 0 && (capacity & (capacity - 1)) == 0, "Capacity {} isn't a power of two", capacity);
+
+        for (u32 cellIdx = 0; cellIdx < capacity; ++cellIdx)
+        {
+            m_Cells[cellIdx].sequence.store(cellIdx, std::memory_order_relaxed);
+        }
+    }
+
+    // any thread, returns false when the queue is full
+    bool TryPush(const T& value)
+    {
+        u64 position = m_Tail.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true)
+        {
+            cell = &m_Cells[position & m_Mask];
+            const u64 sequence = cell->sequence.load(std::memory_order_acquire);
+            const i64 lag = (i64)(sequence - position);
+            if (lag == 0)
+            {
+                if (m_Tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (lag < 0)
+            {
+                // the consumer hasn't taken the value a whole lap ago yet
+                return false;
+            }
+            else
+            {
+                // another producer got the cell first
+                position = m_Tail.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->value = value;
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // the consumer thread only, returns false when there's nothing to take.
+    // A producer still writing its value holds up the ones that pushed after it until the next call
+    bool TryPop(T& outValue)
+    {
+        Cell& cell = m_Cells[m_Head & m_Mask];
+        if (cell.sequence.load(std::memory_order_acquire) != m_Head + 1)
+        {
+            return false;
+        }
+
+        outValue = cell.value;
+        // hands the cell to the producer of the next lap
+        cell.sequence.store(m_Head + m_Mask + 1, std::memory_order_release);
+        ++m_Head;
+        return true;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<u64> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> m_Cells;
+    u64 m_Mask;
+
+    // producers and the consumer touch only their own end, they're kept apart so they don't share a cache line
+    alignas(64) std::atomic<u64> m_Tail { 0 };
+    alignas(64) u64 m_Head = 0;
+};
+
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+namespace cgt
+{
+
+/*
+ * PCG32 random number generator (https://www.pcg-random.org).
+ * Unlike std engines and distributions, whose output is up to the standard library implementation,
+ * the sequence is fully defined here, so it's the same on every platform and compiler.
+ */
+class Random
+{
+public:
+    explicit Random(u64 seed = 0x853c49e6748fea9bull)
+    {
+        Seed(seed);
+    }
+
+    void Seed(u64 seed)
+    {
+        m_State = 0;
+        NextU32();
+        m_State += seed;
+        NextU32();
+    }
+
+    u32 NextU32()
+    {
+        const u64 oldState = m_State;
+        m_State = oldState * 6364136223846793005ull + INCREMENT;
+
+        const u32 xorShifted = (u32)(((oldState >> 18u) ^ oldState) >> 27u);
+        const u32 rotation = (u32)(oldState >> 59u);
+        return (xorShifted >> rotation) | (xorShifted << ((32 - rotation) & 31));
+    }
+
+    // uniformly distributed in [0, 1), built from the upper 24 bits, so every value is exactly representable
+    float NextFloat()
+    {
+        return (float)(NextU32() >> 8) * (1.0f / 16777216.0f);
+    }
+
+    // uniformly distributed in [min, max)
+    float NextFloat(float min, float max)
+    {
+        return min + (max - min) * NextFloat();
+    }
+
+    u64 GetState() const { return m_State; }
+    void SetState(u64 state) { m_State = state; }
+
+private:
+    static constexpr u64 INCREMENT = 1442695040888963407ull;
+
+    u64 m_State = 0;
+};
+
+}
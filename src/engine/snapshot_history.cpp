@@ -0,0 +1,224 @@
+#include <engine/pch.h>
+
+#include <engine/snapshot_history.h>
+
+#include <engine/extern/tracy/zstd/zstd.h>
+
+namespace cgt
+{
+
+namespace
+{
+
+// snapshots are mostly made of 4 byte values, grouping the same byte of all of them together
+// puts the rarely changing high bytes of the deltas next to each other
+void ShuffleBytes(const u8* source, size_t size, u8* destination)
+{
+    const size_t wordCount = size / 4;
+    for (size_t i = 0; i < wordCount; ++i)
+    {
+        destination[i] = source[i * 4];
+        destination[wordCount + i] = source[i * 4 + 1];
+        destination[wordCount * 2 + i] = source[i * 4 + 2];
+        destination[wordCount * 3 + i] = source[i * 4 + 3];
+    }
+    std::copy(source + wordCount * 4, source + size, destination + wordCount * 4);
+}
+
+void UnshuffleBytes(const u8* source, size_t size, u8* destination)
+{
+    const size_t wordCount = size / 4;
+    for (size_t i = 0; i < wordCount; ++i)
+    {
+        destination[i * 4] = source[i];
+        destination[i * 4 + 1] = source[wordCount + i];
+        destination[i * 4 + 2] = source[wordCount * 2 + i];
+        destination[i * 4 + 3] = source[wordCount * 3 + i];
+    }
+    std::copy(source + wordCount * 4, source + size, destination + wordCount * 4);
+}
+
+}
+
+SnapshotHistory::SnapshotHistory(u32 capacity, u32 keyframeInterval, i32 compressionLevel)
+    : m_Entries(capacity + keyframeInterval - 1)
+    , m_Capacity(capacity)
+    , m_KeyframeInterval(keyframeInterval)
+    , m_CompressionLevel(compressionLevel)
+    , m_CompressionContext(ZSTD_createCCtx())
+    , m_DecompressionContext(ZSTD_createDCtx())
+{
+    CGT_ASSERT_ALWAYS_MSG(keyframeInterval > 0 && keyframeInterval <= capacity, "Keyframe interval {} doesn't fit into the capacity {}", keyframeInterval, capacity);
+}
+
+SnapshotHistory::~SnapshotHistory()
+{
+    ZSTD_freeCCtx(m_CompressionContext);
+    ZSTD_freeDCtx(m_DecompressionContext);
+}
+
+void SnapshotHistory::Push(u32 tick, const std::vector<u8>& snapshot)
+{
+    ZoneScoped;
+
+    if (!IsEmpty() && tick != m_NewestTick + 1)
+    {
+        Clear();
+    }
+
+    Entry& entry = m_Entries[tick % m_Entries.size()];
+    if (entry.isValid)
+    {
+        // the oldest keyframe is going away, so are the deltas that depend on it
+        CGT_ASSERT(entry.isKeyframe && entry.tick == m_OldestTick);
+
+        u32 evictedTick = entry.tick;
+        Evict(entry);
+        for (Entry* delta = &m_Entries[++evictedTick % m_Entries.size()];
+            delta->isValid && delta->tick == evictedTick && !delta->isKeyframe;
+            delta = &m_Entries[++evictedTick % m_Entries.size()])
+        {
+            Evict(*delta);
+        }
+
+        m_OldestTick = evictedTick;
+    }
+
+    if (IsEmpty())
+    {
+        m_OldestTick = tick;
+    }
+
+    const bool isKeyframe = IsEmpty() || tick % m_KeyframeInterval == 0;
+    m_DeltaBuffer.resize(snapshot.size());
+    if (isKeyframe)
+    {
+        std::copy(snapshot.begin(), snapshot.end(), m_DeltaBuffer.begin());
+    }
+    else
+    {
+        // bytes past the end of the previous snapshot are XORed with zeroes
+        const size_t commonSize = glm::min(snapshot.size(), m_LastSnapshot.size());
+        for (size_t i = 0; i < commonSize; ++i)
+        {
+            m_DeltaBuffer[i] = snapshot[i] ^ m_LastSnapshot[i];
+        }
+        std::copy(snapshot.begin() + commonSize, snapshot.end(), m_DeltaBuffer.begin() + commonSize);
+    }
+
+    m_ShuffleBuffer.resize(snapshot.size());
+    ShuffleBytes(m_DeltaBuffer.data(), m_DeltaBuffer.size(), m_ShuffleBuffer.data());
+
+    m_CompressionBuffer.resize(ZSTD_compressBound(m_ShuffleBuffer.size()));
+    const size_t compressedSize = ZSTD_compressCCtx(m_CompressionContext, m_CompressionBuffer.data(), m_CompressionBuffer.size(), m_ShuffleBuffer.data(), m_ShuffleBuffer.size(), m_CompressionLevel);
+    CGT_ASSERT_ALWAYS_MSG(!ZSTD_isError(compressedSize), "Snapshot compression failed: {}", ZSTD_getErrorName(compressedSize));
+
+    entry.tick = tick;
+    entry.rawSize = (u32)snapshot.size();
+    entry.isValid = true;
+    entry.isKeyframe = isKeyframe;
+    entry.data.assign(m_CompressionBuffer.begin(), m_CompressionBuffer.begin() + compressedSize);
+
+    m_NewestTick = tick;
+    m_SnapshotCount += 1;
+    m_UncompressedSize += entry.rawSize;
+    m_CompressedSize += entry.data.size();
+
+    m_LastSnapshot = snapshot;
+}
+
+bool SnapshotHistory::Restore(u32 tick, std::vector<u8>& outSnapshot)
+{
+    ZoneScoped;
+
+    if (IsEmpty() || tick < m_OldestTick || tick > m_NewestTick)
+    {
+        return false;
+    }
+
+    u32 keyframeTick = tick;
+    while (!m_Entries[keyframeTick % m_Entries.size()].isKeyframe)
+    {
+        --keyframeTick;
+    }
+
+    Decompress(m_Entries[keyframeTick % m_Entries.size()], outSnapshot);
+    for (u32 deltaTick = keyframeTick + 1; deltaTick <= tick; ++deltaTick)
+    {
+        const Entry& delta = m_Entries[deltaTick % m_Entries.size()];
+        Decompress(delta, m_DeltaBuffer);
+
+        // growing fills the new bytes with zeroes, which is what the delta was computed against
+        outSnapshot.resize(delta.rawSize);
+        for (size_t i = 0; i < delta.rawSize; ++i)
+        {
+            outSnapshot[i] ^= m_DeltaBuffer[i];
+        }
+    }
+
+    return true;
+}
+
+void SnapshotHistory::DiscardAfter(u32 tick)
+{
+    if (IsEmpty() || tick >= m_NewestTick)
+    {
+        return;
+    }
+
+    if (tick < m_OldestTick)
+    {
+        Clear();
+        return;
+    }
+
+    Restore(tick, m_LastSnapshot);
+    for (u32 discardedTick = tick + 1; discardedTick <= m_NewestTick; ++discardedTick)
+    {
+        Evict(m_Entries[discardedTick % m_Entries.size()]);
+    }
+
+    m_NewestTick = tick;
+}
+
+void SnapshotHistory::Clear()
+{
+    for (Entry& entry : m_Entries)
+    {
+        if (entry.isValid)
+        {
+            Evict(entry);
+        }
+    }
+
+    m_LastSnapshot.clear();
+    m_OldestTick = 0;
+    m_NewestTick = 0;
+}
+
+void SnapshotHistory::Evict(Entry& entry)
+{
+    CGT_ASSERT(entry.isValid);
+
+    m_SnapshotCount -= 1;
+    m_UncompressedSize -= entry.rawSize;
+    m_CompressedSize -= entry.data.size();
+
+    entry.isValid = false;
+    entry.isKeyframe = false;
+    entry.data.clear();
+}
+
+void SnapshotHistory::Decompress(const Entry& entry, std::vector<u8>& outData)
+{
+    CGT_ASSERT(entry.isValid);
+
+    m_ShuffleBuffer.resize(entry.rawSize);
+    const size_t size = ZSTD_decompressDCtx(m_DecompressionContext, m_ShuffleBuffer.data(), m_ShuffleBuffer.size(), entry.data.data(), entry.data.size());
+    CGT_ASSERT_ALWAYS_MSG(!ZSTD_isError(size) && size == entry.rawSize, "Snapshot of tick {} is corrupted", entry.tick);
+
+    outData.resize(entry.rawSize);
+    UnshuffleBytes(m_ShuffleBuffer.data(), m_ShuffleBuffer.size(), outData.data());
+}
+
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+struct ZSTD_CCtx_s;
+struct ZSTD_DCtx_s;
+
+namespace cgt
+{
+
+/*
+ * Ring buffer of compressed binary snapshots of consecutive ticks, oldest ones get overwritten once it's full.
+ * Every keyframeInterval-th snapshot is stored whole, the ones in between as the XOR with the previous snapshot,
+ * which is mostly zeroes as long as the layout of the snapshots is stable. Everything is byte shuffled and compressed with zstd.
+ * Restoring a tick costs one keyframe and at most keyframeInterval - 1 deltas to decompress.
+ * The ring has room for keyframeInterval - 1 more snapshots than the capacity: the oldest keyframe goes away together
+ * with its deltas, so that's what keeps the last capacity ticks restorable right after it wraps.
+ */
+class SnapshotHistory : private NonCopyable
+{
+public:
+    // capacity is the amount of the newest ticks that can always be restored
+    SnapshotHistory(u32 capacity, u32 keyframeInterval, i32 compressionLevel = 1);
+    ~SnapshotHistory();
+
+    // ticks have to be consecutive, a gap drops the whole history and starts over from a keyframe
+    void Push(u32 tick, const std::vector<u8>& snapshot);
+
+    // returns false when the tick isn't in the history (anymore)
+    bool Restore(u32 tick, std::vector<u8>& outSnapshot);
+
+    // forgets everything after the tick, so the history carries on from it after a rewind
+    void DiscardAfter(u32 tick);
+    void Clear();
+
+    bool IsEmpty() const { return m_SnapshotCount == 0; }
+
+    // range of ticks that can be restored
+    u32 GetOldestTick() const { return m_OldestTick; }
+    u32 GetNewestTick() const { return m_NewestTick; }
+
+    u32 GetSnapshotCount() const { return m_SnapshotCount; }
+    u32 GetCapacity() const { return m_Capacity; }
+
+    // sum over the stored snapshots before and after compression
+    u64 GetUncompressedSize() const { return m_UncompressedSize; }
+    u64 GetCompressedSize() const { return m_CompressedSize; }
+
+private:
+    struct Entry
+    {
+        u32 tick = 0;
+        u32 rawSize = 0;
+        bool isValid = false;
+        bool isKeyframe = false;
+        std::vector<u8> data;
+    };
+
+    void Evict(Entry& entry);
+    void Decompress(const Entry& entry, std::vector<u8>& outData);
+
+    std::vector<Entry> m_Entries;
+    u32 m_Capacity;
+    u32 m_KeyframeInterval;
+    i32 m_CompressionLevel;
+
+    u32 m_OldestTick = 0;
+    u32 m_NewestTick = 0;
+    u32 m_SnapshotCount = 0;
+    u64 m_UncompressedSize = 0;
+    u64 m_CompressedSize = 0;
+
+    // the newest snapshot, deltas are computed against it
+    std::vector<u8> m_LastSnapshot;
+    std::vector<u8> m_DeltaBuffer;
+    std::vector<u8> m_ShuffleBuffer;
+    std::vector<u8> m_CompressionBuffer;
+
+    ZSTD_CCtx_s* m_CompressionContext;
+    ZSTD_DCtx_s* m_DecompressionContext;
+};
+
+}
@@ -0,0 +1,146 @@
+#include <engine/pch.h>
+
+#include <engine/spatial_grid.h>
+
+namespace cgt
+{
+
+SpatialGrid::SpatialGrid(float cellSize)
+    : m_BaseCellSize(cellSize)
+    , m_CellSize(cellSize)
+    , m_InvCellSize(1.0f / cellSize)
+{
+    CGT_ASSERT(cellSize > 0.0f);
+}
+
+namespace
+{
+
+// clamped into [0, cellCount), NaN fails every comparison and ends up in the first cell instead of going into the cast
+i32 LocalToCell(float local, i32 cellCount)
+{
+    if (!(local >= 0.0f))
+    {
+        return 0;
+    }
+    if (!(local < (float)cellCount))
+    {
+        return cellCount - 1;
+    }
+
+    return (i32)local;
+}
+
+}
+
+glm::ivec2 SpatialGrid::PositionToCell(glm::vec2 position) const
+{
+    const glm::vec2 local = (position - m_Origin) * m_InvCellSize;
+    return glm::ivec2(LocalToCell(local.x, m_Width), LocalToCell(local.y, m_Height));
+}
+
+void SpatialGrid::RebuildCells()
+{
+    ZoneScoped;
+
+    const u32 pointCount = (u32)m_Positions.size();
+
+    m_CellStarts.clear();
+    m_SortedIndices.resize(pointCount);
+    m_SortedPositions.resize(pointCount);
+    m_PointCells.resize(pointCount);
+
+    if (pointCount == 0)
+    {
+        m_Width = 0;
+        m_Height = 0;
+        return;
+    }
+
+    // points that aren't finite are kept out of the bounds, they all go into the first cell
+    glm::vec2 min = glm::vec2(std::numeric_limits<float>::infinity());
+    glm::vec2 max = -min;
+    for (const glm::vec2& position : m_Positions)
+    {
+        if (std::isfinite(position.x) && std::isfinite(position.y))
+        {
+            min = glm::min(min, position);
+            max = glm::max(max, position);
+        }
+    }
+
+    if (min.x > max.x)
+    {
+        min = glm::vec2(0.0f);
+        max = glm::vec2(0.0f);
+    }
+
+    // points that are spread too far apart would produce a mostly empty grid, so grow the cells instead.
+    // The growth is capped, so bounds too big for a float to cover end up in a single cell
+    const float maxCellCount = (float)std::max<u64>(1024, (u64)pointCount * 4);
+    const u32 maxCellGrowths = 128;
+    m_CellSize = m_BaseCellSize;
+    m_Width = 1;
+    m_Height = 1;
+    for (u32 growth = 0; growth < maxCellGrowths; ++growth)
+    {
+        m_InvCellSize = 1.0f / m_CellSize;
+        const glm::vec2 cells = glm::floor((max - min) * m_InvCellSize) + glm::vec2(1.0f);
+        if (cells.x * cells.y <= maxCellCount)
+        {
+            m_Width = (i32)cells.x;
+            m_Height = (i32)cells.y;
+            break;
+        }
+
+        m_CellSize *= 2.0f;
+    }
+    m_InvCellSize = 1.0f / m_CellSize;
+    m_Origin = min;
+
+    // counting sort keeps the original order of points inside of every cell
+    const u32 cellCount = (u32)(m_Width * m_Height);
+    m_CellStarts.resize(cellCount + 1, 0);
+    for (u32 i = 0; i < pointCount; ++i)
+    {
+        const glm::ivec2 cell = PositionToCell(m_Positions[i]);
+        const u32 cellIdx = (u32)(cell.y * m_Width + cell.x);
+        m_PointCells[i] = cellIdx;
+        ++m_CellStarts[cellIdx + 1];
+    }
+
+    for (u32 i = 0; i < cellCount; ++i)
+    {
+        m_CellStarts[i + 1] += m_CellStarts[i];
+    }
+
+    m_CellCursors.assign(m_CellStarts.begin(), m_CellStarts.end() - 1);
+    for (u32 i = 0; i < pointCount; ++i)
+    {
+        const u32 slot = m_CellCursors[m_PointCells[i]]++;
+        m_SortedIndices[slot] = i;
+        m_SortedPositions[slot] = m_Positions[i];
+    }
+}
+
+void SpatialGrid::QueryRadius(glm::vec2 center, float radius, std::vector<u32>& outIndices) const
+{
+    const usize firstResult = outIndices.size();
+    const float radiusSqr = radius * radius;
+
+    ForEachCandidateRange(center, radius, [&](u32 begin, u32 end) {
+        for (u32 i = begin; i < end; ++i)
+        {
+            const glm::vec2 x = m_SortedPositions[i] - center;
+            const float distanceSqr = glm::dot(x, x);
+            if (distanceSqr <= radiusSqr)
+            {
+                outIndices.emplace_back(m_SortedIndices[i]);
+            }
+        }
+    });
+
+    std::sort(outIndices.begin() + firstResult, outIndices.end());
+}
+
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+namespace cgt
+{
+
+/*
+ * Uniform grid over a set of 2D points, meant to be rebuilt from scratch every time the points move.
+ * Points are bucketed with a counting sort, so every cell stores its points contiguously and in their original order.
+ */
+class SpatialGrid
+{
+public:
+    explicit SpatialGrid(float cellSize = 1.0f);
+
+    template<typename TGetPosition>
+    void Build(u32 pointCount, TGetPosition&& getPosition)
+    {
+        m_Positions.resize(pointCount);
+        for (u32 i = 0; i < pointCount; ++i)
+        {
+            m_Positions[i] = getPosition(i);
+            // release builds put such points into the first cell, where no query finds them
+            CGT_ASSERT_MSG(std::isfinite(m_Positions[i].x) && std::isfinite(m_Positions[i].y), "Point {} of the spatial grid isn't finite", i);
+        }
+
+        RebuildCells();
+    }
+
+    // appends indices of all points within radius (inclusive) around the center, in ascending order,
+    // so the results are exactly the same as the ones of a linear scan over the points
+    void QueryRadius(glm::vec2 center, float radius, std::vector<u32>& outIndices) const;
+
+    // calls function(begin, end) for every range of sorted slots that may contain points within radius around the center,
+    // the caller has to check the distances itself. Lets callers run their own (e.g. vectorized) loops over data kept in sorted order
+    template<typename TFunction>
+    void ForEachCandidateRange(glm::vec2 center, float radius, TFunction&& function) const
+    {
+        if (m_Positions.empty())
+        {
+            return;
+        }
+
+        const glm::ivec2 minCell = PositionToCell(center - glm::vec2(radius));
+        const glm::ivec2 maxCell = PositionToCell(center + glm::vec2(radius));
+        for (i32 y = minCell.y; y <= maxCell.y; ++y)
+        {
+            // cells of the same row are adjacent in memory, so the whole row span is a single range
+            const u32 rowStart = m_CellStarts[y * m_Width + minCell.x];
+            const u32 rowEnd = m_CellStarts[y * m_Width + maxCell.x + 1];
+            if (rowStart < rowEnd)
+            {
+                function(rowStart, rowEnd);
+            }
+        }
+    }
+
+    // original index of the point in every sorted slot, points of the same cell are next to each other
+    const std::vector<u32>& GetSortedIndices() const { return m_SortedIndices; }
+
+    u32 GetPointCount() const { return (u32)m_Positions.size(); }
+    float GetCellSize() const { return m_CellSize; }
+
+private:
+    void RebuildCells();
+    glm::ivec2 PositionToCell(glm::vec2 position) const;
+
+    float m_BaseCellSize;
+    float m_CellSize;
+    float m_InvCellSize;
+
+    glm::vec2 m_Origin = glm::vec2(0.0f);
+    i32 m_Width = 0;
+    i32 m_Height = 0;
+
+    std::vector<glm::vec2> m_Positions;
+
+    // cell i owns the range [m_CellStarts[i], m_CellStarts[i + 1]) of the sorted arrays
+    std::vector<u32> m_CellStarts;
+    std::vector<u32> m_SortedIndices;
+    std::vector<glm::vec2> m_SortedPositions;
+    std::vector<u32> m_PointCells;
+    std::vector<u32> m_CellCursors;
+};
+
+}
@@ -9,6 +9,13 @@
 #include <filesystem>
 #include <fstream>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CGT_SIMD_SSE2 1
+#include <emmintrin.h>
+#else
+#define CGT_SIMD_SSE2 0
+#endif
+
 #define CGT_PANIC(fmtStr, ...)                                                                                      \
 do {                                                                                                                \
     std::string CGT_PANIC_userMsg = fmt::format(fmtStr, ##__VA_ARGS__);                                             \
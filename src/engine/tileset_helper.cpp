@@ -6,32 +6,48 @@
 namespace cgt
 {
 
-void TilesetHelper::Tileset::Load(tson::Map& map, const tson::Tileset& tileset, cgt::render::TextureHandle texture, Tileset& outTileset)
+std::vector<math::AABB> TilesetHelper::Tileset::GetTileUVs(const tson::Tileset& tileset)
 {
-    outTileset.m_Texture = std::move(texture);
-
-    outTileset.m_TextureWidth = tileset.getImageSize().x;
-    outTileset.m_TextureHeight = tileset.getImageSize().y;
+    const u32 margin = tileset.getMargin();
+    const u32 spacing = tileset.getSpacing();
+    const u32 columns = tileset.getColumns();
+    const u32 tileCount = tileset.getTileCount();
+    const u32 tileWidth = tileset.getTileSize().x;
+    const u32 tileHeight = tileset.getTileSize().y;
+    const glm::vec2 textureSize(tileset.getImageSize().x, tileset.getImageSize().y);
+
+    std::vector<math::AABB> tileUVs;
+    tileUVs.reserve(tileCount);
+    for (u32 idx = 0; idx < tileCount; ++idx)
+    {
+        const u32 tileColumn = idx % columns;
+        const u32 tileRow = idx / columns;
 
-    outTileset.m_Margin = tileset.getMargin();
-    outTileset.m_Spacing = tileset.getSpacing();
+        const u32 tileX = margin + tileWidth * tileColumn + spacing * tileColumn;
+        const u32 tileY = margin + tileHeight * tileRow + spacing * tileRow;
 
-    outTileset.m_Columns = tileset.getColumns();
-    outTileset.m_TileCount = tileset.getTileCount();
+        math::AABB& uv = tileUVs.emplace_back();
+        uv.min = glm::vec2(tileX, tileY) / textureSize;
+        uv.max = glm::vec2(tileX + tileWidth, tileY + tileHeight) / textureSize;
+    }
 
-    outTileset.m_TileWidth = tileset.getTileSize().x;
-    outTileset.m_TileHeight = tileset.getTileSize().y;
+    return tileUVs;
+}
 
+void TilesetHelper::Tileset::Load(tson::Map& map, const tson::Tileset& tileset, const cgt::render::TextureAtlas& atlas, u32 atlasRegion, Tileset& outTileset)
+{
+    outTileset.m_TileCount = tileset.getTileCount();
     outTileset.m_FirstTileIdx = tileset.getFirstgid();
 
-    outTileset.m_BaseTileRotations.reserve(outTileset.m_TileCount);
+    outTileset.m_TileSources.reserve(outTileset.m_TileCount);
     auto& tileMap = map.getTileMap();
     for (u32 i = 0; i < outTileset.m_TileCount; ++i)
     {
         u32 tileId = i + outTileset.m_FirstTileIdx;
         auto* tile = tileMap.at(tileId);
-        float baseRotation = tile->get<float>("BaseRotation");
-        outTileset.m_BaseTileRotations.emplace_back(baseRotation);
+
+        render::SpriteSource& src = outTileset.m_TileSources.emplace_back(atlas.GetSpriteSource(atlasRegion, i));
+        src.baseRotation = tile->get<float>("BaseRotation");
     }
 }
 
@@ -39,22 +55,7 @@ bool TilesetHelper::Tileset::GetTileSpriteSrc(u32 tileIdx, render::SpriteSource&
 {
     if (tileIdx >= m_FirstTileIdx && tileIdx < m_FirstTileIdx + m_TileCount)
     {
-        const u32 idx = tileIdx - m_FirstTileIdx;
-
-        const u32 tileColumn = idx % m_Columns;
-        const u32 tileRow = idx / m_Columns;
-
-        const u32 tileX = m_Margin + m_TileWidth * tileColumn + m_Spacing * tileColumn;
-        const u32 tileY = m_Margin + m_TileHeight * tileRow + m_Spacing * tileRow;
-
-        const glm::vec2 uvTileDimensions((float)m_TileWidth / m_TextureWidth, (float)m_TileHeight / m_TextureHeight);
-
-        outSrc.texture = m_Texture;
-        outSrc.uv.min = glm::vec2((float)tileX / m_TextureWidth, (float)tileY / m_TextureHeight);
-        outSrc.uv.max = outSrc.uv.min + uvTileDimensions;
-
-        outSrc.baseRotation = m_BaseTileRotations[idx];
-
+        outSrc = m_TileSources[tileIdx - m_FirstTileIdx];
         return true;
     }
 
@@ -69,11 +70,21 @@ std::unique_ptr<TilesetHelper> TilesetHelper::LoadMapTilesets(tson::Map& map, co
 
 TilesetHelper::TilesetHelper(tson::Map& map, const std::filesystem::path& baseMapAbsPath, cgt::render::IRenderContext& render)
 {
+    render::TextureAtlasBuilder atlasBuilder;
+    std::vector<u32> atlasRegions;
+    for (auto& tileset : map.getTilesets())
+    {
+        auto imagePath = baseMapAbsPath / tileset.getImagePath();
+        const u32 atlasRegion = atlasRegions.emplace_back(atlasBuilder.AddImageFile(imagePath));
+        atlasBuilder.AddImageRects(atlasRegion, Tileset::GetTileUVs(tileset));
+    }
+
+    m_Atlas = atlasBuilder.Build(render);
+
+    u32 tilesetIdx = 0;
     for (auto& tileset : map.getTilesets())
     {
-        auto texturePath = baseMapAbsPath / tileset.getImagePath();
-        auto texture = render.LoadTexture(texturePath);
-        Tileset::Load(map, tileset, std::move(texture), m_Tilesets.emplace_back());
+        Tileset::Load(map, tileset, *m_Atlas, atlasRegions[tilesetIdx++], m_Tilesets.emplace_back());
     }
 }
 
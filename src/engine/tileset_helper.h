@@ -1,6 +1,7 @@
 #pragma once
 
 #include <render_core/i_render_context.h>
+#include <render_core/texture_atlas.h>
 
 namespace cgt
 {
@@ -16,36 +17,31 @@ public:
     void RenderTileLayers(tson::Map& map, cgt::render::SpriteDrawList& outDrawList, u8 baseSpriteLayer) const;
     void RenderTileLayer(tson::Layer& layer, cgt::render::SpriteDrawList& outDrawList, u8 spriteLayer) const;
 
+    // all the tileset images, packed together so tiles from different tilesets batch into the same drawcalls
+    const cgt::render::TextureAtlas& GetAtlas() const { return *m_Atlas; }
+
 private:
     TilesetHelper(tson::Map& map, const std::filesystem::path& baseMapAbsPath, cgt::render::IRenderContext& render);
 
     class Tileset
     {
     public:
-        static void Load(tson::Map& map, const tson::Tileset& tileset, cgt::render::TextureHandle texture, Tileset& outTileset);
+        // the tiles of the tileset image in uvs relative to the image, in tile order
+        static std::vector<cgt::math::AABB> GetTileUVs(const tson::Tileset& tileset);
+        // the tiles have to have been added to the atlas region as its rects
+        static void Load(tson::Map& map, const tson::Tileset& tileset, const cgt::render::TextureAtlas& atlas, u32 atlasRegion, Tileset& outTileset);
 
         bool GetTileSpriteSrc(u32 tileIdx, cgt::render::SpriteSource& outSrc) const;
 
     private:
-        u32 m_TextureWidth;
-        u32 m_TextureHeight;
-
-        u32 m_Margin;
-        u32 m_Spacing;
-
-        u32 m_Columns;
         u32 m_TileCount;
-
-        u32 m_TileWidth;
-        u32 m_TileHeight;
-
         u32 m_FirstTileIdx;
 
-        std::vector<float> m_BaseTileRotations;
-
-        cgt::render::TextureHandle m_Texture;
+        // on the atlas page, with the base rotations of the tiles
+        std::vector<cgt::render::SpriteSource> m_TileSources;
     };
 
+    std::unique_ptr<cgt::render::TextureAtlas> m_Atlas;
     std::vector<Tileset> m_Tilesets;
 };
 
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+
+namespace cgt
+{
+
+/*
+ * Hands the newest value from one producer thread to one consumer thread without locks, neither side ever waits.
+ * There are three copies: the producer writes into one of its own and publishes it by swapping it with the shared one,
+ * the consumer swaps its own one for the shared one when something new was published.
+ * Values published before the consumer gets around to them are skipped, it always gets the newest one.
+ * The copies are reused, whatever the producer gets back to write into holds an older value.
+ */
+template<typename T>
+class TripleBuffer : private NonCopyable
+{
+public:
+    // owned by the producer until Publish
+    T& GetWriteBuffer() { return m_Buffers[m_WriteIdx]; }
+
+    void Publish()
+    {
+        // release hands the writes over, acquire makes sure the consumer is done with the copy that comes back
+        const u8 shared = m_Shared.exchange(m_WriteIdx | FRESH_BIT, std::memory_order_acq_rel);
+        m_WriteIdx = shared & INDEX_MASK;
+    }
+
+    // swaps in the newest published value, returns false if there was nothing new since the last time
+    bool Update()
+    {
+        if ((m_Shared.load(std::memory_order_relaxed) & FRESH_BIT) == 0)
+        {
+            return false;
+        }
+
+        const u8 shared = m_Shared.exchange(m_ReadIdx, std::memory_order_acq_rel);
+        m_ReadIdx = shared & INDEX_MASK;
+        return true;
+    }
+
+    // owned by the consumer until the next Update, holds a default value until the first one
+    const T& GetReadBuffer() const { return m_Buffers[m_ReadIdx]; }
+
+private:
+    static constexpr u8 INDEX_MASK = 0x3;
+    static constexpr u8 FRESH_BIT = 0x4;
+
+    T m_Buffers[3];
+
+    // every side touches only its own index, they're kept apart so they don't share a cache line
+    alignas(64) u8 m_WriteIdx = 0;
+    alignas(64) std::atomic<u8> m_Shared { 1 };
+    alignas(64) u8 m_ReadIdx = 2;
+};
+
+}
@@ -19,6 +19,12 @@ WindowConfig WindowConfig::WithDimensions(u32 width, u32 height)
     return *this;
 }
 
+WindowConfig WindowConfig::WithHeadless(bool headless)
+{
+    this->headless = headless;
+    return *this;
+}
+
 std::shared_ptr<Window> WindowConfig::Build() const
 {
     return Window::BuildWithConfig(*this);
@@ -26,6 +32,11 @@ std::shared_ptr<Window> WindowConfig::Build() const
 
 std::shared_ptr<Window> Window::BuildWithConfig(const WindowConfig& config)
 {
+    if (config.headless)
+    {
+        return std::shared_ptr<Window>(new Window(nullptr, config.width, config.height));
+    }
+
     auto window = SDL_CreateWindow(
         config.title.c_str(),
         SDL_WINDOWPOS_CENTERED,
@@ -34,27 +45,43 @@ std::shared_ptr<Window> Window::BuildWithConfig(const WindowConfig& config)
         config.height,
         SDL_WINDOW_SHOWN);
 
-    Window* windowWrapper = new Window(window);
+    Window* windowWrapper = new Window(window, config.width, config.height);
     return std::shared_ptr<Window>(windowWrapper);
 }
 
-Window::Window(SDL_Window* window)
+Window::Window(SDL_Window* window, u32 width, u32 height)
     : m_Window(window)
+    , m_Width(width)
+    , m_Height(height)
 {
 }
 
 Window::~Window()
 {
-    SDL_DestroyWindow(m_Window);
+    if (m_Window)
+    {
+        SDL_DestroyWindow(m_Window);
+    }
 }
 
 bool Window::PollEvent(SDL_Event& outEvent)
 {
+    // SDL_Init fails on machines without a display, the event queue may still be there to deliver SIGINT as a quit
+    if (!m_Window && SDL_WasInit(SDL_INIT_EVENTS) == 0)
+    {
+        return false;
+    }
+
     return SDL_PollEvent(&outEvent) == 1;
 }
 
 u32 Window::GetWidth() const
 {
+    if (!m_Window)
+    {
+        return m_Width;
+    }
+
     int width, unused;
     SDL_GL_GetDrawableSize(m_Window, &width, &unused);
 
@@ -63,6 +90,11 @@ u32 Window::GetWidth() const
 
 u32 Window::GetHeight() const
 {
+    if (!m_Window)
+    {
+        return m_Height;
+    }
+
     int unused, height;
     SDL_GL_GetDrawableSize(m_Window, &unused, &height);
 
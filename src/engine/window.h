@@ -12,11 +12,15 @@ public:
 
     WindowConfig WithTitle(const char* title);
     WindowConfig WithDimensions(u32 width, u32 height);
+    WindowConfig WithHeadless(bool headless);
     std::shared_ptr<Window> Build() const;
     
     std::string title = "Classic Game Template";
     u32 width = 1280;
     u32 height = 720;
+
+    // no SDL window gets created, the dimensions stay fixed and no input arrives except for quit requests
+    bool headless = false;
 };
 
 class Window : private NonCopyable
@@ -29,16 +33,23 @@ public:
     u32 GetWidth() const;
     u32 GetHeight() const;
 
+    bool IsHeadless() const { return m_Window == nullptr; }
+
+    // null for headless windows
     SDL_Window* GetSDLWindow() { return m_Window; }
 
 private:
     friend class EventLoop;
 
-    explicit Window(SDL_Window* window);
+    Window(SDL_Window* window, u32 width, u32 height);
 
     bool PollEvent(SDL_Event& outEvent);
 
     SDL_Window* m_Window;
+
+    // only used by headless windows, the others ask SDL
+    u32 m_Width;
+    u32 m_Height;
 };
 
 }
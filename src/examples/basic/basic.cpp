@@ -1,7 +1,7 @@
 #include <engine/api.h>
 #include <render_core/api.h>
 
-int GameMain()
+int GameMain(int argc, char** argv)
 {
     auto window = cgt::WindowConfig::Default()
         .WithTitle("Basic Example")
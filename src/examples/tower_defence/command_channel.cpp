@@ -0,0 +1,74 @@
+#include <examples/tower_defence/pch.h>
+
+#include <examples/tower_defence/command_channel.h>
+
+GameCommandChannel::GameCommandChannel(u32 capacity)
+    : m_Queue(capacity)
+{
+}
+
+bool GameCommandChannel::Push(const GameCommand& command, GameCommandSource source, u32 targetTick)
+{
+    return m_Queue.TryPush({ targetTick, source, command });
+}
+
+void GameCommandChannel::Drain(u32 tick, GameCommandQueue& outCommands)
+{
+    ZoneScoped;
+
+    TaggedCommand received;
+    while (m_Queue.TryPop(received))
+    {
+        m_Waiting.push_back(received);
+    }
+
+    if (m_Waiting.empty())
+    {
+        return;
+    }
+
+    // stable, so the commands of a source stay in the order it pushed them in, the ones waiting from before come first
+    std::stable_sort(m_Waiting.begin(), m_Waiting.end(), [](const TaggedCommand& a, const TaggedCommand& b)
+    {
+        return a.targetTick != b.targetTick ? a.targetTick < b.targetTick : a.source < b.source;
+    });
+
+    auto dueEnd = m_Waiting.begin();
+    for (; dueEnd != m_Waiting.end() && dueEnd->targetTick <= tick; ++dueEnd)
+    {
+        outCommands.push_back(dueEnd->command);
+    }
+    m_Waiting.erase(m_Waiting.begin(), dueEnd);
+}
+
+void GameCommandChannel::Clear()
+{
+    TaggedCommand received;
+    while (m_Queue.TryPop(received))
+    {
+    }
+
+    m_Waiting.clear();
+}
+
+GameCommandSender::GameCommandSender(GameCommandChannel& channel, GameCommandSource source)
+    : m_Channel(channel)
+    , m_Source(source)
+{
+}
+
+void GameCommandSender::Send(const GameCommand& command, u32 targetTick)
+{
+    if (!m_Backlog.empty() || !m_Channel.Push(command, m_Source, targetTick))
+    {
+        m_Backlog.push_back({ targetTick, command });
+    }
+}
+
+void GameCommandSender::Flush()
+{
+    while (!m_Backlog.empty() && m_Channel.Push(m_Backlog.front().command, m_Source, m_Backlog.front().targetTick))
+    {
+        m_Backlog.pop_front();
+    }
+}
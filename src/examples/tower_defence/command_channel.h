@@ -0,0 +1,81 @@
+#pragma once
+
+#include <examples/tower_defence/game_state.h>
+
+// who sent a command, commands for the same tick are applied in this order
+enum class GameCommandSource : u8
+{
+    Replay,
+    Network,
+    Script,
+    Input,
+    DebugUi,
+};
+
+/*
+ * Where commands for the simulation come in from any thread: input handling, the debug UI, scripts, replays and the network.
+ * Pushing never locks or allocates. Every command is tagged with the tick it's meant for, the time step producing that tick.
+ * The simulation drains the channel once per tick. Arrival order across threads depends on timing, so what it gets back is sorted
+ * by target tick, then by source, then by the order every source pushed in, which is deterministic as long as every source
+ * pushes from one thread. Commands that arrive after their tick already ran go into the next one.
+ */
+class GameCommandChannel : private NonCopyable
+{
+public:
+    // the capacity has to be a power of two
+    explicit GameCommandChannel(u32 capacity = 4096);
+
+    // any thread, returns false and drops the command when the channel is full, GameCommandSender keeps those for later
+    bool Push(const GameCommand& command, GameCommandSource source, u32 targetTick);
+
+    // the simulation thread only, appends the commands due by the tick in the order they have to be applied
+    void Drain(u32 tick, GameCommandQueue& outCommands);
+
+    // the simulation thread only, throws away everything that was sent so far, like after a rewind
+    void Clear();
+
+private:
+    struct TaggedCommand
+    {
+        u32 targetTick;
+        GameCommandSource source;
+        GameCommand command;
+    };
+
+    cgt::MpscQueue<TaggedCommand> m_Queue;
+
+    // the ones that arrived ahead of their tick, owned by the simulation thread
+    std::vector<TaggedCommand> m_Waiting;
+};
+
+/*
+ * The end of the channel one source sends through, owned by the thread of that source.
+ * Commands that don't fit into the channel are kept and pushed again by Flush, and anything sent while some are kept
+ * queues up behind them, so nothing gets lost and the order of the source holds. They arrive late and go into a later tick.
+ */
+class GameCommandSender : private NonCopyable
+{
+public:
+    GameCommandSender(GameCommandChannel& channel, GameCommandSource source);
+
+    void Send(const GameCommand& command, u32 targetTick);
+
+    // pushes as many of the kept commands as there's room for now
+    void Flush();
+
+    // drops the kept commands, like after a rewind
+    void Clear() { m_Backlog.clear(); }
+
+    u32 GetBacklogSize() const { return (u32)m_Backlog.size(); }
+
+private:
+    struct PendingCommand
+    {
+        u32 targetTick;
+        GameCommand command;
+    };
+
+    GameCommandChannel& m_Channel;
+    GameCommandSource m_Source;
+    std::deque<PendingCommand> m_Backlog;
+};
@@ -0,0 +1,230 @@
+#include <examples/tower_defence/pch.h>
+
+#include <examples/tower_defence/command_log.h>
+
+namespace
+{
+
+const char COMMAND_LOG_MAGIC[4] = { 'C', 'G', 'T', 'C' };
+const u32 COMMAND_LOG_VERSION = 1;
+
+}
+
+CommandLogWriter::CommandLogWriter(const std::filesystem::path& path, const std::filesystem::path& mapPath, float fixedDelta)
+    : m_Stream(path, std::ios::binary)
+{
+    CGT_ASSERT_ALWAYS_MSG(m_Stream.is_open(), "Failed to open the command log for writing: {}", path.string());
+
+    m_Stream.write(COMMAND_LOG_MAGIC, sizeof(COMMAND_LOG_MAGIC));
+    WriteU32(COMMAND_LOG_VERSION);
+    WriteFloat(fixedDelta);
+
+    const std::string mapPathStr = mapPath.generic_string();
+    WriteVarint(mapPathStr.size());
+    m_Stream.write(mapPathStr.data(), mapPathStr.size());
+}
+
+CommandLogWriter::~CommandLogWriter()
+{
+    // the end marker: a record without commands at the last simulated tick
+    WriteVarint(m_LastSimulatedTick - m_LastRecordedTick);
+    WriteVarint(0);
+}
+
+void CommandLogWriter::Record(u32 tick, const GameCommandQueue& commands)
+{
+    CGT_ASSERT(tick > m_LastRecordedTick || m_LastRecordedTick == 0);
+    m_LastSimulatedTick = tick;
+
+    if (commands.empty())
+    {
+        return;
+    }
+
+    WriteVarint(tick - m_LastRecordedTick);
+    WriteVarint(commands.size());
+    m_LastRecordedTick = tick;
+
+    for (const GameCommand& command : commands)
+    {
+        m_Stream.put((char)command.type);
+        switch (command.type)
+        {
+        case GameCommand::Type::Debug_SpawnEnemy:
+        {
+            WriteVarint(command.data.debug_spawnEnemyData.enemyType);
+            break;
+        }
+        case GameCommand::Type::Debug_DespawnAllEnemies:
+        {
+            break;
+        }
+        case GameCommand::Type::Debug_AddGold:
+        {
+            WriteFloat(command.data.debug_addGoldData.amount);
+            break;
+        }
+        case GameCommand::Type::BuildTower:
+        {
+            auto& cmdData = command.data.buildTowerData;
+            WriteVarint(cmdData.towerType);
+            WriteFloat(cmdData.position.x);
+            WriteFloat(cmdData.position.y);
+            break;
+        }
+        default:
+        {
+            CGT_PANIC("Unsupported command type!");
+            break;
+        }
+        }
+    }
+
+    // whatever was recorded so far stays readable when the session doesn't get to write the end marker
+    m_Stream.flush();
+}
+
+void CommandLogWriter::WriteVarint(u64 value)
+{
+    // LEB128, 7 bits per byte with the high bit set when more bytes follow
+    while (value >= 0x80)
+    {
+        m_Stream.put((char)((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    m_Stream.put((char)value);
+}
+
+void CommandLogWriter::WriteU32(u32 value)
+{
+    const char bytes[4] = { (char)value, (char)(value >> 8), (char)(value >> 16), (char)(value >> 24) };
+    m_Stream.write(bytes, sizeof(bytes));
+}
+
+void CommandLogWriter::WriteFloat(float value)
+{
+    WriteU32((u32)cgt::math::ReinterpretAsInt(value));
+}
+
+CommandLogReader::CommandLogReader(const std::filesystem::path& path)
+    : m_Stream(path, std::ios::binary)
+{
+    CGT_ASSERT_ALWAYS_MSG(m_Stream.is_open(), "Failed to open the command log for reading: {}", path.string());
+
+    char magic[4] {};
+    m_Stream.read(magic, sizeof(magic));
+    CGT_ASSERT_ALWAYS_MSG(std::equal(std::begin(magic), std::end(magic), COMMAND_LOG_MAGIC), "Not a command log: {}", path.string());
+
+    const u32 version = ReadU32();
+    CGT_ASSERT_ALWAYS_MSG(version == COMMAND_LOG_VERSION, "Unsupported command log version {}, expected {}", version, COMMAND_LOG_VERSION);
+
+    m_FixedDelta = ReadFloat();
+
+    std::string mapPathStr(ReadVarint(), '\0');
+    m_Stream.read(mapPathStr.data(), mapPathStr.size());
+    m_MapPath = mapPathStr;
+
+    CGT_ASSERT_ALWAYS_MSG(m_Stream.good(), "Command log header is truncated: {}", path.string());
+}
+
+bool CommandLogReader::ReadNext(u32& outTick, GameCommandQueue& outCommands)
+{
+    outCommands.clear();
+    if (m_Ended)
+    {
+        return false;
+    }
+
+    // a log that ends at a record boundary comes from a session that crashed or was killed before writing the end marker
+    if (m_Stream.peek() == std::char_traits<char>::eof())
+    {
+        m_EndTick = m_LastTick;
+        m_Ended = true;
+        return false;
+    }
+
+    const u32 tickDelta = (u32)ReadVarint();
+    const u32 commandCount = (u32)ReadVarint();
+    CGT_ASSERT_ALWAYS_MSG(m_Stream.good(), "Command log is truncated after tick {}", m_LastTick);
+
+    m_LastTick += tickDelta;
+    if (commandCount == 0)
+    {
+        m_EndTick = m_LastTick;
+        m_Ended = true;
+        return false;
+    }
+
+    outTick = m_LastTick;
+    outCommands.resize(commandCount);
+    for (GameCommand& command : outCommands)
+    {
+        command.type = (GameCommand::Type)m_Stream.get();
+        switch (command.type)
+        {
+        case GameCommand::Type::Debug_SpawnEnemy:
+        {
+            command.data.debug_spawnEnemyData.enemyType = (u32)ReadVarint();
+            break;
+        }
+        case GameCommand::Type::Debug_DespawnAllEnemies:
+        {
+            break;
+        }
+        case GameCommand::Type::Debug_AddGold:
+        {
+            command.data.debug_addGoldData.amount = ReadFloat();
+            break;
+        }
+        case GameCommand::Type::BuildTower:
+        {
+            auto& cmdData = command.data.buildTowerData;
+            cmdData.towerType = (u32)ReadVarint();
+            cmdData.position.x = ReadFloat();
+            cmdData.position.y = ReadFloat();
+            break;
+        }
+        default:
+        {
+            CGT_PANIC("Unsupported command type {} in the command log at tick {}", (u32)command.type, m_LastTick);
+            break;
+        }
+        }
+    }
+
+    CGT_ASSERT_ALWAYS_MSG(m_Stream.good(), "Command log is truncated at tick {}", m_LastTick);
+    return true;
+}
+
+u64 CommandLogReader::ReadVarint()
+{
+    u64 value = 0;
+    for (u32 shift = 0; shift < 64; shift += 7)
+    {
+        const i32 byte = m_Stream.get();
+        if (byte == std::char_traits<char>::eof())
+        {
+            break;
+        }
+
+        value |= (u64)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            break;
+        }
+    }
+
+    return value;
+}
+
+u32 CommandLogReader::ReadU32()
+{
+    u8 bytes[4] {};
+    m_Stream.read((char*)bytes, sizeof(bytes));
+    return (u32)bytes[0] | ((u32)bytes[1] << 8) | ((u32)bytes[2] << 16) | ((u32)bytes[3] << 24);
+}
+
+float CommandLogReader::ReadFloat()
+{
+    return cgt::math::ReinterpretAsFloat((i32)ReadU32());
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <examples/tower_defence/game_state.h>
+
+/*
+ * Binary log of the commands fed into a GameSession. Since the simulation is deterministic,
+ * the map, the fixed delta and the commands are enough to reproduce the whole session.
+ *
+ * Layout: header (magic, version, fixed delta, map path), then a record for every tick that had commands:
+ * varint tick delta to the previous record, varint command count and the commands as a type byte
+ * followed by a packed payload. A record without commands marks the last simulated tick.
+ * Records are flushed as they're written, a log without the end marker ends at its last record.
+ * Multi-byte values are little-endian.
+ *
+ * Changes to the map data done through the debug UI are not a part of the log.
+ */
+class CommandLogWriter : private NonCopyable
+{
+public:
+    CommandLogWriter(const std::filesystem::path& path, const std::filesystem::path& mapPath, float fixedDelta);
+    ~CommandLogWriter();
+
+    // has to be called for every simulated tick, including the ones without commands
+    void Record(u32 tick, const GameCommandQueue& commands);
+
+private:
+    void WriteVarint(u64 value);
+    void WriteU32(u32 value);
+    void WriteFloat(float value);
+
+    std::ofstream m_Stream;
+    u32 m_LastRecordedTick = 0;
+    u32 m_LastSimulatedTick = 0;
+};
+
+class CommandLogReader : private NonCopyable
+{
+public:
+    explicit CommandLogReader(const std::filesystem::path& path);
+
+    const std::filesystem::path& GetMapPath() const { return m_MapPath; }
+    float GetFixedDelta() const { return m_FixedDelta; }
+
+    // reads the next tick that had commands, returns false once the log is over
+    bool ReadNext(u32& outTick, GameCommandQueue& outCommands);
+
+    // last simulated tick of the recorded session, known once ReadNext returned false.
+    // The last recorded tick for logs that were cut off without the end marker
+    u32 GetEndTick() const { return m_EndTick; }
+
+private:
+    u64 ReadVarint();
+    u32 ReadU32();
+    float ReadFloat();
+
+    std::ifstream m_Stream;
+    std::filesystem::path m_MapPath;
+    float m_FixedDelta = 0.0f;
+
+    u32 m_LastTick = 0;
+    u32 m_EndTick = 0;
+    bool m_Ended = false;
+};
@@ -0,0 +1,207 @@
+#include <examples/tower_defence/pch.h>
+
+#include <examples/tower_defence/enemy_soa.h>
+
+void EnemySoA::Gather(const std::vector<Enemy>& enemies, const std::vector<u32>& order)
+{
+    ZoneScoped;
+
+    const u32 count = (u32)order.size();
+    const u32 paddedCount = count + SIMD_PADDING;
+
+    sourceIndices.resize(count);
+    positionsX.resize(paddedCount);
+    positionsY.resize(paddedCount);
+    velocitiesX.resize(paddedCount);
+    velocitiesY.resize(paddedCount);
+    remainingHealths.resize(paddedCount);
+    nextWaypointIndices.resize(paddedCount);
+    distancesToGoal.resize(paddedCount);
+
+    for (u32 slot = 0; slot < count; ++slot)
+    {
+        const u32 enemyIdx = order[slot];
+        const Enemy& enemy = enemies[enemyIdx];
+
+        sourceIndices[slot] = enemyIdx;
+        positionsX[slot] = enemy.position.x;
+        positionsY[slot] = enemy.position.y;
+        velocitiesX[slot] = enemy.velocity.x;
+        velocitiesY[slot] = enemy.velocity.y;
+        remainingHealths[slot] = enemy.remainingHealth;
+        nextWaypointIndices[slot] = enemy.nextWaypointIdx;
+        distancesToGoal[slot] = enemy.distanceToGoal;
+    }
+}
+
+namespace
+{
+
+// fixed reduction order, so both versions of the kernel sum the lanes the same way
+float SumLanes(const float lanes[4])
+{
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+}
+
+#if CGT_SIMD_SSE2
+
+void AccumulateFlocking(const EnemySoA& enemies, u32 begin, u32 end, u32 selfSlot, const FlockingParams& params, FlockingSums& sums)
+{
+    const __m128 selfX = _mm_set1_ps(enemies.positionsX[selfSlot]);
+    const __m128 selfY = _mm_set1_ps(enemies.positionsY[selfSlot]);
+    const __m128 selfDistanceToGoal = _mm_set1_ps(enemies.distancesToGoal[selfSlot]);
+
+    const __m128 sightRangeSqr = _mm_set1_ps(params.sightRange * params.sightRange);
+    const __m128 desiredSpacingSqr = _mm_set1_ps(params.desiredSpacing * params.desiredSpacing);
+    const __m128 minimumSpacing = _mm_set1_ps(params.minimumSpacing);
+    const __m128 spacingRange = _mm_set1_ps(params.desiredSpacing - params.minimumSpacing);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 three = _mm_set1_ps(3.0f);
+
+    const __m128i endSlot = _mm_set1_epi32((i32)end);
+    const __m128i self = _mm_set1_epi32((i32)selfSlot);
+    const __m128i laneStep = _mm_set1_epi32(4);
+    __m128i slots = _mm_setr_epi32((i32)begin, (i32)begin + 1, (i32)begin + 2, (i32)begin + 3);
+
+    __m128i othersInSight = _mm_setzero_si128();
+    __m128 cumulativeX = zero;
+    __m128 cumulativeY = zero;
+    __m128 pushbackX = zero;
+    __m128 pushbackY = zero;
+
+    for (u32 i = begin; i < end; i += 4, slots = _mm_add_epi32(slots, laneStep))
+    {
+        const __m128 otherX = _mm_loadu_ps(&enemies.positionsX[i]);
+        const __m128 otherY = _mm_loadu_ps(&enemies.positionsY[i]);
+        const __m128 otherDistanceToGoal = _mm_loadu_ps(&enemies.distancesToGoal[i]);
+
+        // lanes past the end of the range and the enemy itself don't count
+        const __m128i validSlots = _mm_andnot_si128(_mm_cmpeq_epi32(slots, self), _mm_cmplt_epi32(slots, endSlot));
+
+        const __m128 fromOtherX = _mm_sub_ps(selfX, otherX);
+        const __m128 fromOtherY = _mm_sub_ps(selfY, otherY);
+        const __m128 fromOtherDistSqr = _mm_add_ps(_mm_mul_ps(fromOtherX, fromOtherX), _mm_mul_ps(fromOtherY, fromOtherY));
+        const __m128 inSight = _mm_and_ps(_mm_cmple_ps(fromOtherDistSqr, sightRangeSqr), _mm_castsi128_ps(validSlots));
+
+        const __m128 inFront = _mm_and_ps(_mm_cmplt_ps(otherDistanceToGoal, selfDistanceToGoal), inSight);
+        othersInSight = _mm_sub_epi32(othersInSight, _mm_castps_si128(inFront));
+        cumulativeX = _mm_add_ps(cumulativeX, _mm_and_ps(inFront, otherX));
+        cumulativeY = _mm_add_ps(cumulativeY, _mm_and_ps(inFront, otherY));
+
+        const __m128 tooClose = _mm_and_ps(_mm_cmplt_ps(fromOtherDistSqr, desiredSpacingSqr), inSight);
+        if (_mm_movemask_ps(tooClose) == 0)
+        {
+            continue;
+        }
+
+        // pushback force is 1 - smoothstep(minimumSpacing, desiredSpacing, distance)
+        const __m128 fromOtherDist = _mm_sqrt_ps(fromOtherDistSqr);
+        const __m128 fromOtherNormX = _mm_div_ps(fromOtherX, fromOtherDist);
+        const __m128 fromOtherNormY = _mm_div_ps(fromOtherY, fromOtherDist);
+        __m128 t = _mm_div_ps(_mm_sub_ps(fromOtherDist, minimumSpacing), spacingRange);
+        t = _mm_min_ps(_mm_max_ps(t, zero), one);
+        const __m128 smoothT = _mm_mul_ps(_mm_mul_ps(t, t), _mm_sub_ps(three, _mm_mul_ps(two, t)));
+        const __m128 pushbackForce = _mm_sub_ps(one, smoothT);
+
+        pushbackX = _mm_add_ps(pushbackX, _mm_and_ps(tooClose, _mm_mul_ps(fromOtherNormX, pushbackForce)));
+        pushbackY = _mm_add_ps(pushbackY, _mm_and_ps(tooClose, _mm_mul_ps(fromOtherNormY, pushbackForce)));
+    }
+
+    alignas(16) i32 othersInSightLanes[4];
+    alignas(16) float cumulativeXLanes[4];
+    alignas(16) float cumulativeYLanes[4];
+    alignas(16) float pushbackXLanes[4];
+    alignas(16) float pushbackYLanes[4];
+    _mm_store_si128((__m128i*)othersInSightLanes, othersInSight);
+    _mm_store_ps(cumulativeXLanes, cumulativeX);
+    _mm_store_ps(cumulativeYLanes, cumulativeY);
+    _mm_store_ps(pushbackXLanes, pushbackX);
+    _mm_store_ps(pushbackYLanes, pushbackY);
+
+    sums.othersInSight += othersInSightLanes[0] + othersInSightLanes[1] + othersInSightLanes[2] + othersInSightLanes[3];
+    sums.othersCumulativePosition += glm::vec2(SumLanes(cumulativeXLanes), SumLanes(cumulativeYLanes));
+    sums.pushbackDirection += glm::vec2(SumLanes(pushbackXLanes), SumLanes(pushbackYLanes));
+}
+
+#else
+
+// mirrors the SSE2 version operation by operation, so platforms without it simulate exactly the same
+void AccumulateFlocking(const EnemySoA& enemies, u32 begin, u32 end, u32 selfSlot, const FlockingParams& params, FlockingSums& sums)
+{
+    const float selfX = enemies.positionsX[selfSlot];
+    const float selfY = enemies.positionsY[selfSlot];
+    const float selfDistanceToGoal = enemies.distancesToGoal[selfSlot];
+
+    const float sightRangeSqr = params.sightRange * params.sightRange;
+    const float desiredSpacingSqr = params.desiredSpacing * params.desiredSpacing;
+    const float spacingRange = params.desiredSpacing - params.minimumSpacing;
+
+    u32 othersInSight = 0;
+    float cumulativeX[4] = {};
+    float cumulativeY[4] = {};
+    float pushbackX[4] = {};
+    float pushbackY[4] = {};
+
+    for (u32 i = begin; i < end; i += 4)
+    {
+        bool tooClose[4];
+        bool anyTooClose = false;
+        for (u32 lane = 0; lane < 4; ++lane)
+        {
+            const u32 slot = i + lane;
+            const float otherX = enemies.positionsX[slot];
+            const float otherY = enemies.positionsY[slot];
+
+            const bool validSlot = slot < end && slot != selfSlot;
+
+            const float fromOtherX = selfX - otherX;
+            const float fromOtherY = selfY - otherY;
+            const float fromOtherDistSqr = fromOtherX * fromOtherX + fromOtherY * fromOtherY;
+            const bool inSight = validSlot && fromOtherDistSqr <= sightRangeSqr;
+
+            const bool inFront = inSight && enemies.distancesToGoal[slot] < selfDistanceToGoal;
+            othersInSight += inFront ? 1 : 0;
+            cumulativeX[lane] = cumulativeX[lane] + (inFront ? otherX : 0.0f);
+            cumulativeY[lane] = cumulativeY[lane] + (inFront ? otherY : 0.0f);
+
+            tooClose[lane] = inSight && fromOtherDistSqr < desiredSpacingSqr;
+            anyTooClose |= tooClose[lane];
+        }
+
+        if (!anyTooClose)
+        {
+            continue;
+        }
+
+        for (u32 lane = 0; lane < 4; ++lane)
+        {
+            const u32 slot = i + lane;
+            const float fromOtherX = selfX - enemies.positionsX[slot];
+            const float fromOtherY = selfY - enemies.positionsY[slot];
+            const float fromOtherDistSqr = fromOtherX * fromOtherX + fromOtherY * fromOtherY;
+
+            // pushback force is 1 - smoothstep(minimumSpacing, desiredSpacing, distance)
+            const float fromOtherDist = std::sqrt(fromOtherDistSqr);
+            const float fromOtherNormX = fromOtherX / fromOtherDist;
+            const float fromOtherNormY = fromOtherY / fromOtherDist;
+            float t = (fromOtherDist - params.minimumSpacing) / spacingRange;
+            t = t > 0.0f ? t : 0.0f;
+            t = t < 1.0f ? t : 1.0f;
+            const float smoothT = (t * t) * (3.0f - 2.0f * t);
+            const float pushbackForce = 1.0f - smoothT;
+
+            pushbackX[lane] = pushbackX[lane] + (tooClose[lane] ? fromOtherNormX * pushbackForce : 0.0f);
+            pushbackY[lane] = pushbackY[lane] + (tooClose[lane] ? fromOtherNormY * pushbackForce : 0.0f);
+        }
+    }
+
+    sums.othersInSight += othersInSight;
+    sums.othersCumulativePosition += glm::vec2(SumLanes(cumulativeX), SumLanes(cumulativeY));
+    sums.pushbackDirection += glm::vec2(SumLanes(pushbackX), SumLanes(pushbackY));
+}
+
+#endif
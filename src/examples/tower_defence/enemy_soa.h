@@ -0,0 +1,44 @@
+#pragma once
+
+#include <examples/tower_defence/entities.h>
+
+/*
+ * Structure of arrays copy of the enemies, used by the hot loops of the simulation.
+ * std::vector<Enemy> stays the canonical representation (rendering, interpolation, commands),
+ * this one is gathered from it in any order the caller wants, e.g. the order of the spatial grid.
+ */
+struct EnemySoA
+{
+    // arrays are over-allocated, so SIMD kernels can always load full lanes past the last enemy
+    static constexpr u32 SIMD_PADDING = 3;
+
+    void Gather(const std::vector<Enemy>& enemies, const std::vector<u32>& order);
+    u32 Size() const { return (u32)sourceIndices.size(); }
+
+    std::vector<u32> sourceIndices;
+    std::vector<float> positionsX;
+    std::vector<float> positionsY;
+    std::vector<float> velocitiesX;
+    std::vector<float> velocitiesY;
+    std::vector<float> remainingHealths;
+    std::vector<u32> nextWaypointIndices;
+    std::vector<float> distancesToGoal;
+};
+
+struct FlockingParams
+{
+    float sightRange;
+    float desiredSpacing;
+    float minimumSpacing;
+};
+
+struct FlockingSums
+{
+    u32 othersInSight = 0;
+    glm::vec2 othersCumulativePosition = glm::vec2(0.0f);
+    glm::vec2 pushbackDirection = glm::vec2(0.0f);
+};
+
+// accumulates how the enemies in slots [begin, end) affect the one in selfSlot, 4 slots at a time.
+// The SSE2 and the portable version produce bit-identical results.
+void AccumulateFlocking(const EnemySoA& enemies, u32 begin, u32 end, u32 selfSlot, const FlockingParams& params, FlockingSums& sums);
@@ -2,21 +2,58 @@
 
 #include <examples/tower_defence/game_session.h>
 #include <examples/tower_defence/helper_functions.h>
+#include <examples/tower_defence/game_snapshot.h>
 
-std::unique_ptr<GameSession> GameSession::FromMap(const std::filesystem::path mapAbsolutePath, cgt::render::IRenderContext& render, float fixedTimeDelta)
+namespace
 {
-    auto gameSession = std::unique_ptr<GameSession>(new GameSession());
 
+// the whole frame is sorted by layer at once: the tile layers of the map come first, then every kind of entity
+// gets a layer of its own, so they stack the same way no matter when the entities appeared
+const u8 ENEMIES_LAYER = 2;
+const u8 TOWERS_LAYER = 3;
+const u8 PROJECTILES_LAYER = 4;
+
+}
+
+std::unique_ptr<GameSession> GameSession::FromMap(const std::filesystem::path mapAbsolutePath, cgt::render::IRenderContext& render, float fixedTimeDelta)
+{
     tson::Tileson mapParser;
     tson::Map map = mapParser.parse(mapAbsolutePath);
     CGT_ASSERT_ALWAYS(map.getStatus() == tson::ParseStatus::OK);
 
+    auto gameSession = LoadSimulation(map, fixedTimeDelta);
+
     auto mapBasePath = mapAbsolutePath;
     mapBasePath.remove_filename();
     gameSession->tilesetHelper = cgt::TilesetHelper::LoadMapTilesets(map, mapBasePath, render);
 
-    cgt::render::SpriteDrawList staticMapDrawList;
-    gameSession->tilesetHelper->RenderTileLayers(map, gameSession->m_StaticMapDrawList, 0);
+    cgt::render::SpriteDrawList tileSprites;
+    gameSession->tilesetHelper->RenderTileLayers(map, tileSprites, 0);
+    for (const cgt::render::SpriteDrawRequest& tile : tileSprites)
+    {
+        CGT_ASSERT_ALWAYS_MSG(tile.layer < ENEMIES_LAYER, "Map has more tile layers than there are layers below the entities");
+    }
+    gameSession->m_StaticMapBatch = render.CreateStaticBatch(tileSprites);
+
+    // counted over the whole map in the order the batch draws it, the view only ever shows a part of it
+    tileSprites.SortForRendering();
+    gameSession->m_StaticMapDrawcallsSaved = gameSession->tilesetHelper->GetAtlas().CountDrawcallsSaved(tileSprites);
+
+    return gameSession;
+}
+
+std::unique_ptr<GameSession> GameSession::FromMapHeadless(const std::filesystem::path mapAbsolutePath, float fixedTimeDelta)
+{
+    tson::Tileson mapParser;
+    tson::Map map = mapParser.parse(mapAbsolutePath);
+    CGT_ASSERT_ALWAYS(map.getStatus() == tson::ParseStatus::OK);
+
+    return LoadSimulation(map, fixedTimeDelta);
+}
+
+std::unique_ptr<GameSession> GameSession::LoadSimulation(tson::Map& map, float fixedTimeDelta)
+{
+    auto gameSession = std::unique_ptr<GameSession>(new GameSession());
 
     MapData::Load(map, gameSession->mapData);
 
@@ -38,10 +75,40 @@ std::unique_ptr<GameSession> GameSession::FromMap(const std::filesystem::path ma
     return gameSession;
 }
 
-void GameSession::TimeStep(const GameCommandQueue& commands, GameEventQueue& outGameEvents)
+void GameSession::TimeStep(const GameCommandQueue& commands, GameEventQueue& outGameEvents, TimeStepStats* outStats)
 {
     std::swap(m_PrevState, m_NextState);
-    GameState::TimeStep(mapData, *m_PrevState, *m_NextState, commands, outGameEvents, m_FixedDelta);
+    GameState::TimeStep(mapData, *m_PrevState, *m_NextState, commands, outGameEvents, m_FixedDelta, m_TimeStepScratch, m_JobSystem, outStats);
+
+    if (m_CommandRecorder)
+    {
+        m_CommandRecorder->Record(m_NextState->tick, commands);
+    }
+
+    if (m_SnapshotHistory)
+    {
+        SerializeGameState(*m_NextState, m_SnapshotBuffer);
+        m_SnapshotHistory->Push(m_NextState->tick, m_SnapshotBuffer);
+    }
+}
+
+bool GameSession::RewindTo(u32 tick)
+{
+    ZoneScoped;
+
+    if (!m_SnapshotHistory || !m_SnapshotHistory->Restore(tick, m_SnapshotBuffer))
+    {
+        return false;
+    }
+
+    DeserializeGameState(m_SnapshotBuffer, *m_NextState);
+    *m_PrevState = *m_NextState;
+
+    m_RewindCount.fetch_add(1, std::memory_order_release);
+    m_SnapshotHistory->DiscardAfter(tick);
+    m_CommandRecorder = nullptr;
+
+    return true;
 }
 
 void GameSession::InterpolateState(GameState& outState, float amount)
@@ -49,16 +116,76 @@ void GameSession::InterpolateState(GameState& outState, float amount)
     GameState::Interpolate(*m_PrevState, *m_NextState, outState, amount);
 }
 
-cgt::render::RenderStats GameSession::RenderWorld(GameState& interpolatedState, cgt::render::IRenderContext& render, cgt::render::ICamera& camera)
+cgt::render::RenderStats GameSession::RenderWorld(GameState& interpolatedState, cgt::render::SpriteFrame& frame)
 {
-    m_EntitiesDrawList.clear();
-
-    interpolatedState.ForEachEntity(mapData, [&](auto& entity, auto& type) {
-        RenderEntity(entity, type, *tilesetHelper, m_EntitiesDrawList);
-    });
-
-    auto renderStats = render.Submit(m_StaticMapDrawList, camera, false);
-    renderStats += render.Submit(m_EntitiesDrawList, camera, false);
+    {
+        ZoneScopedN("Update Entity Sprites");
+
+        const u32 rewindCount = m_RewindCount.load(std::memory_order_acquire);
+        if (rewindCount != m_RenderedRewindCount)
+        {
+            m_EntitySpriteStore.Clear();
+            m_EntitySprites.clear();
+            m_RenderedRewindCount = rewindCount;
+        }
+
+        // entities keep their sprites across frames, only the ones that just appeared are set up from their types
+        ++m_EntitySpritesFrame;
+        auto updateSprites = [&](const auto& entities, const auto& types, u8 layer)
+        {
+            for (const auto& entity : entities)
+            {
+                auto [entitySpriteIt, isNew] = m_EntitySprites.try_emplace(entity.id);
+                EntitySprite& entitySprite = entitySpriteIt->second;
+                entitySprite.lastFrame = m_EntitySpritesFrame;
+
+                if (isNew)
+                {
+                    cgt::render::SpriteDrawRequest sprite;
+                    RenderEntity(entity, types[entity.typeIdx], *tilesetHelper, sprite);
+                    sprite.layer = layer;
+                    entitySprite.handle = m_EntitySpriteStore.Add(sprite);
+                }
+                else
+                {
+                    m_EntitySpriteStore.SetTransform(entitySprite.handle, entity.position, entity.rotation);
+                }
+            }
+        };
+
+        updateSprites(interpolatedState.enemies, mapData.enemyTypes, ENEMIES_LAYER);
+        updateSprites(interpolatedState.towers, mapData.towerTypes, TOWERS_LAYER);
+        updateSprites(interpolatedState.projectiles, mapData.projectileTypes, PROJECTILES_LAYER);
+
+        // entities that are gone are only looked for when there are some
+        if (m_EntitySprites.size() != interpolatedState.GetEntityCount())
+        {
+            for (auto entitySpriteIt = m_EntitySprites.begin(); entitySpriteIt != m_EntitySprites.end();)
+            {
+                if (entitySpriteIt->second.lastFrame != m_EntitySpritesFrame)
+                {
+                    m_EntitySpriteStore.Remove(entitySpriteIt->second.handle);
+                    entitySpriteIt = m_EntitySprites.erase(entitySpriteIt);
+                }
+                else
+                {
+                    ++entitySpriteIt;
+                }
+            }
+        }
+
+        const usize rewrittenSprites = m_EntitySpriteStore.Flush();
+        TracyPlot("Entity Sprites Rewritten", (i64)rewrittenSprites);
+    }
+
+    // the map is resident, only the ranges the camera can see get drawn
+    cgt::render::SpriteDrawList& entitiesDrawList = m_EntitySpriteStore.GetDrawList();
+    frame.AddStaticBatch(*m_StaticMapBatch);
+    frame.AddDrawList(entitiesDrawList);
+
+    cgt::render::RenderStats renderStats;
+    renderStats.atlasDrawcallsSaved += m_StaticMapDrawcallsSaved;
+    renderStats.atlasDrawcallsSaved += tilesetHelper->GetAtlas().CountDrawcallsSaved(entitiesDrawList);
 
     return renderStats;
 }
@@ -1,30 +1,81 @@
 #pragma once
 
 #include <render_core/i_render_context.h>
+#include <render_core/sprite_frame.h>
 
 #include <examples/tower_defence/map_data.h>
 #include <examples/tower_defence/game_state.h>
+#include <examples/tower_defence/command_log.h>
 
 class GameSession
 {
 public:
     static std::unique_ptr<GameSession> FromMap(const std::filesystem::path mapAbsolutePath, cgt::render::IRenderContext& render, float fixedTimeDelta);
 
-    void TimeStep(const GameCommandQueue& commands, GameEventQueue& outGameEvents);
+    // loads only the simulation part of the map, such session can't be rendered
+    static std::unique_ptr<GameSession> FromMapHeadless(const std::filesystem::path mapAbsolutePath, float fixedTimeDelta);
+
+    // parallelizes the simulation steps over the job system, null runs them on the calling thread
+    void SetJobSystem(cgt::JobSystem* jobSystem) { m_JobSystem = jobSystem; }
+
+    // every time step gets recorded into the log while it's set
+    void SetCommandRecorder(CommandLogWriter* recorder) { m_CommandRecorder = recorder; }
+
+    // every time step gets snapshotted into the history while it's set, which makes rewinding possible
+    void SetSnapshotHistory(cgt::SnapshotHistory* history) { m_SnapshotHistory = history; }
+
+    // goes back to an earlier tick from the snapshot history, returns false if the tick isn't there.
+    // Stops the command recording, the log can't go back in time
+    bool RewindTo(u32 tick);
+
+    float GetFixedDelta() const { return m_FixedDelta; }
+
+    void TimeStep(const GameCommandQueue& commands, GameEventQueue& outGameEvents, TimeStepStats* outStats = nullptr);
     void InterpolateState(GameState& outState, float amount);
 
-    cgt::render::RenderStats RenderWorld(GameState& interpolatedState, cgt::render::IRenderContext& render, cgt::render::ICamera& camera);
+    const GameState& GetPreviousState() const { return *m_PrevState; }
+    const GameState& GetCurrentState() const { return *m_NextState; }
+
+    // adds the map and the entities to the frame, the returned stats only have the drawcalls saved by the atlas in them.
+    // The frame has to be submitted before the next call.
+    // Can run on another thread than the time steps, as long as the state passed in isn't one of the session's own
+    cgt::render::RenderStats RenderWorld(GameState& interpolatedState, cgt::render::SpriteFrame& frame);
 
     MapData mapData;
     std::unique_ptr<cgt::TilesetHelper> tilesetHelper;
 
 private:
+    static std::unique_ptr<GameSession> LoadSimulation(tson::Map& map, float fixedTimeDelta);
+
     GameState m_GameStates[2];
     GameState* m_PrevState;
     GameState* m_NextState;
 
     float m_FixedDelta;
+    TimeStepScratch m_TimeStepScratch;
+    cgt::JobSystem* m_JobSystem = nullptr;
+    CommandLogWriter* m_CommandRecorder = nullptr;
+    cgt::SnapshotHistory* m_SnapshotHistory = nullptr;
+    std::vector<u8> m_SnapshotBuffer;
+
+    // the tile layers, encoded once when the map is loaded
+    std::unique_ptr<cgt::render::StaticSpriteBatch> m_StaticMapBatch;
+    u32 m_StaticMapDrawcallsSaved = 0;
+
+    struct EntitySprite
+    {
+        cgt::render::RetainedSpriteHandle handle;
+        // the last frame the entity was rendered in, the sprites of the ones that are gone get removed
+        u32 lastFrame = 0;
+    };
+
+    // sprites of the entities by their ids, kept across frames
+    cgt::render::RetainedSpriteStore m_EntitySpriteStore;
+    std::unordered_map<u32, EntitySprite> m_EntitySprites;
+    u32 m_EntitySpritesFrame = 0;
 
-    cgt::render::SpriteDrawList m_StaticMapDrawList;
-    cgt::render::SpriteDrawList m_EntitiesDrawList;
+    // ids get handed out again after going back, possibly to entities of other kinds, so rendering starts over after a rewind.
+    // Counted instead of clearing the sprites right away, the rewind can happen on the simulation thread
+    std::atomic<u32> m_RewindCount { 0 };
+    u32 m_RenderedRewindCount = 0;
 };
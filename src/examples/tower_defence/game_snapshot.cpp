@@ -0,0 +1,170 @@
+#include <examples/tower_defence/pch.h>
+
+#include <examples/tower_defence/game_snapshot.h>
+
+#include <cstring>
+
+namespace
+{
+
+class SnapshotWriter
+{
+public:
+    explicit SnapshotWriter(std::vector<u8>& outSnapshot)
+        : m_Snapshot(outSnapshot)
+    {
+        m_Snapshot.clear();
+    }
+
+    template<typename T>
+    void Write(const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const size_t offset = m_Snapshot.size();
+        m_Snapshot.resize(offset + sizeof(T));
+        std::memcpy(m_Snapshot.data() + offset, &value, sizeof(T));
+    }
+
+    template<typename TEntity, typename TOwner, typename TField>
+    void WriteColumn(const std::vector<TEntity>& entities, TField TOwner::* field)
+    {
+        static_assert(std::is_trivially_copyable_v<TField>);
+        size_t offset = m_Snapshot.size();
+        m_Snapshot.resize(offset + entities.size() * sizeof(TField));
+        for (const TEntity& entity : entities)
+        {
+            std::memcpy(m_Snapshot.data() + offset, &(entity.*field), sizeof(TField));
+            offset += sizeof(TField);
+        }
+    }
+
+private:
+    std::vector<u8>& m_Snapshot;
+};
+
+class SnapshotReader
+{
+public:
+    explicit SnapshotReader(const std::vector<u8>& snapshot)
+        : m_Snapshot(snapshot)
+    {
+    }
+
+    template<typename T>
+    void Read(T& outValue)
+    {
+        CGT_ASSERT_ALWAYS_MSG(m_Offset + sizeof(T) <= m_Snapshot.size(), "Snapshot is truncated");
+        std::memcpy(&outValue, m_Snapshot.data() + m_Offset, sizeof(T));
+        m_Offset += sizeof(T);
+    }
+
+    template<typename TEntity, typename TOwner, typename TField>
+    void ReadColumn(std::vector<TEntity>& outEntities, TField TOwner::* field)
+    {
+        CGT_ASSERT_ALWAYS_MSG(m_Offset + outEntities.size() * sizeof(TField) <= m_Snapshot.size(), "Snapshot is truncated");
+        for (TEntity& entity : outEntities)
+        {
+            std::memcpy(&(entity.*field), m_Snapshot.data() + m_Offset, sizeof(TField));
+            m_Offset += sizeof(TField);
+        }
+    }
+
+    bool IsAtEnd() const { return m_Offset == m_Snapshot.size(); }
+
+private:
+    const std::vector<u8>& m_Snapshot;
+    size_t m_Offset = 0;
+};
+
+// the same field lists drive both directions, so they can't get out of sync
+template<typename TFunction>
+void ForEachEnemyColumn(TFunction&& function)
+{
+    function(&Enemy::id);
+    function(&Enemy::typeIdx);
+    function(&Enemy::position);
+    function(&Enemy::rotation);
+    function(&Enemy::velocity);
+    function(&Enemy::remainingHealth);
+    function(&Enemy::nextWaypointIdx);
+    function(&Enemy::distanceToGoal);
+}
+
+template<typename TFunction>
+void ForEachTowerColumn(TFunction&& function)
+{
+    function(&Tower::id);
+    function(&Tower::typeIdx);
+    function(&Tower::position);
+    function(&Tower::rotation);
+    function(&Tower::timeSinceLastShot);
+}
+
+template<typename TFunction>
+void ForEachProjectileColumn(TFunction&& function)
+{
+    function(&Projectile::id);
+    function(&Projectile::typeIdx);
+    function(&Projectile::position);
+    function(&Projectile::rotation);
+    function(&Projectile::lastEnemyPosition);
+    function(&Projectile::targetEnemyIndex);
+    function(&Projectile::targetEnemyId);
+}
+
+}
+
+void SerializeGameState(const GameState& state, std::vector<u8>& outSnapshot)
+{
+    ZoneScoped;
+
+    SnapshotWriter writer(outSnapshot);
+
+    writer.Write(state.tick);
+    writer.Write(state.random.GetState());
+    writer.Write(state.playerState.gold);
+    writer.Write(state.playerState.lives);
+    writer.Write(state.nextObjectId);
+    writer.Write(state.hash);
+
+    writer.Write((u32)state.enemies.size());
+    writer.Write((u32)state.towers.size());
+    writer.Write((u32)state.projectiles.size());
+
+    ForEachEnemyColumn([&](auto field) { writer.WriteColumn(state.enemies, field); });
+    ForEachTowerColumn([&](auto field) { writer.WriteColumn(state.towers, field); });
+    ForEachProjectileColumn([&](auto field) { writer.WriteColumn(state.projectiles, field); });
+}
+
+void DeserializeGameState(const std::vector<u8>& snapshot, GameState& outState)
+{
+    ZoneScoped;
+
+    SnapshotReader reader(snapshot);
+
+    u64 randomState = 0;
+    reader.Read(outState.tick);
+    reader.Read(randomState);
+    reader.Read(outState.playerState.gold);
+    reader.Read(outState.playerState.lives);
+    reader.Read(outState.nextObjectId);
+    reader.Read(outState.hash);
+    outState.random.SetState(randomState);
+
+    u32 enemyCount = 0;
+    u32 towerCount = 0;
+    u32 projectileCount = 0;
+    reader.Read(enemyCount);
+    reader.Read(towerCount);
+    reader.Read(projectileCount);
+
+    outState.enemies.resize(enemyCount);
+    outState.towers.resize(towerCount);
+    outState.projectiles.resize(projectileCount);
+
+    ForEachEnemyColumn([&](auto field) { reader.ReadColumn(outState.enemies, field); });
+    ForEachTowerColumn([&](auto field) { reader.ReadColumn(outState.towers, field); });
+    ForEachProjectileColumn([&](auto field) { reader.ReadColumn(outState.projectiles, field); });
+
+    CGT_ASSERT_ALWAYS_MSG(reader.IsAtEnd(), "Snapshot of tick {} has trailing bytes", outState.tick);
+}
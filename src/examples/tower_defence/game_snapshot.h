@@ -0,0 +1,12 @@
+#pragma once
+
+#include <examples/tower_defence/game_state.h>
+
+/*
+ * Compact binary snapshot of a GameState: everything the simulation depends on, including the RNG state and the hash.
+ * Entities are written field by field (all ids, then all positions, ...), so a snapshot differs from the one
+ * of the previous tick in as few bytes as possible, which is what makes the deltas of cgt::SnapshotHistory small.
+ * Snapshots are meant to stay in memory, they use the byte order of the host.
+ */
+void SerializeGameState(const GameState& state, std::vector<u8>& outSnapshot);
+void DeserializeGameState(const std::vector<u8>& snapshot, GameState& outState);
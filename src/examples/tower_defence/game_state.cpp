@@ -2,12 +2,18 @@
 
 #include <examples/tower_defence/game_state.h>
 #include <examples/tower_defence/entity_types.h>
+#include <examples/tower_defence/enemy_soa.h>
+#include <examples/tower_defence/state_hash.h>
 #include <examples/tower_defence/helper_functions.h>
 
-void GameState::TimeStep(const MapData& mapData, const GameState& initial, GameState& next, const GameCommandQueue& commands, GameEventQueue& outGameEvents, float delta)
+void GameState::TimeStep(const MapData& mapData, const GameState& initial, GameState& next, const GameCommandQueue& commands, GameEventQueue& outGameEvents, float delta, TimeStepScratch& scratch, cgt::JobSystem* jobSystem, TimeStepStats* outStats)
 {
     ZoneScoped;
 
+    cgt::ScopedFloatEnvironment floatEnvironment;
+    cgt::Clock subsystemClock;
+    TimeStepStats stats;
+
     // clear next state and prepare it advancement
     next.enemies.clear();
     next.enemies.reserve(initial.enemies.size());
@@ -16,13 +22,14 @@ void GameState::TimeStep(const MapData& mapData, const GameState& initial, GameS
     next.projectiles.clear();
     next.projectiles.reserve(initial.projectiles.size());
 
+    next.tick = initial.tick + 1;
     next.playerState = initial.playerState;
-    next.randomEngine = initial.randomEngine;
+    next.random = initial.random;
     next.nextObjectId = initial.nextObjectId;
 
     // enemy movement system
     const float flockWaypointSteeringFactor = 1.0f;
-    const float flockSightRange = 3.0f;
+    const float flockSightRange = TimeStepScratch::FLOCK_SIGHT_RANGE;
     const float flockRoadRecenteringStartDistance = 0.7f;
     const float flockRoadRecenteringMaxDistance = 1.0f;
     const float flockRoadRecenteringFactor = 5.5f;
@@ -33,145 +40,209 @@ void GameState::TimeStep(const MapData& mapData, const GameState& initial, GameS
 
     const float flockCenteringFactor = 0.2f;
 
-    const auto& enemyPath = mapData.enemyPath;
-    for (const Enemy& enemy : initial.enemies)
-    {
-        Enemy& enemyNext = next.enemies.emplace_back();
-        enemyNext = enemy;
+    // spatial index of enemies at the start of the step, flocking only looks at the enemies around
+    cgt::SpatialGrid& initialEnemiesGrid = scratch.initialEnemiesGrid;
+    initialEnemiesGrid.Build((u32)initial.enemies.size(), [&](u32 i) { return initial.enemies[i].position; });
 
-        if (cgt::math::IsNearlyZero(enemy.remainingHealth)
-            || cgt::math::IsNearlyZero(cgt::math::DistanceSqr(enemy.position, enemyPath.waypoints.back())))
+    // every thread has its own storage, the same one is reused by all the serial parts below
+    thread_local std::vector<u32> enemyQueryStorage;
+
+    // runs the whole range on this thread without a job system, results don't depend on the way it's split
+    auto parallelFor = [jobSystem](u32 count, u32 chunkSize, const cgt::JobSystem::RangeFunction& function) {
+        if (jobSystem)
         {
-            next.enemies.pop_back();
-            continue;
+            // workers have to run under the same float environment as this thread
+            jobSystem->ParallelFor(count, chunkSize, [&function](u32 begin, u32 end) {
+                cgt::ScopedFloatEnvironment workerFloatEnvironment;
+                function(begin, end);
+            });
         }
+        else
+        {
+            function(0, count);
+        }
+    };
+
+    // every enemy writes only its own slot, the ones that left the game are compacted out afterwards in order
+    std::vector<u8>& enemyRemoved = scratch.enemyRemoved;
+    enemyRemoved.assign(initial.enemies.size(), 0);
+    next.enemies.resize(initial.enemies.size());
 
-        const glm::vec2 a = enemyPath.waypoints[enemy.nextWaypointIdx - 1];
-        const glm::vec2 b = enemyPath.waypoints[enemy.nextWaypointIdx];
-        const glm::vec2 targetDirection = glm::normalize(b - a);
-        const glm::vec2 inverseTargetDirection = targetDirection * -1.0f;
+    // enemies are visited in the order of the grid, so the neighbours of every enemy are next to it in memory
+    EnemySoA& initialEnemiesSoA = scratch.initialEnemiesSoA;
+    initialEnemiesSoA.Gather(initial.enemies, initialEnemiesGrid.GetSortedIndices());
 
-        const glm::vec2 closestPathPoint = glm::closestPointOnLine(enemy.position, a, b);
-        const float nextWaypointDistanceFromGoal = enemyPath.distancesToGoal[enemy.nextWaypointIdx];
-        const float enemyDistanceFromGoal = nextWaypointDistanceFromGoal + glm::distance(closestPathPoint, b);
-        enemyNext.distanceToGoal = enemyDistanceFromGoal;
+    FlockingParams flockingParams;
+    flockingParams.sightRange = flockSightRange;
+    flockingParams.desiredSpacing = flockDesiredSpacing;
+    flockingParams.minimumSpacing = flockMinimumSpacing;
 
-        const float pathLookahead = 1.0f;
-        if (cgt::math::DistanceSqr(closestPathPoint, b) < pathLookahead
-            && enemy.nextWaypointIdx < enemyPath.waypoints.size() - 1)
+    const auto& enemyPath = mapData.enemyPath;
+    auto updateEnemies = [&](u32 begin, u32 end) {
+        const EnemySoA& enemies = initialEnemiesSoA;
+        for (u32 slot = begin; slot < end; ++slot)
         {
-            ++enemyNext.nextWaypointIdx;
-        }
+            const u32 enemyIdx = enemies.sourceIndices[slot];
+            const glm::vec2 position(enemies.positionsX[slot], enemies.positionsY[slot]);
+            const u32 nextWaypointIdx = enemies.nextWaypointIndices[slot];
 
-        const auto& enemyType = mapData.enemyTypes[enemy.typeIdx];
+            Enemy& enemyNext = next.enemies[enemyIdx];
+            enemyNext = initial.enemies[enemyIdx];
 
-        u32 othersInSight = 0;
-        u32 othersInFrontThatAreTooClose = 0;
-        glm::vec2 othersCumulativePosition(0.0f);
-        glm::vec2 pushbackDirection(0.0f);
-        for (const auto& otherEnemy : initial.enemies)
-        {
-            if (&enemy == &otherEnemy)
+            if (cgt::math::IsNearlyZero(enemies.remainingHealths[slot])
+                || cgt::math::IsNearlyZero(cgt::math::DistanceSqr(position, enemyPath.waypoints.back())))
             {
+                enemyRemoved[enemyIdx] = 1;
                 continue;
             }
 
-            glm::vec2 fromOther = enemy.position - otherEnemy.position;
-            float fromOtherDistSqr = cgt::math::LengthSqr(fromOther);
-            if (fromOtherDistSqr > flockSightRange * flockSightRange)
+            const glm::vec2 a = enemyPath.waypoints[nextWaypointIdx - 1];
+            const glm::vec2 b = enemyPath.waypoints[nextWaypointIdx];
+            const glm::vec2 targetDirection = glm::normalize(b - a);
+
+            const glm::vec2 closestPathPoint = glm::closestPointOnLine(position, a, b);
+            const float nextWaypointDistanceFromGoal = enemyPath.distancesToGoal[nextWaypointIdx];
+            const float enemyDistanceFromGoal = nextWaypointDistanceFromGoal + glm::distance(closestPathPoint, b);
+            enemyNext.distanceToGoal = enemyDistanceFromGoal;
+
+            const float pathLookahead = 1.0f;
+            if (cgt::math::DistanceSqr(closestPathPoint, b) < pathLookahead
+                && nextWaypointIdx < enemyPath.waypoints.size() - 1)
             {
-                continue;
+                ++enemyNext.nextWaypointIdx;
             }
 
-            if (otherEnemy.distanceToGoal < enemy.distanceToGoal)
+            const auto& enemyType = mapData.enemyTypes[enemyNext.typeIdx];
+
+            FlockingSums flocking;
+            initialEnemiesGrid.ForEachCandidateRange(position, flockSightRange, [&](u32 rangeBegin, u32 rangeEnd) {
+                AccumulateFlocking(enemies, rangeBegin, rangeEnd, slot, flockingParams, flocking);
+            });
+
+            glm::vec2 roadRecenteringDirection = closestPathPoint - position;
+            const float distanceFromTheRoadCenter = glm::length(roadRecenteringDirection);
+            const float roadRecenteringForce = glm::smoothstep(flockRoadRecenteringStartDistance, flockRoadRecenteringMaxDistance, distanceFromTheRoadCenter);
+            roadRecenteringDirection = glm::normalize(roadRecenteringDirection) * roadRecenteringForce;
+
+            glm::vec2 recenteringDirection(0.0f);
+            if (flocking.othersInSight > 0)
             {
-                ++othersInSight;
-                othersCumulativePosition += otherEnemy.position;
+                glm::vec2 othersAveragePosition = flocking.othersCumulativePosition / (float)flocking.othersInSight;
+                recenteringDirection = glm::normalize(othersAveragePosition - position);
             }
 
-            if (fromOtherDistSqr < flockDesiredSpacing * flockDesiredSpacing)
-            {
-                if (otherEnemy.distanceToGoal < enemy.distanceToGoal)
-                {
-                    ++othersInFrontThatAreTooClose;
-                }
+            const float accelerationFactor = 10.0f;
+            const float acceleration = enemyType.speed * accelerationFactor;
 
-                float fromOtherDist = glm::sqrt(fromOtherDistSqr);
-                glm::vec2 fromOtherNorm = fromOther / fromOtherDist;
-                float pushbackForce = 1.0f - glm::smoothstep(flockMinimumSpacing, flockDesiredSpacing, fromOtherDist);
-                const glm::vec2 pushbackVector = fromOtherNorm * pushbackForce;
-                pushbackDirection += pushbackVector;
+            glm::vec2 velocity(enemies.velocitiesX[slot], enemies.velocitiesY[slot]);
+            velocity += targetDirection * flockWaypointSteeringFactor * acceleration * delta;
+            velocity += recenteringDirection * flockCenteringFactor * acceleration * delta;
+            velocity += roadRecenteringDirection * flockRoadRecenteringFactor * acceleration * delta;
+
+            const float velocityLength = glm::length(velocity);
+            const glm::vec2 velocityNormalized = velocity / velocityLength;
+            if (velocityLength > enemyType.speed)
+            {
+                velocity = velocityNormalized * enemyType.speed;
             }
+
+            velocity += flocking.pushbackDirection * flockPushbackFactor * acceleration * delta;
+
+            enemyNext.velocity = velocity;
+            enemyNext.rotation = cgt::math::VectorAngle(velocityNormalized);
+            enemyNext.position = position + velocity * delta;
         }
+    };
 
-        glm::vec2 roadRecenteringDirection = closestPathPoint - enemy.position;
-        const float distanceFromTheRoadCenter = glm::length(roadRecenteringDirection);
-        const float roadRecenteringForce = glm::smoothstep(flockRoadRecenteringStartDistance, flockRoadRecenteringMaxDistance, distanceFromTheRoadCenter);
-        roadRecenteringDirection = glm::normalize(roadRecenteringDirection) * roadRecenteringForce;
+    const u32 ENEMIES_CHUNK_SIZE = 256;
+    parallelFor((u32)initial.enemies.size(), ENEMIES_CHUNK_SIZE, updateEnemies);
 
-        glm::vec2 recenteringDirection(0.0f);
-        if (othersInSight > 0)
+    u32 keptEnemiesCount = 0;
+    for (u32 enemyIdx = 0; enemyIdx < next.enemies.size(); ++enemyIdx)
+    {
+        if (!enemyRemoved[enemyIdx])
         {
-            glm::vec2 othersAveragePosition = othersCumulativePosition / (float)othersInSight;
-            recenteringDirection = glm::normalize(othersAveragePosition - enemy.position);
+            if (keptEnemiesCount != enemyIdx)
+            {
+                next.enemies[keptEnemiesCount] = next.enemies[enemyIdx];
+            }
+            ++keptEnemiesCount;
         }
+    }
+    next.enemies.resize(keptEnemiesCount);
 
-        const float accelerationFactor = 10.0f;
-        const float acceleration = enemyType.speed * accelerationFactor;
+    stats.enemiesUpdate = subsystemClock.Tick();
 
-        enemyNext.velocity += targetDirection * flockWaypointSteeringFactor * acceleration * delta;
-        enemyNext.velocity += recenteringDirection * flockCenteringFactor * acceleration * delta;
-        enemyNext.velocity += roadRecenteringDirection * flockRoadRecenteringFactor * acceleration * delta;
+    // enemies don't move anymore during this step, so towers and splash damage can share a single index
+    cgt::SpatialGrid& nextEnemiesGrid = scratch.nextEnemiesGrid;
+    nextEnemiesGrid.Build((u32)next.enemies.size(), [&](u32 i) { return next.enemies[i].position; });
 
-        const float velocityLength = glm::length(enemyNext.velocity);
-        const glm::vec2 velocityNormalized = enemyNext.velocity / velocityLength;
-        if (velocityLength > enemyType.speed)
+    // towers update, targeting runs in parallel while the shots are fired in tower order,
+    // so projectile ids and events don't depend on the way the towers were split
+    using TowerShots = TimeStepScratch::TowerShots;
+    std::vector<TowerShots>& towerShots = scratch.towerShots;
+    towerShots.assign(initial.towers.size(), TowerShots());
+    next.towers.assign(initial.towers.begin(), initial.towers.end());
+
+    auto updateTowers = [&](u32 begin, u32 end) {
+        for (u32 towerIdx = begin; towerIdx < end; ++towerIdx)
         {
-            enemyNext.velocity = velocityNormalized * enemyType.speed;
-        }
+            Tower& towerNext = next.towers[towerIdx];
 
-        enemyNext.velocity += pushbackDirection * flockPushbackFactor * acceleration * delta;
+            const TowerType& type = mapData.towerTypes[towerNext.typeIdx];
+            enemyQueryStorage.clear();
+            QueryEnemiesInRadius(nextEnemiesGrid, next.enemies, towerNext.position, type.range, enemyQueryStorage);
+            if (enemyQueryStorage.empty())
+            {
+                continue;
+            }
 
-        enemyNext.rotation = cgt::math::VectorAngle(velocityNormalized);
-        enemyNext.position += enemyNext.velocity * delta;
-    }
+            // ties are broken by the index, so the target doesn't depend on the std::sort implementation
+            std::sort(enemyQueryStorage.begin(), enemyQueryStorage.end(), [&](u32 aIdx, u32 bIdx) {
+                const Enemy& a = next.enemies[aIdx];
+                const Enemy& b = next.enemies[bIdx];
+                return a.distanceToGoal < b.distanceToGoal || (a.distanceToGoal == b.distanceToGoal && aIdx < bIdx);
+            });
+
+            TowerShots& shots = towerShots[towerIdx];
+            shots.targetEnemyIdx = *enemyQueryStorage.begin();
+            const Enemy& targetEnemy = next.enemies[shots.targetEnemyIdx];
+            const glm::vec2 toEnemy = glm::normalize(targetEnemy.position - towerNext.position);
+            towerNext.rotation = cgt::math::VectorAngle(toEnemy);
+
+            towerNext.timeSinceLastShot += delta;
+            const float shotInterval = 1.0f / type.shotsPerSecond;
+            while (towerNext.timeSinceLastShot > shotInterval)
+            {
+                towerNext.timeSinceLastShot -= shotInterval;
+                ++shots.count;
+            }
+        }
+    };
 
-    // towers update
-    static std::vector<u32> enemyQueryStorage;
-    for (const Tower& tower : initial.towers)
-    {
-        Tower& towerNext = next.towers.emplace_back();
-        towerNext = tower;
+    const u32 TOWERS_CHUNK_SIZE = 16;
+    parallelFor((u32)initial.towers.size(), TOWERS_CHUNK_SIZE, updateTowers);
 
+    for (u32 towerIdx = 0; towerIdx < next.towers.size(); ++towerIdx)
+    {
+        const Tower& tower = initial.towers[towerIdx];
+        const Tower& towerNext = next.towers[towerIdx];
         const TowerType& type = mapData.towerTypes[tower.typeIdx];
-        enemyQueryStorage.clear();
-        QueryEnemiesInRadius(next.enemies, towerNext.position, type.range, enemyQueryStorage);
-        if (enemyQueryStorage.empty())
+        const TowerShots& shots = towerShots[towerIdx];
+        // towers without an enemy in range keep the default target, which doesn't have to exist
+        if (shots.count == 0)
         {
             continue;
         }
 
-        std::sort(enemyQueryStorage.begin(), enemyQueryStorage.end(), [&](u32 aIdx, u32 bIdx) {
-            const Enemy& a = next.enemies[aIdx];
-            const Enemy& b = next.enemies[bIdx];
-            return a.distanceToGoal < b.distanceToGoal;
-        });
-
-        const u32 targetEnemyIdx = *enemyQueryStorage.begin();
-        const Enemy& targetEnemy = next.enemies[targetEnemyIdx];
-        const glm::vec2 toEnemy = glm::normalize(targetEnemy.position - towerNext.position);
-        towerNext.rotation = cgt::math::VectorAngle(toEnemy);
-
-        towerNext.timeSinceLastShot += delta;
-        const float shotInterval = 1.0f / type.shotsPerSecond;
-        while (towerNext.timeSinceLastShot > shotInterval)
+        const Enemy& targetEnemy = next.enemies[shots.targetEnemyIdx];
+        for (u32 shotIdx = 0; shotIdx < shots.count; ++shotIdx)
         {
-            towerNext.timeSinceLastShot -= shotInterval;
             Projectile& newProjectile = next.projectiles.emplace_back();
             newProjectile.id = next.nextObjectId++;
             newProjectile.typeIdx = type.projectileTypeIdx;
             newProjectile.position = tower.position;
-            newProjectile.targetEnemyIndex = targetEnemyIdx;
+            newProjectile.targetEnemyIndex = shots.targetEnemyIdx;
             newProjectile.targetEnemyId = targetEnemy.id;
             newProjectile.lastEnemyPosition = targetEnemy.position;
             newProjectile.rotation = towerNext.rotation;
@@ -186,6 +257,8 @@ void GameState::TimeStep(const MapData& mapData, const GameState& initial, GameS
         }
     }
 
+    stats.towersUpdate = subsystemClock.Tick();
+
     // projectiles update
     auto applyDamageToEnemy = [&](Enemy& enemy, const Projectile& projectile, const ProjectileType& projectileType) {
         const bool enemyDied = enemy.remainingHealth <= projectileType.damage;
@@ -254,7 +327,7 @@ void GameState::TimeStep(const MapData& mapData, const GameState& initial, GameS
             if (!cgt::math::IsNearlyZero(projectileType.splashRadius))
             {
                 enemyQueryStorage.clear();
-                QueryEnemiesInRadius(next.enemies, targetPosition, projectileType.splashRadius, enemyQueryStorage);
+                QueryEnemiesInRadius(nextEnemiesGrid, next.enemies, targetPosition, projectileType.splashRadius, enemyQueryStorage);
                 for (u32 enemyIndex : enemyQueryStorage)
                 {
                     Enemy& enemy = next.enemies[enemyIndex];
@@ -264,6 +337,8 @@ void GameState::TimeStep(const MapData& mapData, const GameState& initial, GameS
         }
     }
 
+    stats.projectilesUpdate = subsystemClock.Tick();
+
     // game commands execution
     for (auto& command : commands)
     {
@@ -278,10 +353,10 @@ void GameState::TimeStep(const MapData& mapData, const GameState& initial, GameS
             enemy.id = next.nextObjectId++;
             SetupEnemy(mapData.enemyTypes, cmdData.enemyType, mapData.enemyPath, enemy);
 
-            std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
-            glm::vec2 randomShift(
-                distribution(next.randomEngine),
-                distribution(next.randomEngine));
+            // separate statements, the evaluation order of constructor arguments is unspecified
+            glm::vec2 randomShift;
+            randomShift.x = next.random.NextFloat(-1.0f, 1.0f);
+            randomShift.y = next.random.NextFloat(-1.0f, 1.0f);
             enemy.position += randomShift;
             break;
         }
@@ -316,6 +391,16 @@ void GameState::TimeStep(const MapData& mapData, const GameState& initial, GameS
         }
         }
     }
+
+    stats.commandsExecution = subsystemClock.Tick();
+
+    ComputeStateHash(next, jobSystem, next.hash);
+    stats.stateHashing = subsystemClock.Tick();
+
+    if (outStats)
+    {
+        *outStats = stats;
+    }
 }
 
 template<class TEntity>
@@ -356,45 +441,44 @@ void GameState::Interpolate(const GameState& prevState, const GameState& nextSta
     InterpolateEntities<Projectile>(prevState.projectiles, nextState.projectiles, outState.projectiles, amount);
 }
 
-void GameState::QueryEnemiesInRadius(const std::vector<Enemy>& enemies, glm::vec2 position, float radius, std::vector<u32>& outResults)
+void GameState::QueryEnemiesInRadius(const cgt::SpatialGrid& enemiesGrid, const std::vector<Enemy>& enemies, glm::vec2 position, float radius, std::vector<u32>& outResults)
 {
-    const float radiusSqr = radius * radius;
-    for (u32 i = 0; i < enemies.size(); ++i)
-    {
-        const Enemy& enemy = enemies[i];
-        if (cgt::math::IsNearlyZero(enemy.remainingHealth))
-        {
-            continue;
-        }
+    CGT_ASSERT(enemiesGrid.GetPointCount() == enemies.size());
 
-        const glm::vec2 x = enemy.position - position;
-        const float distanceSqr = glm::dot(x, x);
-        if (distanceSqr <= radiusSqr)
-        {
-            outResults.emplace_back(i);
-        }
-    }
+    const usize firstResult = outResults.size();
+    enemiesGrid.QueryRadius(position, radius, outResults);
+
+    // health changes during the step while positions don't, so dead enemies are filtered out here instead of the grid
+    auto deadEnemiesBegin = std::remove_if(outResults.begin() + firstResult, outResults.end(), [&](u32 enemyIdx) {
+        return cgt::math::IsNearlyZero(enemies[enemyIdx].remainingHealth);
+    });
+    outResults.erase(deadEnemiesBegin, outResults.end());
 }
 
 void GameState::ForEachEntity(const MapData& mapData, std::function<void(const Entity&, const EntityType&)> function) const
 {
-    for (const auto& enemy : enemies)
-    {
-        const auto& type = mapData.enemyTypes[enemy.typeIdx];
-        function(enemy, type);
-    }
+    ForEachEntity(mapData, 0, GetEntityCount(), function);
+}
 
-    for (const auto& tower : towers)
-    {
-        const auto& type = mapData.towerTypes[tower.typeIdx];
-        function(tower, type);
-    }
+void GameState::ForEachEntity(const MapData& mapData, u32 begin, u32 end, const std::function<void(const Entity&, const EntityType&)>& function) const
+{
+    CGT_ASSERT(begin <= end && end <= GetEntityCount());
 
-    for (const auto& projectile : projectiles)
+    // enemies, then towers, then projectiles, every kind visits the part of the range that falls on it
+    auto visit = [&](const auto& entities, const auto& types, u32 kindStart)
     {
-        const auto& type = mapData.projectileTypes[projectile.typeIdx];
-        function(projectile, type);
-    }
+        const u32 kindEnd = kindStart + (u32)entities.size();
+        for (u32 i = glm::max(begin, kindStart); i < glm::min(end, kindEnd); ++i)
+        {
+            const auto& entity = entities[i - kindStart];
+            function(entity, types[entity.typeIdx]);
+        }
+        return kindEnd;
+    };
+
+    u32 kindStart = visit(enemies, mapData.enemyTypes, 0);
+    kindStart = visit(towers, mapData.towerTypes, kindStart);
+    visit(projectiles, mapData.projectileTypes, kindStart);
 }
 
 void GameState::ForEachEnemy(const MapData& mapData, std::function<void(const Enemy&, const EnemyType&)> function) const
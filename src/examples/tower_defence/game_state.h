@@ -2,6 +2,7 @@
 
 #include <examples/tower_defence/entities.h>
 #include <examples/tower_defence/map_data.h>
+#include <examples/tower_defence/enemy_soa.h>
 
 struct GameCommand
 {
@@ -76,15 +77,80 @@ struct GameEvent
 
 typedef std::vector<GameEvent> GameEventQueue;
 
+// time spent in every subsystem during a TimeStep, in seconds
+struct TimeStepStats
+{
+    void operator+=(const TimeStepStats& other)
+    {
+        enemiesUpdate += other.enemiesUpdate;
+        towersUpdate += other.towersUpdate;
+        projectilesUpdate += other.projectilesUpdate;
+        commandsExecution += other.commandsExecution;
+        stateHashing += other.stateHashing;
+    }
+
+    float enemiesUpdate = 0.0f;
+    float towersUpdate = 0.0f;
+    float projectilesUpdate = 0.0f;
+    float commandsExecution = 0.0f;
+    float stateHashing = 0.0f;
+};
+
+// see state_hash.h for the way it's computed
+struct GameStateHash
+{
+    u64 Total() const
+    {
+        auto rotate = [](u64 value, u32 bits) { return (value << bits) | (value >> (64 - bits)); };
+        return player ^ rotate(enemies, 16) ^ rotate(towers, 32) ^ rotate(projectiles, 48);
+    }
+
+    bool operator==(const GameStateHash& other) const
+    {
+        return player == other.player && enemies == other.enemies && towers == other.towers && projectiles == other.projectiles;
+    }
+
+    bool operator!=(const GameStateHash& other) const { return !(*this == other); }
+
+    u64 player = 0;
+    u64 enemies = 0;
+    u64 towers = 0;
+    u64 projectiles = 0;
+};
+
 struct PlayerState
 {
     float gold;
     u32 lives;
 };
 
+/*
+ * Buffers a TimeStep works in, kept between the steps so they don't get reallocated every tick.
+ * Whatever runs time steps at the same time as another one, like a second session or another thread, needs a scratch of its own.
+ */
+struct TimeStepScratch
+{
+    // the enemies grids are bucketed by it, so flocking only visits the cells around every enemy
+    static constexpr float FLOCK_SIGHT_RANGE = 3.0f;
+
+    struct TowerShots
+    {
+        u32 targetEnemyIdx = 0;
+        u32 count = 0;
+    };
+
+    cgt::SpatialGrid initialEnemiesGrid { FLOCK_SIGHT_RANGE };
+    cgt::SpatialGrid nextEnemiesGrid { FLOCK_SIGHT_RANGE };
+    std::vector<u8> enemyRemoved;
+    EnemySoA initialEnemiesSoA;
+    std::vector<TowerShots> towerShots;
+};
+
 struct GameState
 {
-    std::default_random_engine randomEngine;
+    // amount of time steps that led to this state
+    u32 tick = 0;
+    cgt::Random random;
 
     PlayerState playerState;
     std::vector<Enemy> enemies;
@@ -93,11 +159,21 @@ struct GameState
 
     u32 nextObjectId = 0;
 
-    static void TimeStep(const MapData& mapData, const GameState& initialState, GameState& outNextState, const GameCommandQueue& commands, GameEventQueue& outGameEvents, float delta);
+    // hash of this state, computed at the end of every TimeStep
+    GameStateHash hash;
+
+    // results only depend on the inputs: they are bit-identical with and without a job system, for any amount of threads,
+    // and across platforms and compilers as long as they follow IEEE 754 (the sim and the engine are built with fp contraction disabled)
+    // Time steps running at the same time have to work in scratches of their own, see TimeStepScratch
+    static void TimeStep(const MapData& mapData, const GameState& initialState, GameState& outNextState, const GameCommandQueue& commands, GameEventQueue& outGameEvents, float delta, TimeStepScratch& scratch, cgt::JobSystem* jobSystem = nullptr, TimeStepStats* outStats = nullptr);
     static void Interpolate(const GameState& prevState, const GameState& nextState, GameState& outState, float amount);
 
-    static void QueryEnemiesInRadius(const std::vector<Enemy>& enemies, glm::vec2 position, float radius, std::vector<u32>& outResults);
+    // results are in ascending index order, same as a linear scan over all of the enemies would produce
+    static void QueryEnemiesInRadius(const cgt::SpatialGrid& enemiesGrid, const std::vector<Enemy>& enemies, glm::vec2 position, float radius, std::vector<u32>& outResults);
 
     void ForEachEntity(const MapData& mapData, std::function<void(const Entity&, const EntityType&)> function) const;
+    // entities [begin, end) of the order ForEachEntity visits them in, so ranges can be visited on different threads
+    void ForEachEntity(const MapData& mapData, u32 begin, u32 end, const std::function<void(const Entity&, const EntityType&)>& function) const;
+    u32 GetEntityCount() const { return (u32)(enemies.size() + towers.size() + projectiles.size()); }
     void ForEachEnemy(const MapData& mapData, std::function<void(const Enemy&, const EnemyType&)> function) const;
 };
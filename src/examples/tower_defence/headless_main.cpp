@@ -0,0 +1,593 @@
+#include <examples/tower_defence/pch.h>
+
+#include <examples/tower_defence/game_session.h>
+#include <examples/tower_defence/state_hash.h>
+#include <examples/tower_defence/game_snapshot.h>
+
+namespace
+{
+
+struct EnemySpawn
+{
+    u32 typeIdx = 0;
+    u32 count = 0;
+    u32 startTick = 0;
+    u32 maxPerTick = 0; // 0 means all at once
+};
+
+struct TowerPlacement
+{
+    u32 typeIdx = 0;
+    glm::vec2 position = glm::vec2(0.0f);
+};
+
+struct HeadlessScenario
+{
+    std::filesystem::path mapPath = "examples/maps/tower_defense.json";
+    u32 ticks = 300;
+    u32 reportInterval = 0;
+    u32 threads = 0;
+
+    std::filesystem::path recordPath;
+    std::filesystem::path replayPath;
+
+    float snapshotSeconds = 0.0f;
+    u32 keyframeInterval = 30;
+
+    std::filesystem::path hashLogPath;
+    std::filesystem::path compareHashLogPath;
+    bool hashLogEntities = false;
+    bool verifyDeterminism = false;
+
+    std::vector<EnemySpawn> enemySpawns;
+    std::vector<TowerPlacement> towerPlacements;
+};
+
+void PrintUsage()
+{
+    fmt::print(stderr,
+        "Usage: tower_defence_headless [options]\n"
+        "  --map <path>                          map to load, relative to the assets folder\n"
+        "  --ticks <count>                       amount of fixed time steps to simulate (default: 300)\n"
+        "  --enemies <type>:<count>[@<tick>][/<per tick>]\n"
+        "                                        spawns enemies of the type index, starting at the tick,\n"
+        "                                        optionally spread over several ticks\n"
+        "  --tower <type>:<x>,<y>                builds a tower of the type index on the tile at tick 0\n"
+        "  --report <interval>                   prints the state every <interval> ticks\n"
+        "  --threads <count>                     threads to simulate on, 1 is serial (default: all hardware threads)\n"
+        "  --record <path>                       writes the commands of every tick to a binary command log\n"
+        "  --replay <path>                       replays a command log at full speed instead of the scenario,\n"
+        "                                        the map and the tick count come from the log\n"
+        "  --snapshots <seconds>                 keeps the snapshot history of the last <seconds>, reports its memory\n"
+        "                                        and the time it takes to seek to random ticks in it\n"
+        "  --keyframe-interval <ticks>           ticks between snapshot keyframes (default: 30)\n"
+        "  --hash-log <path>                     writes the state hash of every tick to the file\n"
+        "  --hash-log-entities                   adds the hashes of every entity to the hash log\n"
+        "  --compare-hash-log <path>             compares every tick with a hash log of another run,\n"
+        "                                        stops at the first divergent tick\n"
+        "  --verify-determinism                  simulates a serial copy of the session in lockstep\n"
+        "                                        and stops at the first divergent tick\n");
+}
+
+// the whole string has to be a number that fits
+bool ParseU32(const char* str, u32& outValue)
+{
+    char* cursor = nullptr;
+    const unsigned long value = std::strtoul(str, &cursor, 10);
+    outValue = (u32)value;
+    return cursor != str && *cursor == '\0' && value <= UINT32_MAX;
+}
+
+bool ParseFloat(const char* str, float& outValue)
+{
+    char* cursor = nullptr;
+    outValue = std::strtof(str, &cursor);
+    return cursor != str && *cursor == '\0' && std::isfinite(outValue);
+}
+
+bool ParseEnemySpawn(const char* str, EnemySpawn& outSpawn)
+{
+    // <type>:<count>[@<tick>][/<per tick>]
+    char* cursor = nullptr;
+    outSpawn.typeIdx = std::strtoul(str, &cursor, 10);
+    if (*cursor != ':')
+    {
+        return false;
+    }
+
+    outSpawn.count = std::strtoul(cursor + 1, &cursor, 10);
+    if (*cursor == '@')
+    {
+        outSpawn.startTick = std::strtoul(cursor + 1, &cursor, 10);
+    }
+    if (*cursor == '/')
+    {
+        outSpawn.maxPerTick = std::strtoul(cursor + 1, &cursor, 10);
+    }
+
+    return *cursor == '\0';
+}
+
+bool ParseTowerPlacement(const char* str, TowerPlacement& outPlacement)
+{
+    // <type>:<x>,<y>
+    char* cursor = nullptr;
+    outPlacement.typeIdx = std::strtoul(str, &cursor, 10);
+    if (*cursor != ':')
+    {
+        return false;
+    }
+
+    outPlacement.position.x = std::strtof(cursor + 1, &cursor);
+    if (*cursor != ',')
+    {
+        return false;
+    }
+
+    outPlacement.position.y = std::strtof(cursor + 1, &cursor);
+    return *cursor == '\0';
+}
+
+bool ParseScenario(int argc, char** argv, HeadlessScenario& outScenario)
+{
+    for (i32 i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        if (arg == "--hash-log-entities")
+        {
+            outScenario.hashLogEntities = true;
+            continue;
+        }
+        else if (arg == "--verify-determinism")
+        {
+            outScenario.verifyDeterminism = true;
+            continue;
+        }
+
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value)
+        {
+            fmt::print(stderr, "Missing value for {}\n", arg);
+            return false;
+        }
+        ++i;
+
+        bool valid = true;
+        if (arg == "--map")
+        {
+            outScenario.mapPath = value;
+        }
+        else if (arg == "--ticks")
+        {
+            valid = ParseU32(value, outScenario.ticks);
+        }
+        else if (arg == "--report")
+        {
+            valid = ParseU32(value, outScenario.reportInterval);
+        }
+        else if (arg == "--threads")
+        {
+            valid = ParseU32(value, outScenario.threads);
+        }
+        else if (arg == "--record")
+        {
+            outScenario.recordPath = value;
+        }
+        else if (arg == "--replay")
+        {
+            outScenario.replayPath = value;
+        }
+        else if (arg == "--snapshots")
+        {
+            valid = ParseFloat(value, outScenario.snapshotSeconds) && outScenario.snapshotSeconds >= 0.0f;
+        }
+        else if (arg == "--keyframe-interval")
+        {
+            valid = ParseU32(value, outScenario.keyframeInterval) && outScenario.keyframeInterval > 0;
+        }
+        else if (arg == "--hash-log")
+        {
+            outScenario.hashLogPath = value;
+        }
+        else if (arg == "--compare-hash-log")
+        {
+            outScenario.compareHashLogPath = value;
+        }
+        else if (arg == "--enemies")
+        {
+            valid = ParseEnemySpawn(value, outScenario.enemySpawns.emplace_back());
+        }
+        else if (arg == "--tower")
+        {
+            valid = ParseTowerPlacement(value, outScenario.towerPlacements.emplace_back());
+        }
+        else
+        {
+            fmt::print(stderr, "Unknown option {}\n", arg);
+            return false;
+        }
+
+        if (!valid)
+        {
+            fmt::print(stderr, "Invalid value for {}: {}\n", arg, value);
+            return false;
+        }
+    }
+
+    if (!outScenario.replayPath.empty() && (!outScenario.enemySpawns.empty() || !outScenario.towerPlacements.empty()))
+    {
+        fmt::print(stderr, "--replay can't be combined with --enemies or --tower\n");
+        return false;
+    }
+
+    return true;
+}
+
+bool ValidateScenario(const HeadlessScenario& scenario, const MapData& mapData)
+{
+    bool valid = true;
+    for (const EnemySpawn& spawn : scenario.enemySpawns)
+    {
+        if (spawn.typeIdx >= mapData.enemyTypes.size())
+        {
+            fmt::print(stderr, "Enemy type {} doesn't exist, the map has:\n", spawn.typeIdx);
+            for (u32 i = 0; i < mapData.enemyTypes.size(); ++i)
+            {
+                fmt::print(stderr, "  {}: {}\n", i, mapData.enemyTypes[i].name);
+            }
+            valid = false;
+        }
+    }
+
+    for (const TowerPlacement& placement : scenario.towerPlacements)
+    {
+        if (placement.typeIdx >= mapData.towerTypes.size())
+        {
+            fmt::print(stderr, "Tower type {} doesn't exist, the map has:\n", placement.typeIdx);
+            for (u32 i = 0; i < mapData.towerTypes.size(); ++i)
+            {
+                fmt::print(stderr, "  {}: {}\n", i, mapData.towerTypes[i].name);
+            }
+            valid = false;
+        }
+        else if (!mapData.buildableMap.Query(placement.position))
+        {
+            fmt::print(stderr, "Warning: tile ({}, {}) is not buildable\n", placement.position.x, placement.position.y);
+        }
+    }
+
+    return valid;
+}
+
+// logs recorded on another map or corrupted ones can name types the loaded map doesn't have
+bool ValidateReplayCommands(const GameCommandQueue& commands, u32 tick, const MapData& mapData)
+{
+    for (const GameCommand& command : commands)
+    {
+        if (command.type == GameCommand::Type::Debug_SpawnEnemy && command.data.debug_spawnEnemyData.enemyType >= mapData.enemyTypes.size())
+        {
+            fmt::print(stderr, "Command log spawns enemy type {} at tick {}, the map has {} enemy types\n",
+                command.data.debug_spawnEnemyData.enemyType, tick, mapData.enemyTypes.size());
+            return false;
+        }
+        if (command.type == GameCommand::Type::BuildTower && command.data.buildTowerData.towerType >= mapData.towerTypes.size())
+        {
+            fmt::print(stderr, "Command log builds tower type {} at tick {}, the map has {} tower types\n",
+                command.data.buildTowerData.towerType, tick, mapData.towerTypes.size());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void EnqueueScenarioCommands(const HeadlessScenario& scenario, const MapData& mapData, u32 tick, GameCommandQueue& outCommands)
+{
+    if (tick == 0 && !scenario.towerPlacements.empty())
+    {
+        // the scenario pays for its towers itself, so they are always built
+        float towersCost = 0.0f;
+        for (const TowerPlacement& placement : scenario.towerPlacements)
+        {
+            towersCost += mapData.towerTypes[placement.typeIdx].cost;
+        }
+
+        auto& goldCmd = outCommands.emplace_back();
+        goldCmd.type = GameCommand::Type::Debug_AddGold;
+        goldCmd.data.debug_addGoldData.amount = towersCost;
+
+        for (const TowerPlacement& placement : scenario.towerPlacements)
+        {
+            auto& towerCmd = outCommands.emplace_back();
+            towerCmd.type = GameCommand::Type::BuildTower;
+            towerCmd.data.buildTowerData.towerType = placement.typeIdx;
+            towerCmd.data.buildTowerData.position = placement.position;
+        }
+    }
+
+    for (const EnemySpawn& spawn : scenario.enemySpawns)
+    {
+        if (tick < spawn.startTick)
+        {
+            continue;
+        }
+
+        const u32 perTick = spawn.maxPerTick > 0 ? spawn.maxPerTick : spawn.count;
+        // in 64 bits, spawning a whole wave at once makes the product overflow a u32 after enough ticks
+        const u32 alreadySpawned = (u32)glm::min((u64)spawn.count, (u64)(tick - spawn.startTick) * perTick);
+        const u32 toSpawn = glm::min(perTick, spawn.count - alreadySpawned);
+        for (u32 i = 0; i < toSpawn; ++i)
+        {
+            auto& spawnCmd = outCommands.emplace_back();
+            spawnCmd.type = GameCommand::Type::Debug_SpawnEnemy;
+            spawnCmd.data.debug_spawnEnemyData.enemyType = spawn.typeIdx;
+        }
+    }
+}
+
+void ReportSnapshotHistory(cgt::SnapshotHistory& history, float fixedDelta)
+{
+    if (history.IsEmpty())
+    {
+        return;
+    }
+
+    const double ticksPerMinute = 60.0 / fixedDelta;
+    const double bytesPerTick = (double)history.GetCompressedSize() / history.GetSnapshotCount();
+    fmt::print("Snapshot history: ticks {}-{}, {:.1f}KB compressed from {:.1f}KB ({:.1f}x), {:.1f}KB per minute\n",
+        history.GetOldestTick(),
+        history.GetNewestTick(),
+        history.GetCompressedSize() / 1024.0,
+        history.GetUncompressedSize() / 1024.0,
+        (double)history.GetUncompressedSize() / history.GetCompressedSize(),
+        bytesPerTick * ticksPerMinute / 1024.0);
+
+    // seeks to random ticks, every restored state has to hash to the hash it was simulated with
+    const u32 SEEK_COUNT = 100;
+    cgt::Random random;
+    random.Seed(history.GetNewestTick());
+
+    std::vector<u8> snapshot;
+    GameState state;
+    GameStateHash restoredHash;
+    float totalTime = 0.0f;
+    float maxTime = 0.0f;
+    cgt::Clock seekClock;
+    for (u32 i = 0; i < SEEK_COUNT; ++i)
+    {
+        const u32 tick = history.GetOldestTick() + random.NextU32() % (history.GetNewestTick() - history.GetOldestTick() + 1);
+
+        seekClock.Tick();
+        const bool restored = history.Restore(tick, snapshot);
+        DeserializeGameState(snapshot, state);
+        const float seekTime = seekClock.Tick();
+
+        ComputeStateHash(state, nullptr, restoredHash);
+        CGT_ASSERT_ALWAYS_MSG(restored && state.tick == tick && restoredHash == state.hash, "Snapshot of tick {} didn't restore correctly", tick);
+
+        totalTime += seekTime;
+        maxTime = glm::max(maxTime, seekTime);
+    }
+
+    fmt::print("Seek time: avg {:.3f}ms, max {:.3f}ms\n", totalTime * 1000.0f / SEEK_COUNT, maxTime * 1000.0f);
+}
+
+void PrintState(const char* label, const GameState& state)
+{
+    fmt::print("{}: enemies {}, towers {}, projectiles {}, gold {:.0f}, lives {}, next object id {}, hash {:016x}\n",
+        label,
+        state.enemies.size(),
+        state.towers.size(),
+        state.projectiles.size(),
+        state.playerState.gold,
+        state.playerState.lives,
+        state.nextObjectId,
+        state.hash.Total());
+}
+
+}
+
+int GameMain(int argc, char** argv)
+{
+    HeadlessScenario scenario;
+    if (!ParseScenario(argc, argv, scenario))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    float fixedDelta = 1.0f / 30.0f;
+
+    // a replay takes the map and the time step from the log, the recorded commands replace the scenario
+    std::unique_ptr<CommandLogReader> replayReader;
+    u32 replayTick = 0;
+    GameCommandQueue replayCommands;
+    bool replayHasCommands = false;
+    if (!scenario.replayPath.empty())
+    {
+        replayReader = std::make_unique<CommandLogReader>(scenario.replayPath);
+        scenario.mapPath = replayReader->GetMapPath();
+        fixedDelta = replayReader->GetFixedDelta();
+        replayHasCommands = replayReader->ReadNext(replayTick, replayCommands);
+        fmt::print("Replaying {} on {}\n", scenario.replayPath.string(), scenario.mapPath.string());
+    }
+
+    auto gameSession = GameSession::FromMapHeadless(cgt::AssetPath(scenario.mapPath), fixedDelta);
+    if (!ValidateScenario(scenario, gameSession->mapData))
+    {
+        return 1;
+    }
+
+    std::unique_ptr<cgt::JobSystem> jobSystem;
+    if (scenario.threads != 1)
+    {
+        jobSystem = std::make_unique<cgt::JobSystem>(scenario.threads > 1 ? scenario.threads - 1 : 0);
+        gameSession->SetJobSystem(jobSystem.get());
+    }
+    fmt::print("Simulating on {} thread(s)\n", jobSystem ? jobSystem->GetThreadCount() : 1);
+
+    // the reference session always runs serially, so it also catches results that depend on the thread count
+    std::unique_ptr<GameSession> referenceSession;
+    if (scenario.verifyDeterminism)
+    {
+        referenceSession = GameSession::FromMapHeadless(cgt::AssetPath(scenario.mapPath), fixedDelta);
+    }
+
+    std::unique_ptr<cgt::SnapshotHistory> snapshotHistory;
+    if (scenario.snapshotSeconds > 0.0f)
+    {
+        const u32 capacity = glm::max((u32)(scenario.snapshotSeconds / fixedDelta), scenario.keyframeInterval);
+        snapshotHistory = std::make_unique<cgt::SnapshotHistory>(capacity, scenario.keyframeInterval);
+        gameSession->SetSnapshotHistory(snapshotHistory.get());
+    }
+
+    std::unique_ptr<CommandLogWriter> commandRecorder;
+    if (!scenario.recordPath.empty())
+    {
+        commandRecorder = std::make_unique<CommandLogWriter>(scenario.recordPath, scenario.mapPath, fixedDelta);
+        gameSession->SetCommandRecorder(commandRecorder.get());
+    }
+
+    std::unique_ptr<StateHashLogWriter> hashLogWriter;
+    if (!scenario.hashLogPath.empty())
+    {
+        hashLogWriter = std::make_unique<StateHashLogWriter>(scenario.hashLogPath, scenario.hashLogEntities);
+    }
+
+    std::unique_ptr<StateHashLogReader> hashLogReader;
+    if (!scenario.compareHashLogPath.empty())
+    {
+        hashLogReader = std::make_unique<StateHashLogReader>(scenario.compareHashLogPath);
+    }
+
+    GameCommandQueue gameCommands;
+    GameEventQueue gameEvents;
+
+    TimeStepStats totalStats;
+    float totalTime = 0.0f;
+    float maxTickTime = 0.0f;
+    u64 totalEvents = 0;
+
+    cgt::Clock tickClock;
+    u32 tick = 0;
+    for (;; ++tick)
+    {
+        if (replayReader)
+        {
+            // the log stores the tick a step produced, so the commands go into the step producing that tick
+            const u32 stateTick = gameSession->GetCurrentState().tick;
+            if (replayHasCommands && replayTick <= stateTick)
+            {
+                // a zero tick delta or a log recorded from an earlier tick than the session starts at, the commands can't be replayed
+                fmt::print(stderr, "Command log tick mismatch: commands for tick {}, but the session is already at tick {}\n", replayTick, stateTick);
+                return 1;
+            }
+            else if (replayHasCommands && replayTick == stateTick + 1)
+            {
+                if (!ValidateReplayCommands(replayCommands, replayTick, gameSession->mapData))
+                {
+                    return 1;
+                }
+
+                gameCommands.swap(replayCommands);
+                replayHasCommands = replayReader->ReadNext(replayTick, replayCommands);
+            }
+            else if (!replayHasCommands && stateTick >= replayReader->GetEndTick())
+            {
+                break;
+            }
+        }
+        else if (tick >= scenario.ticks)
+        {
+            break;
+        }
+        else
+        {
+            EnqueueScenarioCommands(scenario, gameSession->mapData, tick, gameCommands);
+        }
+
+        tickClock.Tick();
+        TimeStepStats tickStats;
+        gameSession->TimeStep(gameCommands, gameEvents, &tickStats);
+        const float tickTime = tickClock.Tick();
+
+        const GameState& state = gameSession->GetCurrentState();
+        if (referenceSession)
+        {
+            GameEventQueue referenceEvents;
+            referenceSession->TimeStep(gameCommands, referenceEvents);
+
+            const GameState& referenceState = referenceSession->GetCurrentState();
+            if (state.hash != referenceState.hash)
+            {
+                fmt::print(stderr, "Determinism check failed at tick {}, {} (actual vs serial)\n", state.tick, DescribeFirstDifference(state, referenceState));
+                return 1;
+            }
+        }
+
+        if (hashLogWriter)
+        {
+            hashLogWriter->Write(state);
+        }
+
+        if (hashLogReader)
+        {
+            StateHashLogTick loggedTick;
+            if (!hashLogReader->ReadTick(loggedTick))
+            {
+                fmt::print(stderr, "Hash log ended before tick {}\n", state.tick);
+                return 1;
+            }
+
+            const std::string difference = StateHashLogReader::Compare(loggedTick, state);
+            if (!difference.empty())
+            {
+                fmt::print(stderr, "Hash log mismatch at tick {}: {}\n", state.tick, difference);
+                return 1;
+            }
+        }
+
+        totalStats += tickStats;
+        totalTime += tickTime;
+        maxTickTime = glm::max(maxTickTime, tickTime);
+        totalEvents += gameEvents.size();
+
+        gameCommands.clear();
+        gameEvents.clear();
+
+        if (scenario.reportInterval > 0 && (tick + 1) % scenario.reportInterval == 0)
+        {
+            PrintState(fmt::format("Tick {}", tick + 1).c_str(), gameSession->GetCurrentState());
+        }
+    }
+
+    if (referenceSession)
+    {
+        fmt::print("Determinism check passed, all {} ticks match the serial simulation\n", tick);
+    }
+
+    const u32 ticks = glm::max(tick, 1u);
+    auto toAverageMs = [ticks](float seconds) { return seconds * 1000.0f / ticks; };
+
+    fmt::print("Simulated {} ticks in {:.3f}s, {:.1f} ticks/s ({:.1f}x real time)\n",
+        tick,
+        totalTime,
+        tick / totalTime,
+        tick * fixedDelta / totalTime);
+    fmt::print("Tick time: avg {:.3f}ms, max {:.3f}ms\n", toAverageMs(totalTime), maxTickTime * 1000.0f);
+    fmt::print("Subsystems (avg per tick):\n");
+    fmt::print("  enemies      {:.3f}ms\n", toAverageMs(totalStats.enemiesUpdate));
+    fmt::print("  towers       {:.3f}ms\n", toAverageMs(totalStats.towersUpdate));
+    fmt::print("  projectiles  {:.3f}ms\n", toAverageMs(totalStats.projectilesUpdate));
+    fmt::print("  commands     {:.3f}ms\n", toAverageMs(totalStats.commandsExecution));
+    fmt::print("  hashing      {:.3f}ms\n", toAverageMs(totalStats.stateHashing));
+    fmt::print("Game events: {}\n", totalEvents);
+    PrintState("Final state", gameSession->GetCurrentState());
+
+    if (snapshotHistory)
+    {
+        ReportSnapshotHistory(*snapshotHistory, fixedDelta);
+    }
+
+    return 0;
+}
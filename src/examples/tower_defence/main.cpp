@@ -6,16 +6,76 @@
 #include <examples/tower_defence/game_state.h>
 #include <examples/tower_defence/game_session.h>
 #include <examples/tower_defence/helper_functions.h>
+#include <examples/tower_defence/simulation_thread.h>
+#include <examples/tower_defence/command_channel.h>
 
-int GameMain()
+int GameMain(int argc, char** argv)
 {
+    // --headless runs without a window and renders offscreen, meant for profiling the frame loop and for scripted sessions,
+    // --frames <count> quits after that many frames,
+    // --dump-frames <directory> writes every --dump-interval <n>-th frame as a PNG and the timings of all frames to the directory,
+    // --no-culling submits every sprite, for comparing against view culling,
+    // --render-thread draws every frame on a thread of its own while the game builds the next one,
+    // --sim-thread runs the simulation on a thread of its own instead of the fixed step loop of the frame,
+    // --record <path> writes the commands of the session to a log, tower_defence_headless --replay plays them back
+    bool headless = false;
+    bool spriteCulling = true;
+    bool useRenderThread = false;
+    bool useSimulationThread = false;
+    u32 frameLimit = 0;
+    std::optional<cgt::render::FrameDumpConfig> frameDumps;
+    std::filesystem::path recordPath;
+    for (i32 i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        if (arg == "--headless")
+        {
+            headless = true;
+        }
+        else if (arg == "--frames" && i + 1 < argc)
+        {
+            frameLimit = (u32)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--dump-frames" && i + 1 < argc)
+        {
+            frameDumps.emplace().directory = argv[++i];
+        }
+        else if (arg == "--dump-interval" && i + 1 < argc && frameDumps)
+        {
+            frameDumps->imageInterval = (u32)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--no-culling")
+        {
+            spriteCulling = false;
+        }
+        else if (arg == "--render-thread")
+        {
+            useRenderThread = true;
+        }
+        else if (arg == "--sim-thread")
+        {
+            useSimulationThread = true;
+        }
+        else if (arg == "--record" && i + 1 < argc)
+        {
+            recordPath = argv[++i];
+        }
+    }
+
     auto window = cgt::WindowConfig::Default()
         .WithTitle("Tower Defence")
         .WithDimensions(1920, 1080)
+        .WithHeadless(headless)
         .Build();
 
-    auto render = cgt::render::RenderConfig::Default(window)
-        .Build();
+    auto renderConfig = cgt::render::RenderConfig::Default(window)
+        .WithOffscreen(headless)
+        .WithSpriteCulling(spriteCulling);
+    if (frameDumps)
+    {
+        renderConfig = renderConfig.WithFrameDumps(*frameDumps);
+    }
+    auto render = renderConfig.Build();
 
     auto imguiHelper = cgt::ImGuiHelper::Create(window, render);
 
@@ -26,9 +86,20 @@ int GameMain()
     const float SCALE_FACTORS[] = { 4.0f, 3.0f, 2.0f, 1.0f, 1.0f / 2.0f, 1.0f / 3.0f, 1.0f / 4.0f, 1.0f / 5.0f, 1.0f / 6.0f, 1.0f / 7.0f, 1.0f / 8.0f, 1.0f / 9.0f, 1.0f / 10.0f };
     i32 scaleFactorIdx = 3;
 
+    // Tracy identifies plots by the pointers to their names, so they have to stay the same every frame
+    const char* BATCH_SIZE_PLOT_NAMES[cgt::render::RenderStats::BATCH_SIZE_BUCKET_COUNT] =
+        {
+            "Batches Of 1", "Batches Of 2-3", "Batches Of 4-7", "Batches Of 8-15", "Batches Of 16-31", "Batches Of 32-63",
+            "Batches Of 64-127", "Batches Of 128-255", "Batches Of 256-511", "Batches Of 512-1023", "Full Batches",
+        };
+
     cgt::render::CameraSimpleOrtho camera(*window);
     camera.pixelsPerUnit = 64.0f;
 
+    // the UI pushes into the channel, the commands due by a tick are drained into the queue right before it
+    GameCommandChannel commandChannel;
+    GameCommandSender inputCommands(commandChannel, GameCommandSource::Input);
+    GameCommandSender debugUiCommands(commandChannel, GameCommandSource::DebugUi);
     GameCommandQueue gameCommands;
     GameEventQueue gameEvents;
 
@@ -39,6 +110,7 @@ int GameMain()
     cgt::Clock clock;
     float accumulatedDelta = 0.0f;
     cgt::render::RenderStats renderStats;
+    cgt::render::RenderThreadStats renderThreadStats;
     SDL_Event event {};
 
     const float DT_SCALE_FACTORS[] = { 0.0f, 0.25f, 0.5f, 1.0f, 2.0f, 4.0f };
@@ -47,17 +119,58 @@ int GameMain()
 
     u32 selectedTowerTypeId = 0;
 
-    auto gameSession = GameSession::FromMap(cgt::AssetPath("examples/maps/tower_defense.json"), *render, FIXED_DELTA);
+    const std::filesystem::path MAP_PATH = "examples/maps/tower_defense.json";
+
+    cgt::JobSystem jobSystem;
+    auto gameSession = GameSession::FromMap(cgt::AssetPath(MAP_PATH), *render, FIXED_DELTA);
+    gameSession->SetJobSystem(&jobSystem);
+
+    // a minute of history to rewind through, a keyframe every second
+    cgt::SnapshotHistory snapshotHistory((u32)(60.0f / FIXED_DELTA), (u32)(1.0f / FIXED_DELTA));
+    gameSession->SetSnapshotHistory(&snapshotHistory);
+
+    std::unique_ptr<CommandLogWriter> commandRecorder;
+    if (!recordPath.empty())
+    {
+        commandRecorder = std::make_unique<CommandLogWriter>(recordPath, MAP_PATH, FIXED_DELTA);
+        gameSession->SetCommandRecorder(commandRecorder.get());
+    }
+
     cgt::render::SpriteDrawList effectsDrawList;
+    cgt::render::SpriteFrame spriteFrame;
+    const glm::vec4 CLEAR_COLOR(0.2f, 0.2f, 0.2f, 1.0f);
+
+    std::unique_ptr<cgt::render::RenderThread> renderThread;
+    if (useRenderThread)
+    {
+        renderThread = std::make_unique<cgt::render::RenderThread>(render, imguiHelper);
+    }
+
+    // takes the session over, from here on it's only rendered on this thread
+    std::unique_ptr<SimulationThread> simulationThread;
+    if (useSimulationThread)
+    {
+        simulationThread = std::make_unique<SimulationThread>(*gameSession, &snapshotHistory, commandChannel);
+    }
+
+    cgt::Clock runClock;
+    u32 frameCount = 0;
 
     bool quitRequested = false;
     while (!quitRequested)
     {
         ZoneScopedN("Main Loop");
 
+        if (frameLimit > 0 && frameCount == frameLimit)
+        {
+            break;
+        }
+        ++frameCount;
+
         effectsDrawList.clear();
 
         const float dt = clock.Tick();
+        if (!simulationThread)
         {
             const float scaledDt = dt * DT_SCALE_FACTORS[selectedDtScaleIdx];
             accumulatedDelta += scaledDt;
@@ -72,40 +185,95 @@ int GameMain()
                 quitRequested = true;
                 break;
             case SDL_MOUSEWHEEL:
+            {
                 auto wheel = event.wheel;
                 scaleFactorIdx -= wheel.y;
                 scaleFactorIdx = glm::clamp(scaleFactorIdx, 0, (i32)SDL_arraysize(SCALE_FACTORS) - 1);
                 break;
+            }
             case SDL_MOUSEBUTTONDOWN:
+            {
                 auto button = event.button;
                 lmbWasClicked = button.button == SDL_BUTTON_LEFT;
                 break;
             }
+            }
         }
 
         imguiHelper->NewFrame(dt, camera);
 
-        // NOTE: prone to "spiral of death"
-        // see https://www.gafferongames.com/post/fix_your_timestep/
-        while (accumulatedDelta > FIXED_DELTA)
+        // commands of this frame are meant for the tick after the newest one there is
+        u32 commandTick = 0;
+        if (simulationThread)
         {
-            accumulatedDelta -= FIXED_DELTA;
-            gameSession->TimeStep(gameCommands, gameEvents);
-            gameCommands.clear();
+            // the states are whatever the simulation published last
+            simulationThread->SetTimeScale(DT_SCALE_FACTORS[selectedDtScaleIdx]);
+            simulationThread->Update();
+            const SimulationFrame& simulationFrame = simulationThread->GetFrame();
+            GameState::Interpolate(simulationFrame.prevState, simulationFrame.nextState, interpolatedState, simulationThread->GetInterpolationAmount());
+            commandTick = simulationFrame.nextState.tick + 1;
+        }
+        else
+        {
+            // NOTE: prone to "spiral of death", --sim-thread isn't
+            // see https://www.gafferongames.com/post/fix_your_timestep/
+            while (accumulatedDelta > FIXED_DELTA)
+            {
+                accumulatedDelta -= FIXED_DELTA;
+                commandChannel.Drain(gameSession->GetCurrentState().tick + 1, gameCommands);
+                gameSession->TimeStep(gameCommands, gameEvents);
+                gameCommands.clear();
 
-            // FIXME: actually make use of events
-            gameEvents.clear();
+                // FIXME: actually make use of events
+                gameEvents.clear();
+            }
+
+            const float interpolationFactor = glm::smoothstep(0.0f, FIXED_DELTA, accumulatedDelta);
+            gameSession->InterpolateState(interpolatedState, interpolationFactor);
+            commandTick = gameSession->GetCurrentState().tick + 1;
         }
 
-        const float interpolationFactor = glm::smoothstep(0.0f, FIXED_DELTA, accumulatedDelta);
-        gameSession->InterpolateState(interpolatedState, interpolationFactor);
+        // whatever didn't fit into the channel in the frames before goes first
+        inputCommands.Flush();
+        debugUiCommands.Flush();
 
         {
-            ImGui::SetNextWindowSize({200, 80}, ImGuiCond_FirstUseEver);
+            ImGui::SetNextWindowSize({200, 100}, ImGuiCond_FirstUseEver);
             ImGui::Begin("Render Stats");
             ImGui::Text("Frame time: %.2fms", dt * 1000.0f);
             ImGui::Text("Sprites: %u", renderStats.spriteCount);
+            ImGui::Text("Culled: %u", renderStats.culledSpriteCount);
+            ImGui::Text("Static: %u", renderStats.staticSpriteCount);
             ImGui::Text("Drawcalls: %u", renderStats.drawcallCount);
+            ImGui::Text("Submit time: %.2fms", renderStats.submitTime * 1000.0f);
+            ImGui::Text("Saved by atlas: %u", renderStats.atlasDrawcallsSaved);
+            ImGui::Text("Saved by merging: %d", renderStats.mergedDrawcallsSaved);
+
+            ImGui::Separator();
+            ImGui::Text("Sort: %.2fms", renderStats.sortTime * 1000.0f);
+            ImGui::Text("Cull: %.2fms", renderStats.cullTime * 1000.0f);
+            ImGui::Text("Encode: %.2fms", renderStats.encodeTime * 1000.0f);
+            ImGui::Text("Upload: %.2fms", renderStats.uploadTime * 1000.0f);
+            ImGui::Text("Draw: %.2fms", renderStats.drawTime * 1000.0f);
+            ImGui::Text("Uploaded: %.1fKB", renderStats.uploadedBytes / 1024.0f);
+
+            ImGui::Separator();
+            ImGui::Text("Cut by texture: %u", renderStats.batchesCutByTexture);
+            ImGui::Text("Cut by batch size: %u", renderStats.batchesCutBySize);
+            float batchSizes[cgt::render::RenderStats::BATCH_SIZE_BUCKET_COUNT];
+            for (u32 bucket = 0; bucket < cgt::render::RenderStats::BATCH_SIZE_BUCKET_COUNT; ++bucket)
+            {
+                batchSizes[bucket] = (float)renderStats.batchSizeHistogram[bucket];
+            }
+            ImGui::PlotHistogram("##BatchSizes", batchSizes, cgt::render::RenderStats::BATCH_SIZE_BUCKET_COUNT, 0, "Batch sizes, 1 to 1024", 0.0f, std::numeric_limits<float>::max(), ImVec2(0.0f, 60.0f));
+
+            if (renderThread)
+            {
+                ImGui::Separator();
+                ImGui::Text("Render thread: %.2fms", renderThreadStats.renderTime * 1000.0f);
+                ImGui::Text("Waited for it: %.2fms", renderThreadStats.waitTime * 1000.0f);
+                ImGui::Text("Overlapped: %.2fms", renderThreadStats.overlapTime * 1000.0f);
+            }
             ImGui::End();
         }
 
@@ -190,11 +358,12 @@ int GameMain()
 
         if (lmbWasClicked && buildable)
         {
-            auto& gameCmd = gameCommands.emplace_back();
+            GameCommand gameCmd;
             gameCmd.type = GameCommand::Type::BuildTower;
             auto& cmdData = gameCmd.data.buildTowerData;
             cmdData.towerType = selectedTowerTypeId;
             cmdData.position = glm::vec2(tilePos.x, tilePos.y);
+            inputCommands.Send(gameCmd, commandTick);
         }
 
         {
@@ -208,6 +377,61 @@ int GameMain()
                 }
             }
 
+            // commands the channel had no room for yet, they go out over the next frames
+            const u32 backlogSize = inputCommands.GetBacklogSize() + debugUiCommands.GetBacklogSize();
+            if (backlogSize > 0)
+            {
+                ImGui::Text("Commands waiting: %u", backlogSize);
+            }
+
+            if (simulationThread)
+            {
+                ImGui::Separator();
+                ImGui::Text("Tick: %.2fms", simulationThread->GetFrame().tickTime * 1000.0f);
+                ImGui::Text("Dropped ticks: %u", simulationThread->GetFrame().droppedTicks);
+            }
+
+            ImGui::End();
+        }
+
+        {
+            ImGui::Begin("Rewind");
+
+            static float rewindSeconds = 5.0f;
+            ImGui::SliderFloat("Seconds", &rewindSeconds, 1.0f, 60.0f, "%.0f");
+
+            // the history belongs to the simulation thread while it runs, it publishes what's shown here
+            const u32 storedTicks = simulationThread ? simulationThread->GetFrame().historySnapshotCount : snapshotHistory.GetSnapshotCount();
+            const u64 compressedSize = simulationThread ? simulationThread->GetFrame().historyCompressedSize : snapshotHistory.GetCompressedSize();
+            const u64 uncompressedSize = simulationThread ? simulationThread->GetFrame().historyUncompressedSize : snapshotHistory.GetUncompressedSize();
+
+            if (ImGui::Button("Rewind") && storedTicks > 0)
+            {
+                const u32 currentTick = simulationThread ? simulationThread->GetFrame().nextState.tick : gameSession->GetCurrentState().tick;
+                const u32 rewindTicks = (u32)(rewindSeconds / FIXED_DELTA);
+                const u32 targetTick = currentTick > rewindTicks ? currentTick - rewindTicks : 0;
+                inputCommands.Clear();
+                debugUiCommands.Clear();
+                if (simulationThread)
+                {
+                    simulationThread->RequestRewind(targetTick);
+                }
+                else
+                {
+                    gameSession->RewindTo(glm::max(targetTick, snapshotHistory.GetOldestTick()));
+                    commandChannel.Clear();
+                    accumulatedDelta = 0.0f;
+                }
+            }
+
+            ImGui::Text("History: %.1fs", storedTicks * FIXED_DELTA);
+            ImGui::Text("Memory: %.1fKB (%.1fKB raw)", compressedSize / 1024.0f, uncompressedSize / 1024.0f);
+            if (storedTicks > 0)
+            {
+                const float bytesPerMinute = (float)compressedSize / storedTicks * (60.0f / FIXED_DELTA);
+                ImGui::Text("Per minute: %.1fKB", bytesPerMinute / 1024.0f);
+            }
+
             ImGui::End();
         }
 
@@ -241,25 +465,28 @@ int GameMain()
             {
                 for (i32 i = 0; i < enemiesToSpawn; ++i)
                 {
-                    auto& gameCmd = gameCommands.emplace_back();
+                    GameCommand gameCmd;
                     gameCmd.type = GameCommand::Type::Debug_SpawnEnemy;
                     auto& cmdData = gameCmd.data.debug_spawnEnemyData;
                     cmdData.enemyType = selectedEnemyIdx;
+                    debugUiCommands.Send(gameCmd, commandTick);
                 }
             }
 
             if (ImGui::Button("Despawn All"))
             {
-                auto& gameCmd = gameCommands.emplace_back();
+                GameCommand gameCmd;
                 gameCmd.type = GameCommand::Type::Debug_DespawnAllEnemies;
+                debugUiCommands.Send(gameCmd, commandTick);
             }
 
             if (ImGui::Button("Add 100 Gold"))
             {
-                auto& gameCmd = gameCommands.emplace_back();
+                GameCommand gameCmd;
                 gameCmd.type = GameCommand::Type::Debug_AddGold;
                 auto& cmdData = gameCmd.data.debug_addGoldData;
                 cmdData.amount = 100.0f;
+                debugUiCommands.Send(gameCmd, commandTick);
             }
 
             ImGui::End();
@@ -342,15 +569,74 @@ int GameMain()
 
         gameSession->mapData.enemyPath.DebugRender();
 
-        renderStats.Reset();
-        render->Clear({ 0.2f, 0.2f, 0.2f, 1.0f });
-        renderStats += gameSession->RenderWorld(interpolatedState, *render, camera);
-        renderStats += render->Submit(effectsDrawList, camera, false);
-        imguiHelper->RenderUi(camera);
-        render->Present();
+        spriteFrame.clear();
+        cgt::render::RenderStats gameStats = gameSession->RenderWorld(interpolatedState, spriteFrame);
+        spriteFrame.AddDrawList(effectsDrawList);
+        gameStats.atlasDrawcallsSaved += gameSession->tilesetHelper->GetAtlas().CountDrawcallsSaved(effectsDrawList);
+
+        if (renderThread)
+        {
+            cgt::render::FramePacket& packet = renderThread->BeginFrame();
+            packet.clearColor = CLEAR_COLOR;
+            packet.camera = cgt::render::CameraSnapshot(camera, window->GetWidth(), window->GetHeight());
+            packet.CaptureSprites(spriteFrame);
+            packet.gameStats = gameStats;
+            imguiHelper->CaptureUi(camera, packet.ui);
+            renderThread->SubmitFrame();
+
+            // the stats are of the frame drawn last, the one built here is drawn while the next one is built
+            renderStats = renderThread->GetLastFrameStats();
+            renderThreadStats = renderThread->GetStats();
+        }
+        else
+        {
+            render->Clear(CLEAR_COLOR);
+            renderStats = render->SubmitFrame(spriteFrame, camera);
+            renderStats += gameStats;
+            imguiHelper->RenderUi(camera);
+            render->Present();
+        }
 
         TracyPlot("Sprites", (i64)renderStats.spriteCount);
+        TracyPlot("Culled Sprites", (i64)renderStats.culledSpriteCount);
+        TracyPlot("Static Sprites", (i64)renderStats.staticSpriteCount);
         TracyPlot("Drawcalls", (i64)renderStats.drawcallCount);
+        TracyPlot("Drawcalls Saved By Atlas", (i64)renderStats.atlasDrawcallsSaved);
+        TracyPlot("Drawcalls Saved By Merging", (i64)renderStats.mergedDrawcallsSaved);
+        TracyPlot("Sort Time", renderStats.sortTime * 1000.0f);
+        TracyPlot("Cull Time", renderStats.cullTime * 1000.0f);
+        TracyPlot("Encode Time", renderStats.encodeTime * 1000.0f);
+        TracyPlot("Upload Time", renderStats.uploadTime * 1000.0f);
+        TracyPlot("Draw Time", renderStats.drawTime * 1000.0f);
+        TracyPlot("Uploaded Bytes", (i64)renderStats.uploadedBytes);
+        TracyPlot("Batches Cut By Texture", (i64)renderStats.batchesCutByTexture);
+        TracyPlot("Batches Cut By Size", (i64)renderStats.batchesCutBySize);
+        for (u32 bucket = 0; bucket < cgt::render::RenderStats::BATCH_SIZE_BUCKET_COUNT; ++bucket)
+        {
+            TracyPlot(BATCH_SIZE_PLOT_NAMES[bucket], (i64)renderStats.batchSizeHistogram[bucket]);
+        }
+        if (renderThread)
+        {
+            TracyPlot("Render Thread Time", renderThreadStats.renderTime * 1000.0f);
+            TracyPlot("Render Thread Wait", renderThreadStats.waitTime * 1000.0f);
+            TracyPlot("Render Thread Overlap", renderThreadStats.overlapTime * 1000.0f);
+        }
+        if (simulationThread)
+        {
+            TracyPlot("Simulation Tick Time", simulationThread->GetFrame().tickTime * 1000.0f);
+            TracyPlot("Simulation Dropped Ticks", (i64)simulationThread->GetFrame().droppedTicks);
+        }
+    }
+
+    if (renderThread)
+    {
+        renderThread->Flush();
+    }
+
+    if (frameLimit > 0)
+    {
+        const float totalSeconds = runClock.Tick();
+        fmt::print("{} frames in {:.2f}s, {:.3f}ms per frame\n", frameCount, totalSeconds, totalSeconds * 1000.0f / frameCount);
     }
 
     return 0;
@@ -25,7 +25,13 @@ public:
         return m_Grid[y * m_Width + x];
     }
 
-    bool Query(glm::vec2 position)
+    u8 At(u32 x, u32 y) const
+    {
+        CGT_ASSERT(x < m_Width && y < m_Height);
+        return m_Grid[y * m_Width + x];
+    }
+
+    bool Query(glm::vec2 position) const
     {
         auto tile = WorldToTile(position);
         tile.y *= -1;
@@ -37,7 +43,7 @@ public:
         return At((u32)tile.x, (u32)tile.y) == 1;
     }
 
-    glm::ivec2 WorldToTile(glm::vec2 world)
+    glm::ivec2 WorldToTile(glm::vec2 world) const
     {
         const glm::ivec2 tile(
             (i32)glm::trunc(world.x + 0.5f * glm::sign(world.x)),
@@ -0,0 +1,126 @@
+#include <examples/tower_defence/pch.h>
+
+#include <examples/tower_defence/simulation_thread.h>
+#include <examples/tower_defence/game_session.h>
+#include <examples/tower_defence/command_channel.h>
+
+SimulationThread::SimulationThread(GameSession& session, cgt::SnapshotHistory* snapshotHistory, GameCommandChannel& commands)
+    : m_Session(session)
+    , m_SnapshotHistory(snapshotHistory)
+    , m_FixedDelta(session.GetFixedDelta())
+    , m_Commands(commands)
+{
+    // the frame loop has the state the session starts with until the first ticks are done
+    Publish(0.0f, 0.0f);
+    Update();
+
+    m_Thread = std::thread([this]() { SimulationLoop(); });
+}
+
+SimulationThread::~SimulationThread()
+{
+    m_Quit.store(true, std::memory_order_relaxed);
+    m_Thread.join();
+}
+
+void SimulationThread::RequestRewind(u32 tick)
+{
+    m_RewindTick.store(tick, std::memory_order_relaxed);
+}
+
+bool SimulationThread::Update()
+{
+    return m_Frames.Update();
+}
+
+float SimulationThread::GetInterpolationAmount() const
+{
+    const SimulationFrame& frame = GetFrame();
+
+    const float sincePublish = float((SDL_GetPerformanceCounter() - frame.publishTime) / (double)SDL_GetPerformanceFrequency());
+    const float simulatedDelta = frame.leftoverDelta + sincePublish * m_TimeScale.load(std::memory_order_relaxed);
+
+    return glm::smoothstep(0.0f, m_FixedDelta, simulatedDelta);
+}
+
+void SimulationThread::SimulationLoop()
+{
+    tracy::SetThreadName("Simulation");
+
+    cgt::Clock clock;
+    float accumulatedDelta = 0.0f;
+
+    while (!m_Quit.load(std::memory_order_relaxed))
+    {
+        const float timeScale = m_TimeScale.load(std::memory_order_relaxed);
+        accumulatedDelta += clock.Tick() * timeScale;
+
+        const u32 rewindTick = m_RewindTick.exchange(NO_REWIND, std::memory_order_relaxed);
+        if (rewindTick != NO_REWIND && m_SnapshotHistory && !m_SnapshotHistory->IsEmpty())
+        {
+            // the commands were meant for the ticks that are gone now
+            m_Commands.Clear();
+            m_Session.RewindTo(glm::max(rewindTick, m_SnapshotHistory->GetOldestTick()));
+            accumulatedDelta = 0.0f;
+            Publish(accumulatedDelta, 0.0f);
+        }
+
+        u32 tickCount = 0;
+        float tickTime = 0.0f;
+        while (accumulatedDelta > m_FixedDelta && tickCount < MAX_CATCH_UP_TICKS)
+        {
+            ZoneScopedN("Simulation Tick");
+
+            accumulatedDelta -= m_FixedDelta;
+            ++tickCount;
+
+            m_Commands.Drain(m_Session.GetCurrentState().tick + 1, m_TickCommands);
+
+            cgt::Clock tickClock;
+            m_Session.TimeStep(m_TickCommands, m_TickEvents);
+            tickTime = tickClock.Tick();
+
+            m_TickCommands.clear();
+            // FIXME: actually make use of events
+            m_TickEvents.clear();
+        }
+
+        // whatever is still left can't be caught up with, it's dropped so the next rounds don't fall behind even further
+        if (accumulatedDelta > m_FixedDelta)
+        {
+            m_DroppedTicks += (u32)(accumulatedDelta / m_FixedDelta);
+            accumulatedDelta = glm::mod(accumulatedDelta, m_FixedDelta);
+        }
+
+        if (tickCount > 0)
+        {
+            Publish(accumulatedDelta, tickTime);
+        }
+
+        // sleeps until the next tick is due, at most a tick long so a changed time scale or quitting gets picked up soon
+        const float untilNextTick = timeScale > 0.0f ? (m_FixedDelta - accumulatedDelta) / timeScale : m_FixedDelta;
+        std::this_thread::sleep_for(std::chrono::duration<float>(glm::clamp(untilNextTick, 0.0f, m_FixedDelta)));
+    }
+}
+
+void SimulationThread::Publish(float leftoverDelta, float tickTime)
+{
+    ZoneScoped;
+
+    SimulationFrame& frame = m_Frames.GetWriteBuffer();
+    frame.prevState = m_Session.GetPreviousState();
+    frame.nextState = m_Session.GetCurrentState();
+    frame.leftoverDelta = leftoverDelta;
+    frame.publishTime = SDL_GetPerformanceCounter();
+    frame.tickTime = tickTime;
+    frame.droppedTicks = m_DroppedTicks;
+
+    if (m_SnapshotHistory)
+    {
+        frame.historySnapshotCount = m_SnapshotHistory->GetSnapshotCount();
+        frame.historyCompressedSize = m_SnapshotHistory->GetCompressedSize();
+        frame.historyUncompressedSize = m_SnapshotHistory->GetUncompressedSize();
+    }
+
+    m_Frames.Publish();
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <examples/tower_defence/game_state.h>
+
+class GameSession;
+class GameCommandChannel;
+
+// what the simulation thread publishes after the ticks it runs
+struct SimulationFrame
+{
+    // the two newest states, the frame loop interpolates between them
+    GameState prevState;
+    GameState nextState;
+
+    // simulated seconds that were left over for the next tick, and when that was, in SDL performance counter ticks
+    float leftoverDelta = 0.0f;
+    u64 publishTime = 0;
+
+    // seconds the last tick took
+    float tickTime = 0.0f;
+    // ticks dropped so far because the simulation fell too far behind
+    u32 droppedTicks = 0;
+
+    // the snapshot history belongs to the simulation thread while it runs, so whatever the UI shows of it comes along
+    u32 historySnapshotCount = 0;
+    u64 historyCompressedSize = 0;
+    u64 historyUncompressedSize = 0;
+};
+
+/*
+ * Runs the time steps of a session on a thread of its own at its fixed delta, so hitches of the frame loop never slow the simulation down
+ * and a heavy tick never holds up a frame. The states are published through a triple buffer after every round of ticks,
+ * the frame loop picks up the newest ones whenever it gets to it, without either side waiting for the other.
+ * While it runs, the thread owns the simulation side of the session along with its snapshot history and command recorder:
+ * the frame loop only renders, and talks to the simulation through the command channel and rewind requests.
+ */
+class SimulationThread : private NonCopyable
+{
+public:
+    // the most ticks run to catch up with real time in one go, the rest is dropped instead of falling further behind every round
+    static constexpr u32 MAX_CATCH_UP_TICKS = 5;
+
+    // drains the commands due by every tick from the channel right before running it
+    SimulationThread(GameSession& session, cgt::SnapshotHistory* snapshotHistory, GameCommandChannel& commands);
+    ~SimulationThread();
+
+    // the tick is clamped to the oldest one in the snapshot history, the commands sent so far are dropped
+    void RequestRewind(u32 tick);
+
+    // simulated seconds per real second, 0 pauses the simulation
+    void SetTimeScale(float timeScale) { m_TimeScale.store(timeScale, std::memory_order_relaxed); }
+
+    // picks up the newest published frame, returns false if nothing was published since the last time
+    bool Update();
+    const SimulationFrame& GetFrame() const { return m_Frames.GetReadBuffer(); }
+
+    // how far the simulation has got from the previous state of the frame towards the next one by now,
+    // eased the same way as the interpolation of the fixed step loop
+    float GetInterpolationAmount() const;
+
+private:
+    static constexpr u32 NO_REWIND = std::numeric_limits<u32>::max();
+
+    void SimulationLoop();
+    void Publish(float leftoverDelta, float tickTime);
+
+    GameSession& m_Session;
+    cgt::SnapshotHistory* m_SnapshotHistory;
+    float m_FixedDelta;
+
+    cgt::TripleBuffer<SimulationFrame> m_Frames;
+
+    GameCommandChannel& m_Commands;
+    // the commands of the tick that's running, kept so it doesn't get reallocated
+    GameCommandQueue m_TickCommands;
+    GameEventQueue m_TickEvents;
+
+    std::atomic<u32> m_RewindTick { NO_REWIND };
+    std::atomic<float> m_TimeScale { 1.0f };
+    std::atomic<bool> m_Quit { false };
+    u32 m_DroppedTicks = 0;
+
+    std::thread m_Thread;
+};
@@ -0,0 +1,347 @@
+#include <examples/tower_defence/pch.h>
+
+#include <examples/tower_defence/state_hash.h>
+
+#include <sstream>
+
+namespace
+{
+
+u64 Mix(u64 hash, u64 value)
+{
+    hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+// murmur3 finalizer, spreads every input bit over the whole hash before the entity hashes get summed
+u64 Finalize(u64 hash)
+{
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+u64 Mix(u64 hash, float value)
+{
+    return Mix(hash, (u64)(u32)cgt::math::ReinterpretAsInt(value));
+}
+
+u64 Mix(u64 hash, glm::vec2 value)
+{
+    return Mix(Mix(hash, value.x), value.y);
+}
+
+u64 HashEntity(HashedEntityKind kind, const Entity& entity, u32 idx)
+{
+    u64 hash = (u64)kind + 1;
+    hash = Mix(hash, (u64)idx);
+    hash = Mix(hash, (u64)entity.id);
+    hash = Mix(hash, (u64)entity.typeIdx);
+    hash = Mix(hash, entity.position);
+    return hash;
+}
+
+template<typename TEntity>
+u64 SumHashes(const std::vector<TEntity>& entities, u64 (*hashFunction)(const TEntity&, u32), cgt::JobSystem* jobSystem)
+{
+    const u32 CHUNK_SIZE = 4096;
+    if (!jobSystem || entities.size() <= CHUNK_SIZE)
+    {
+        u64 sum = 0;
+        for (u32 i = 0; i < entities.size(); ++i)
+        {
+            sum += hashFunction(entities[i], i);
+        }
+        return sum;
+    }
+
+    // wrapping addition doesn't care about the order the chunks finish in
+    std::atomic<u64> sum { 0 };
+    jobSystem->ParallelFor((u32)entities.size(), CHUNK_SIZE, [&](u32 begin, u32 end) {
+        u64 chunkSum = 0;
+        for (u32 i = begin; i < end; ++i)
+        {
+            chunkSum += hashFunction(entities[i], i);
+        }
+        sum.fetch_add(chunkSum, std::memory_order_relaxed);
+    });
+
+    return sum.load();
+}
+
+u64 HashPlayer(const GameState& state)
+{
+    u64 hash = Mix(0, (u64)state.tick);
+    hash = Mix(hash, state.random.GetState());
+    hash = Mix(hash, state.playerState.gold);
+    hash = Mix(hash, (u64)state.playerState.lives);
+    hash = Mix(hash, (u64)state.nextObjectId);
+    hash = Mix(hash, (u64)state.enemies.size());
+    hash = Mix(hash, (u64)state.towers.size());
+    hash = Mix(hash, (u64)state.projectiles.size());
+    return Finalize(hash);
+}
+
+template<typename TEntity>
+std::string DescribeEntitiesDifference(HashedEntityKind kind, const std::vector<TEntity>& a, const std::vector<TEntity>& b, u64 (*hashFunction)(const TEntity&, u32), const std::function<std::string(const TEntity&)>& describe)
+{
+    const char* name = HashedEntityKindName(kind);
+    for (u32 i = 0; i < std::min(a.size(), b.size()); ++i)
+    {
+        if (hashFunction(a[i], i) != hashFunction(b[i], i))
+        {
+            return fmt::format("{} {} (id {} vs {}): {} vs {}", name, i, a[i].id, b[i].id, describe(a[i]), describe(b[i]));
+        }
+    }
+
+    if (a.size() != b.size())
+    {
+        return fmt::format("{} count: {} vs {}", name, a.size(), b.size());
+    }
+
+    return {};
+}
+
+}
+
+const char* HashedEntityKindName(HashedEntityKind kind)
+{
+    switch (kind)
+    {
+    case HashedEntityKind::Enemy: return "enemy";
+    case HashedEntityKind::Tower: return "tower";
+    case HashedEntityKind::Projectile: return "projectile";
+    }
+
+    return "unknown";
+}
+
+u64 HashEnemy(const Enemy& enemy, u32 idx)
+{
+    u64 hash = HashEntity(HashedEntityKind::Enemy, enemy, idx);
+    hash = Mix(hash, enemy.velocity);
+    hash = Mix(hash, enemy.remainingHealth);
+    hash = Mix(hash, (u64)enemy.nextWaypointIdx);
+    hash = Mix(hash, enemy.distanceToGoal);
+    return Finalize(hash);
+}
+
+u64 HashTower(const Tower& tower, u32 idx)
+{
+    u64 hash = HashEntity(HashedEntityKind::Tower, tower, idx);
+    hash = Mix(hash, tower.timeSinceLastShot);
+    return Finalize(hash);
+}
+
+u64 HashProjectile(const Projectile& projectile, u32 idx)
+{
+    u64 hash = HashEntity(HashedEntityKind::Projectile, projectile, idx);
+    hash = Mix(hash, projectile.lastEnemyPosition);
+    hash = Mix(hash, (u64)projectile.targetEnemyIndex);
+    hash = Mix(hash, (u64)projectile.targetEnemyId);
+    return Finalize(hash);
+}
+
+void ComputeStateHash(const GameState& state, cgt::JobSystem* jobSystem, GameStateHash& outHash)
+{
+    ZoneScoped;
+
+    outHash.player = HashPlayer(state);
+    outHash.enemies = SumHashes(state.enemies, &HashEnemy, jobSystem);
+    outHash.towers = SumHashes(state.towers, &HashTower, jobSystem);
+    outHash.projectiles = SumHashes(state.projectiles, &HashProjectile, jobSystem);
+}
+
+void ForEachEntityHash(const GameState& state, const std::function<void(HashedEntityKind, u32, u32, u64)>& function)
+{
+    for (u32 i = 0; i < state.enemies.size(); ++i)
+    {
+        function(HashedEntityKind::Enemy, i, state.enemies[i].id, HashEnemy(state.enemies[i], i));
+    }
+
+    for (u32 i = 0; i < state.towers.size(); ++i)
+    {
+        function(HashedEntityKind::Tower, i, state.towers[i].id, HashTower(state.towers[i], i));
+    }
+
+    for (u32 i = 0; i < state.projectiles.size(); ++i)
+    {
+        function(HashedEntityKind::Projectile, i, state.projectiles[i].id, HashProjectile(state.projectiles[i], i));
+    }
+}
+
+std::string DescribeFirstDifference(const GameState& a, const GameState& b)
+{
+    if (a.tick != b.tick)
+    {
+        return fmt::format("tick: {} vs {}", a.tick, b.tick);
+    }
+
+    if (a.random.GetState() != b.random.GetState())
+    {
+        return fmt::format("random state: {:016x} vs {:016x}", a.random.GetState(), b.random.GetState());
+    }
+
+    if (a.playerState.gold != b.playerState.gold || a.playerState.lives != b.playerState.lives)
+    {
+        return fmt::format("player state: gold {} lives {} vs gold {} lives {}", a.playerState.gold, a.playerState.lives, b.playerState.gold, b.playerState.lives);
+    }
+
+    if (a.nextObjectId != b.nextObjectId)
+    {
+        return fmt::format("next object id: {} vs {}", a.nextObjectId, b.nextObjectId);
+    }
+
+    std::string difference = DescribeEntitiesDifference<Enemy>(HashedEntityKind::Enemy, a.enemies, b.enemies, &HashEnemy, [](const Enemy& enemy) {
+        return fmt::format("[position ({}, {}), velocity ({}, {}), health {}, waypoint {}, distance {}]",
+            enemy.position.x, enemy.position.y, enemy.velocity.x, enemy.velocity.y,
+            enemy.remainingHealth, enemy.nextWaypointIdx, enemy.distanceToGoal);
+    });
+
+    if (difference.empty())
+    {
+        difference = DescribeEntitiesDifference<Tower>(HashedEntityKind::Tower, a.towers, b.towers, &HashTower, [](const Tower& tower) {
+            return fmt::format("[type {}, position ({}, {}), since last shot {}]",
+                tower.typeIdx, tower.position.x, tower.position.y, tower.timeSinceLastShot);
+        });
+    }
+
+    if (difference.empty())
+    {
+        difference = DescribeEntitiesDifference<Projectile>(HashedEntityKind::Projectile, a.projectiles, b.projectiles, &HashProjectile, [](const Projectile& projectile) {
+            return fmt::format("[position ({}, {}), target {} (id {}), last target position ({}, {})]",
+                projectile.position.x, projectile.position.y, projectile.targetEnemyIndex, projectile.targetEnemyId,
+                projectile.lastEnemyPosition.x, projectile.lastEnemyPosition.y);
+        });
+    }
+
+    return difference;
+}
+
+StateHashLogWriter::StateHashLogWriter(const std::filesystem::path& path, bool withEntities)
+    : m_Stream(path)
+    , m_WithEntities(withEntities)
+{
+    CGT_ASSERT_ALWAYS_MSG(m_Stream.is_open(), "Failed to open the hash log for writing: {}", path.string());
+}
+
+void StateHashLogWriter::Write(const GameState& state)
+{
+    const GameStateHash& hash = state.hash;
+    m_Stream << fmt::format("tick {} {:016x} {:016x} {:016x} {:016x}\n", state.tick, hash.player, hash.enemies, hash.towers, hash.projectiles);
+
+    if (m_WithEntities)
+    {
+        ForEachEntityHash(state, [this](HashedEntityKind kind, u32 idx, u32 id, u64 entityHash) {
+            m_Stream << fmt::format("{} {} {} {:016x}\n", (u32)kind, idx, id, entityHash);
+        });
+    }
+}
+
+StateHashLogReader::StateHashLogReader(const std::filesystem::path& path)
+    : m_Stream(path)
+{
+    CGT_ASSERT_ALWAYS_MSG(m_Stream.is_open(), "Failed to open the hash log for reading: {}", path.string());
+}
+
+bool StateHashLogReader::ReadTick(StateHashLogTick& outTick)
+{
+    if (m_PendingLine.empty() && !std::getline(m_Stream, m_PendingLine))
+    {
+        return false;
+    }
+
+    std::istringstream tickLine(m_PendingLine);
+    std::string tag;
+    tickLine >> tag >> outTick.tick >> std::hex
+        >> outTick.hash.player >> outTick.hash.enemies >> outTick.hash.towers >> outTick.hash.projectiles;
+    CGT_ASSERT_ALWAYS_MSG(tag == "tick" && !tickLine.fail(), "Malformed hash log line: {}", m_PendingLine);
+    m_PendingLine.clear();
+
+    // entity lines follow their tick line until the next one
+    outTick.entities.clear();
+    std::string line;
+    while (std::getline(m_Stream, line))
+    {
+        if (line.rfind("tick", 0) == 0)
+        {
+            m_PendingLine = line;
+            break;
+        }
+
+        u32 kind = 0;
+        EntityHashRecord& record = outTick.entities.emplace_back();
+        std::istringstream entityLine(line);
+        entityLine >> kind >> record.idx >> record.id >> std::hex >> record.hash;
+        CGT_ASSERT_ALWAYS_MSG(!entityLine.fail(), "Malformed hash log line: {}", line);
+        record.kind = (HashedEntityKind)kind;
+    }
+
+    return true;
+}
+
+std::string StateHashLogReader::Compare(const StateHashLogTick& logged, const GameState& state)
+{
+    if (logged.tick != state.tick)
+    {
+        return fmt::format("logged tick {} is compared to tick {}", logged.tick, state.tick);
+    }
+
+    if (logged.hash == state.hash)
+    {
+        return {};
+    }
+
+    if (!logged.entities.empty())
+    {
+        std::string difference;
+        u32 recordIdx = 0;
+        ForEachEntityHash(state, [&](HashedEntityKind kind, u32 idx, u32 id, u64 hash) {
+            if (!difference.empty())
+            {
+                return;
+            }
+
+            if (recordIdx >= logged.entities.size())
+            {
+                difference = fmt::format("{} {} (id {}) is not in the log", HashedEntityKindName(kind), idx, id);
+                return;
+            }
+
+            const EntityHashRecord& record = logged.entities[recordIdx++];
+            if (record.kind != kind || record.idx != idx || record.id != id || record.hash != hash)
+            {
+                difference = fmt::format("logged {} {} (id {}, hash {:016x}) vs {} {} (id {}, hash {:016x})",
+                    HashedEntityKindName(record.kind), record.idx, record.id, record.hash,
+                    HashedEntityKindName(kind), idx, id, hash);
+            }
+        });
+
+        if (difference.empty() && recordIdx < logged.entities.size())
+        {
+            const EntityHashRecord& record = logged.entities[recordIdx];
+            difference = fmt::format("logged {} {} (id {}) is missing", HashedEntityKindName(record.kind), record.idx, record.id);
+        }
+
+        if (!difference.empty())
+        {
+            return difference;
+        }
+    }
+
+    std::string parts;
+    auto appendIfDifferent = [&](const char* name, u64 logged, u64 actual) {
+        if (logged != actual)
+        {
+            parts += fmt::format("{}{}", parts.empty() ? "" : ", ", name);
+        }
+    };
+    appendIfDifferent("player", logged.hash.player, state.hash.player);
+    appendIfDifferent("enemies", logged.hash.enemies, state.hash.enemies);
+    appendIfDifferent("towers", logged.hash.towers, state.hash.towers);
+    appendIfDifferent("projectiles", logged.hash.projectiles, state.hash.projectiles);
+    return fmt::format("hash of {} differs", parts);
+}
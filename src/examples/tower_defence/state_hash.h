@@ -0,0 +1,80 @@
+#pragma once
+
+#include <examples/tower_defence/game_state.h>
+
+/*
+ * Every entity is hashed on its own together with its index and the entity hashes are summed up,
+ * so the hash of a state can be computed in parallel and in any order.
+ * It's recomputed from scratch every tick rather than updated incrementally: enemies and projectiles move and towers
+ * count down to their next shot every tick, so nearly every entity hash changes anyway, and tracking which ones didn't
+ * would cost more than hashing them again.
+ * Rotations are left out: they are presentation only and come from acos and fmod in cgt::math::VectorAngle,
+ * and acos differs between C runtimes.
+ */
+
+enum class HashedEntityKind : u8
+{
+    Enemy,
+    Tower,
+    Projectile,
+};
+
+const char* HashedEntityKindName(HashedEntityKind kind);
+
+u64 HashEnemy(const Enemy& enemy, u32 idx);
+u64 HashTower(const Tower& tower, u32 idx);
+u64 HashProjectile(const Projectile& projectile, u32 idx);
+
+void ComputeStateHash(const GameState& state, cgt::JobSystem* jobSystem, GameStateHash& outHash);
+void ForEachEntityHash(const GameState& state, const std::function<void(HashedEntityKind, u32 idx, u32 id, u64 hash)>& function);
+
+// human readable description of the first field that differs, empty when the hashed parts of the states are the same
+std::string DescribeFirstDifference(const GameState& a, const GameState& b);
+
+struct EntityHashRecord
+{
+    HashedEntityKind kind;
+    u32 idx;
+    u32 id;
+    u64 hash;
+};
+
+struct StateHashLogTick
+{
+    u32 tick = 0;
+    GameStateHash hash;
+
+    // only present when the log was written with entities
+    std::vector<EntityHashRecord> entities;
+};
+
+/*
+ * Text log of the state hashes of every tick, written by one run and checked by another one.
+ * With entities it's much bigger, but a mismatch can be tracked down to a single entity.
+ */
+class StateHashLogWriter
+{
+public:
+    StateHashLogWriter(const std::filesystem::path& path, bool withEntities);
+
+    void Write(const GameState& state);
+
+private:
+    std::ofstream m_Stream;
+    bool m_WithEntities;
+};
+
+class StateHashLogReader
+{
+public:
+    explicit StateHashLogReader(const std::filesystem::path& path);
+
+    bool ReadTick(StateHashLogTick& outTick);
+
+    // empty when the state matches the logged tick, otherwise describes the first mismatching part or entity
+    static std::string Compare(const StateHashLogTick& logged, const GameState& state);
+
+private:
+    std::ifstream m_Stream;
+    std::string m_PendingLine;
+};
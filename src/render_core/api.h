@@ -1,7 +1,20 @@
 #pragma once
 
 #include <render_core/i_render_context.h>
+#include <render_core/texture.h>
 #include <render_core/render_config.h>
 #include <render_core/sprite_draw_list.h>
+#include <render_core/sprite_instance_encoder.h>
+#include <render_core/retained_sprite_store.h>
+#include <render_core/sprite_culling.h>
+#include <render_core/static_sprite_batch.h>
+#include <render_core/cpu_static_sprite_batch.h>
+#include <render_core/sprite_frame.h>
+#include <render_core/frame_packet.h>
+#include <render_core/render_thread.h>
 #include <render_core/i_camera.h>
-#include <render_core/camera_simple_ortho.h>
\ No newline at end of file
+#include <render_core/camera_simple_ortho.h>
+#include <render_core/camera_snapshot.h>
+#include <render_core/frame_dumper.h>
+#include <render_core/image.h>
+#include <render_core/texture_atlas.h>
\ No newline at end of file
@@ -83,6 +83,16 @@ glm::vec2 CameraSimpleOrtho::ScreenToWorld(u32 screenX, u32 screenY) const
     return world;
 }
 
+cgt::math::AABB CameraSimpleOrtho::GetViewBounds() const
+{
+    // corners of the NDC square, so the pixel snapping of the view is taken into account
+    const glm::mat4 vpInverse = glm::inverse(GetViewProjection());
+    const glm::vec2 a = vpInverse * glm::vec4(-1.0f, -1.0f, 0.0f, 1.0f);
+    const glm::vec2 b = vpInverse * glm::vec4(1.0f, 1.0f, 0.0f, 1.0f);
+
+    return cgt::math::AABB::FromPoints(a, b);
+}
+
 glm::vec2 CameraSimpleOrtho::WorldToScreen(glm::vec2 world) const
 {
     const glm::mat4 vp = GetViewProjection();
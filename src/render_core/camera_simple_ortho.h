@@ -25,6 +25,8 @@ public:
     glm::vec2 ScreenToWorld(u32 screenX, u32 screenY) const override;
     glm::vec2 WorldToScreen(glm::vec2 world) const override;
 
+    cgt::math::AABB GetViewBounds() const override;
+
     bool IsOrthographic() const override;
 
     float pixelsPerUnit = 1.0f;
@@ -0,0 +1,84 @@
+#include <render_core/pch.h>
+
+#include <render_core/camera_snapshot.h>
+
+namespace cgt::render
+{
+
+CameraSnapshot::CameraSnapshot(const ICamera& camera, u32 viewportWidth, u32 viewportHeight)
+    : m_View(camera.GetView())
+    , m_Projection(camera.GetProjection())
+    , m_ViewProjection(camera.GetViewProjection())
+    , m_Position(camera.GetPosition())
+    , m_ForwardDirection(camera.GetForwardDirection())
+    , m_UpDirection(camera.GetUpDirection())
+    , m_ViewBounds(camera.GetViewBounds())
+    , m_IsOrthographic(camera.IsOrthographic())
+    , m_ViewportSize((float)viewportWidth, (float)viewportHeight)
+{
+}
+
+glm::mat4 CameraSnapshot::GetView() const
+{
+    return m_View;
+}
+
+glm::mat4 CameraSnapshot::GetProjection() const
+{
+    return m_Projection;
+}
+
+glm::mat4 CameraSnapshot::GetViewProjection() const
+{
+    return m_ViewProjection;
+}
+
+glm::vec3 CameraSnapshot::GetPosition() const
+{
+    return m_Position;
+}
+
+glm::vec3 CameraSnapshot::GetForwardDirection() const
+{
+    return m_ForwardDirection;
+}
+
+glm::vec3 CameraSnapshot::GetUpDirection() const
+{
+    return m_UpDirection;
+}
+
+glm::vec2 CameraSnapshot::ScreenToWorld(u32 screenX, u32 screenY) const
+{
+    // the same as CameraSimpleOrtho, on the z = 0 plane
+    const glm::mat4 vpInverse = glm::inverse(m_ViewProjection);
+
+    const glm::vec2 ndc(
+        screenX / m_ViewportSize.x * 2.0f - 1.0f,
+        (m_ViewportSize.y - screenY) / m_ViewportSize.y * 2.0f - 1.0f);
+
+    const glm::vec2 world = vpInverse * glm::vec4(ndc, 0.0f, 1.0f);
+
+    return world;
+}
+
+glm::vec2 CameraSnapshot::WorldToScreen(glm::vec2 world) const
+{
+    const glm::vec2 ndc = m_ViewProjection * glm::vec4(world, 0.0f, 1.0f);
+    const glm::vec2 normalizedScreen = (ndc + glm::vec2(1.0f)) * glm::vec2(0.5f);
+    const glm::vec2 screen(normalizedScreen.x * m_ViewportSize.x, (1.0f - normalizedScreen.y) * m_ViewportSize.y);
+
+    return screen;
+}
+
+cgt::math::AABB CameraSnapshot::GetViewBounds() const
+{
+    return m_ViewBounds;
+}
+
+bool CameraSnapshot::IsOrthographic() const
+{
+    return m_IsOrthographic;
+}
+
+}
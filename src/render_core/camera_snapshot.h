@@ -0,0 +1,42 @@
+#pragma once
+
+#include <render_core/i_camera.h>
+
+namespace cgt::render
+{
+
+// a camera frozen the moment it was captured, for drawing a frame after the camera it came from moved on
+class CameraSnapshot : public ICamera
+{
+public:
+    CameraSnapshot() = default;
+    CameraSnapshot(const ICamera& camera, u32 viewportWidth, u32 viewportHeight);
+
+    glm::mat4 GetView() const override;
+    glm::mat4 GetProjection() const override;
+    glm::mat4 GetViewProjection() const override;
+    glm::vec3 GetPosition() const override;
+    glm::vec3 GetForwardDirection() const override;
+    glm::vec3 GetUpDirection() const override;
+
+    glm::vec2 ScreenToWorld(u32 screenX, u32 screenY) const override;
+    glm::vec2 WorldToScreen(glm::vec2 world) const override;
+
+    cgt::math::AABB GetViewBounds() const override;
+
+    bool IsOrthographic() const override;
+
+private:
+    glm::mat4 m_View = glm::mat4(1.0f);
+    glm::mat4 m_Projection = glm::mat4(1.0f);
+    glm::mat4 m_ViewProjection = glm::mat4(1.0f);
+    glm::vec3 m_Position = glm::vec3(0.0f);
+    glm::vec3 m_ForwardDirection = glm::vec3(0.0f, 0.0f, 1.0f);
+    glm::vec3 m_UpDirection = glm::vec3(0.0f, 1.0f, 0.0f);
+    cgt::math::AABB m_ViewBounds = { glm::vec2(0.0f), glm::vec2(0.0f) };
+    bool m_IsOrthographic = true;
+
+    glm::vec2 m_ViewportSize = glm::vec2(1.0f);
+};
+
+}
@@ -0,0 +1,17 @@
+#include <render_core/pch.h>
+
+#include <render_core/cpu_static_sprite_batch.h>
+
+namespace cgt::render
+{
+
+CpuStaticSpriteBatch::CpuStaticSpriteBatch(const SpriteDrawList& drawList)
+{
+    std::vector<SpriteDrawRequest> sortedSprites;
+    SortAndSplit(drawList, sortedSprites);
+
+    m_Instances.resize(sortedSprites.size());
+    EncodeSpriteInstances(sortedSprites.data(), sortedSprites.size(), m_Instances.data());
+}
+
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <render_core/static_sprite_batch.h>
+#include <render_core/sprite_instance_encoder.h>
+
+namespace cgt::render
+{
+
+// static batch of the backends drawing without a GPU, the encoded instances stand in for the immutable buffer of the DX11 backend
+class CpuStaticSpriteBatch : public StaticSpriteBatch
+{
+public:
+    explicit CpuStaticSpriteBatch(const SpriteDrawList& drawList);
+
+    const std::vector<SpriteInstanceData>& GetInstances() const { return m_Instances; }
+
+private:
+    std::vector<SpriteInstanceData> m_Instances;
+};
+
+}
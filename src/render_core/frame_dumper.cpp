@@ -0,0 +1,313 @@
+#include <render_core/pch.h>
+
+#include <array>
+
+#include <render_core/frame_dumper.h>
+#include <render_core/i_render_context.h>
+
+namespace cgt::render
+{
+
+namespace
+{
+
+float CountsToMs(u64 counts)
+{
+    return (float)(counts * 1000.0 / (double)SDL_GetPerformanceFrequency());
+}
+
+u32 Crc32(u32 crc, const u8* data, usize size)
+{
+    static const auto TABLE = []()
+    {
+        std::array<u32, 256> table {};
+        for (u32 i = 0; i < 256; ++i)
+        {
+            u32 value = i;
+            for (u32 bit = 0; bit < 8; ++bit)
+            {
+                value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+            }
+            table[i] = value;
+        }
+        return table;
+    }();
+
+    crc = ~crc;
+    for (usize i = 0; i < size; ++i)
+    {
+        crc = TABLE[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+void AppendU32BigEndian(std::vector<u8>& bytes, u32 value)
+{
+    bytes.push_back((u8)(value >> 24));
+    bytes.push_back((u8)(value >> 16));
+    bytes.push_back((u8)(value >> 8));
+    bytes.push_back((u8)value);
+}
+
+void WritePNGChunk(std::ofstream& stream, const char type[4], const std::vector<u8>& data)
+{
+    std::vector<u8> header;
+    AppendU32BigEndian(header, (u32)data.size());
+    header.insert(header.end(), type, type + 4);
+
+    u32 crc = Crc32(0, header.data() + 4, 4);
+    crc = Crc32(crc, data.data(), data.size());
+
+    std::vector<u8> footer;
+    AppendU32BigEndian(footer, crc);
+
+    stream.write((const char*)header.data(), header.size());
+    stream.write((const char*)data.data(), data.size());
+    stream.write((const char*)footer.data(), footer.size());
+}
+
+}
+
+FrameDumper::FrameDumper(FrameDumpConfig config)
+    : m_Config(std::move(config))
+{
+    std::filesystem::create_directories(m_Config.directory);
+
+    m_Timings.open(m_Config.directory / "timings.csv");
+    CGT_ASSERT_ALWAYS_MSG(m_Timings.is_open(), "Failed to open the frame timings for writing: {}", m_Config.directory.string());
+    m_Timings << "frame,frame_ms,render_ms\n";
+
+    m_Worker = std::thread([this]() { WorkerLoop(); });
+}
+
+FrameDumper::~FrameDumper()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Quit = true;
+    }
+    m_QueueChanged.notify_all();
+
+    m_Worker.join();
+}
+
+void FrameDumper::BeginFrame()
+{
+    if (!m_FrameBegan)
+    {
+        m_FrameBegan = true;
+        m_FrameStart = SDL_GetPerformanceCounter();
+    }
+}
+
+void FrameDumper::EndFrame(IRenderContext& render)
+{
+    ZoneScoped;
+
+    BeginFrame();
+    const u64 frameEnd = SDL_GetPerformanceCounter();
+
+    QueuedFrame frame;
+    frame.index = m_FrameIndex++;
+    frame.renderMs = CountsToMs(frameEnd - m_FrameStart);
+    frame.frameMs = m_LastFrameEnd > 0 ? CountsToMs(frameEnd - m_LastFrameEnd) : 0.0f;
+    m_FrameBegan = false;
+    m_LastFrameEnd = frameEnd;
+
+    const bool isImageFrame = m_Config.imageInterval > 0 && frame.index % m_Config.imageInterval == 0;
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_QueueChanged.wait(lock, [this]() { return m_Queue.size() < MAX_QUEUED_FRAMES; });
+
+    if (isImageFrame)
+    {
+        if (!m_FreeBuffers.empty())
+        {
+            frame.image.pixels = std::move(m_FreeBuffers.back());
+            m_FreeBuffers.pop_back();
+        }
+
+        // the worker only touches queued frames, reading back doesn't need the lock
+        lock.unlock();
+        if (!render.ReadFrame(frame.image))
+        {
+            frame.image = Image();
+        }
+        lock.lock();
+    }
+
+    m_Queue.emplace_back(std::move(frame));
+    m_QueueChanged.notify_all();
+}
+
+void FrameDumper::Flush()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_QueueChanged.wait(lock, [this]() { return m_Queue.empty() && !m_WorkerBusy; });
+    m_Timings.flush();
+}
+
+void FrameDumper::WorkerLoop()
+{
+    tracy::SetThreadName("Frame Dumper");
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    while (true)
+    {
+        m_QueueChanged.wait(lock, [this]() { return !m_Queue.empty() || m_Quit; });
+        if (m_Queue.empty())
+        {
+            break;
+        }
+
+        QueuedFrame frame = std::move(m_Queue.front());
+        m_Queue.pop_front();
+        m_WorkerBusy = true;
+        m_QueueChanged.notify_all();
+        lock.unlock();
+
+        {
+            ZoneScopedN("Write Frame");
+
+            m_Timings << frame.index << ',' << frame.frameMs << ',' << frame.renderMs << '\n';
+
+            if (!frame.image.pixels.empty())
+            {
+                const bool isPNG = m_Config.format == FrameDumpFormat::PNG;
+                const std::filesystem::path path = m_Config.directory / fmt::format("frame_{:06}.{}", frame.index, isPNG ? "png" : "ppm");
+                const bool written = isPNG ? WritePNG(path, frame.image) : WritePPM(path, frame.image);
+                CGT_ASSERT_ALWAYS_MSG(written, "Failed to write the frame to {}", path.string());
+            }
+        }
+
+        lock.lock();
+        if (frame.image.pixels.capacity() > 0)
+        {
+            m_FreeBuffers.emplace_back(std::move(frame.image.pixels));
+        }
+        m_WorkerBusy = false;
+        m_QueueChanged.notify_all();
+    }
+}
+
+bool FrameDumper::WritePNG(const std::filesystem::path& path, const Image& image)
+{
+    std::ofstream stream(path, std::ios::binary);
+    if (!stream.is_open())
+    {
+        return false;
+    }
+
+    const u8 SIGNATURE[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    stream.write((const char*)SIGNATURE, sizeof(SIGNATURE));
+
+    std::vector<u8> header;
+    AppendU32BigEndian(header, image.width);
+    AppendU32BigEndian(header, image.height);
+    header.push_back(8); // bits per channel
+    header.push_back(6); // RGBA
+    header.push_back(0); // deflate
+    header.push_back(0); // adaptive filtering
+    header.push_back(0); // no interlacing
+    WritePNGChunk(stream, "IHDR", header);
+
+    // rows with the filter type "none" in front, stored in uncompressed deflate blocks:
+    // the dumps are meant to be compared and thrown away, so encoding speed wins over size
+    const usize rowSize = (usize)image.width * sizeof(u32);
+    const usize rawSize = (rowSize + 1) * image.height;
+    const usize MAX_BLOCK_SIZE = 65535;
+    const usize blockCount = glm::max((rawSize + MAX_BLOCK_SIZE - 1) / MAX_BLOCK_SIZE, (usize)1);
+
+    std::vector<u8> data;
+    data.reserve(2 + rawSize + blockCount * 5 + 4);
+    data.push_back(0x78); // zlib header: deflate with a 32K window, no preset dictionary, check bits
+    data.push_back(0x01);
+
+    u32 adlerA = 1;
+    u32 adlerB = 0;
+    usize blockRemaining = 0;
+    usize rawRemaining = rawSize;
+    auto appendRaw = [&](const u8* bytes, usize size)
+    {
+        while (size > 0)
+        {
+            if (blockRemaining == 0)
+            {
+                blockRemaining = glm::min(rawRemaining, MAX_BLOCK_SIZE);
+                rawRemaining -= blockRemaining;
+                data.push_back(rawRemaining == 0 ? 1 : 0);
+                data.push_back((u8)blockRemaining);
+                data.push_back((u8)(blockRemaining >> 8));
+                data.push_back((u8)~blockRemaining);
+                data.push_back((u8)(~blockRemaining >> 8));
+            }
+
+            const usize count = glm::min(size, blockRemaining);
+            data.insert(data.end(), bytes, bytes + count);
+            for (usize i = 0; i < count; ++i)
+            {
+                adlerA += bytes[i];
+                adlerB += adlerA;
+                // the sums fit into u32 for up to 5552 bytes between the modulos
+                if ((i & 4095) == 4095)
+                {
+                    adlerA %= 65521;
+                    adlerB %= 65521;
+                }
+            }
+            adlerA %= 65521;
+            adlerB %= 65521;
+
+            bytes += count;
+            size -= count;
+            blockRemaining -= count;
+        }
+    };
+
+    const u8 FILTER_NONE = 0;
+    for (u32 y = 0; y < image.height; ++y)
+    {
+        appendRaw(&FILTER_NONE, 1);
+        appendRaw((const u8*)(image.pixels.data() + (usize)y * image.width), rowSize);
+    }
+    if (rawSize == 0)
+    {
+        // an empty final block still has to be there
+        data.insert(data.end(), { 1, 0, 0, 0xFF, 0xFF });
+    }
+    AppendU32BigEndian(data, (adlerB << 16) | adlerA);
+    WritePNGChunk(stream, "IDAT", data);
+
+    WritePNGChunk(stream, "IEND", {});
+
+    return stream.good();
+}
+
+bool FrameDumper::WritePPM(const std::filesystem::path& path, const Image& image)
+{
+    std::ofstream stream(path, std::ios::binary);
+    if (!stream.is_open())
+    {
+        return false;
+    }
+
+    // binary RGB, alpha gets dropped
+    stream << "P6\n" << image.width << ' ' << image.height << "\n255\n";
+
+    std::vector<u8> row((usize)image.width * 3);
+    for (u32 y = 0; y < image.height; ++y)
+    {
+        const u32* pixels = image.pixels.data() + (usize)y * image.width;
+        for (u32 x = 0; x < image.width; ++x)
+        {
+            row[x * 3 + 0] = (u8)pixels[x];
+            row[x * 3 + 1] = (u8)(pixels[x] >> 8);
+            row[x * 3 + 2] = (u8)(pixels[x] >> 16);
+        }
+        stream.write((const char*)row.data(), row.size());
+    }
+
+    return stream.good();
+}
+
+}
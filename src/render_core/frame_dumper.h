@@ -0,0 +1,88 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include <render_core/image.h>
+
+namespace cgt::render
+{
+
+class IRenderContext;
+
+enum class FrameDumpFormat
+{
+    PNG,
+    PPM,
+};
+
+struct FrameDumpConfig
+{
+    std::filesystem::path directory;
+    FrameDumpFormat format = FrameDumpFormat::PNG;
+
+    // every n-th frame is written as an image, 0 only records the timings
+    u32 imageInterval = 1;
+};
+
+/*
+ * Writes presented frames and the render timings of every frame to a directory, on a thread of its own,
+ * so encoding doesn't stall the frame. Images go to frame_<index>.png or .ppm, timings to timings.csv.
+ * Frames are never dropped: EndFrame blocks once MAX_QUEUED_FRAMES are waiting to be written.
+ * Owned by the render context, which calls BeginFrame on the first Clear and EndFrame on Present.
+ */
+class FrameDumper : private NonCopyable
+{
+public:
+    static constexpr usize MAX_QUEUED_FRAMES = 4;
+
+    explicit FrameDumper(FrameDumpConfig config);
+    // writes out whatever is still queued
+    ~FrameDumper();
+
+    // does nothing if the frame already began
+    void BeginFrame();
+    // reads the frame back from the render context if it's an image frame, backends that can't read back only get timings
+    void EndFrame(IRenderContext& render);
+
+    // blocks until everything queued so far is written
+    void Flush();
+
+    static bool WritePNG(const std::filesystem::path& path, const Image& image);
+    static bool WritePPM(const std::filesystem::path& path, const Image& image);
+
+private:
+    struct QueuedFrame
+    {
+        u64 index = 0;
+        float frameMs = 0.0f;
+        float renderMs = 0.0f;
+        // empty for frames without an image
+        Image image;
+    };
+
+    void WorkerLoop();
+
+    FrameDumpConfig m_Config;
+    std::ofstream m_Timings;
+
+    u64 m_FrameIndex = 0;
+    bool m_FrameBegan = false;
+    u64 m_FrameStart = 0;
+    u64 m_LastFrameEnd = 0;
+
+    std::mutex m_Mutex;
+    std::condition_variable m_QueueChanged;
+    std::deque<QueuedFrame> m_Queue;
+    // the frame the worker is writing right now isn't in the queue anymore
+    bool m_WorkerBusy = false;
+    bool m_Quit = false;
+    // pixel buffers of written frames, reused so image frames don't allocate
+    std::vector<std::vector<u32>> m_FreeBuffers;
+
+    std::thread m_Worker;
+};
+
+}
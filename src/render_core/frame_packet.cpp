@@ -0,0 +1,79 @@
+#include <render_core/pch.h>
+
+#include <render_core/frame_packet.h>
+
+namespace cgt::render
+{
+
+void UiPacket::Capture(const ImDrawData& drawData, const Im3d::DrawList* im3dDrawLists, u32 im3dDrawListCount)
+{
+    ZoneScoped;
+
+    // only the output of the lists is needed, the buffers keep their capacity when they're assigned to
+    while (m_DrawLists.size() < (usize)drawData.CmdListsCount)
+    {
+        m_DrawLists.push_back(std::make_unique<ImDrawList>(nullptr));
+    }
+
+    m_DrawListPointers.clear();
+    for (i32 listIdx = 0; listIdx < drawData.CmdListsCount; ++listIdx)
+    {
+        const ImDrawList& source = *drawData.CmdLists[listIdx];
+        ImDrawList& copy = *m_DrawLists[listIdx];
+        copy.CmdBuffer = source.CmdBuffer;
+        copy.IdxBuffer = source.IdxBuffer;
+        copy.VtxBuffer = source.VtxBuffer;
+        copy.Flags = source.Flags;
+        m_DrawListPointers.push_back(&copy);
+    }
+
+    m_DrawData = drawData;
+    m_DrawData.CmdLists = m_DrawListPointers.data();
+
+    m_Im3dVertices.clear();
+    for (u32 listIdx = 0; listIdx < im3dDrawListCount; ++listIdx)
+    {
+        const Im3d::DrawList& source = im3dDrawLists[listIdx];
+        m_Im3dVertices.insert(m_Im3dVertices.end(), source.m_vertexData, source.m_vertexData + source.m_vertexCount);
+    }
+
+    // pointers go in once the vertices are done growing
+    m_Im3dDrawLists.assign(im3dDrawLists, im3dDrawLists + im3dDrawListCount);
+    usize vertexIdx = 0;
+    for (Im3d::DrawList& drawList : m_Im3dDrawLists)
+    {
+        drawList.m_vertexData = m_Im3dVertices.data() + vertexIdx;
+        vertexIdx += drawList.m_vertexCount;
+    }
+}
+
+void FramePacket::CaptureSprites(const SpriteFrame& frame)
+{
+    ZoneScoped;
+
+    sprites.clear();
+
+    const std::vector<SpriteDrawList*>& drawLists = frame.GetDrawLists();
+    while (m_DrawListCopies.size() < drawLists.size())
+    {
+        m_DrawListCopies.push_back(std::make_unique<SpriteDrawList>());
+    }
+
+    for (usize listIdx = 0; listIdx < drawLists.size(); ++listIdx)
+    {
+        SpriteDrawList& source = *drawLists[listIdx];
+        source.MergeSegments();
+
+        SpriteDrawList& copy = *m_DrawListCopies[listIdx];
+        copy.clear();
+        copy.AddSprites(source.data(), (u32)source.size());
+        sprites.AddDrawList(copy);
+    }
+
+    for (const StaticSpriteBatch* batch : frame.GetStaticBatches())
+    {
+        sprites.AddStaticBatch(*batch);
+    }
+}
+
+}
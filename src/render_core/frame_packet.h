@@ -0,0 +1,60 @@
+#pragma once
+
+#include <render_core/i_render_context.h>
+#include <render_core/sprite_frame.h>
+#include <render_core/camera_snapshot.h>
+
+namespace cgt::render
+{
+
+/*
+ * What ImGui and Im3d drew in a frame, copied out so both of them can go on with the next frame
+ * while this one is drawn. The copies are reused, so they only get reallocated when a frame draws more than before.
+ */
+class UiPacket : private NonCopyable
+{
+public:
+    // the ImGui frame has to be rendered and the Im3d one ended
+    void Capture(const ImDrawData& drawData, const Im3d::DrawList* im3dDrawLists, u32 im3dDrawListCount);
+
+    // not const, the ImGui bindings take draw data that isn't
+    ImDrawData* GetImDrawData() { return &m_DrawData; }
+    const Im3d::DrawList* GetIm3dDrawLists() const { return m_Im3dDrawLists.data(); }
+    u32 GetIm3dDrawListCount() const { return (u32)m_Im3dDrawLists.size(); }
+
+private:
+    ImDrawData m_DrawData {};
+    std::vector<std::unique_ptr<ImDrawList>> m_DrawLists;
+    std::vector<ImDrawList*> m_DrawListPointers;
+
+    // the lists point into the vertices
+    std::vector<Im3d::DrawList> m_Im3dDrawLists;
+    std::vector<Im3d::VertexData> m_Im3dVertices;
+};
+
+/*
+ * Everything the render thread needs to draw a frame. The game thread fills it in and hands it over,
+ * after that nobody changes it until the render thread is done, so the game can go on with the next frame.
+ * Draw lists are copied, static batches are only pointed to and have to outlive the packets drawing them.
+ */
+class FramePacket : private NonCopyable
+{
+public:
+    // copies the sprites of the lists of the frame, merging their segments first
+    void CaptureSprites(const SpriteFrame& frame);
+
+    glm::vec4 clearColor = glm::vec4(0.0f);
+    CameraSnapshot camera;
+    // points into the copies of the draw lists
+    SpriteFrame sprites;
+    UiPacket ui;
+
+    // whatever the game thread worked out on its own, like the draw calls saved by atlases, added to the stats of the submission
+    RenderStats gameStats;
+
+private:
+    // kept between frames, so the copies don't get reallocated every time
+    std::vector<std::unique_ptr<SpriteDrawList>> m_DrawListCopies;
+};
+
+}
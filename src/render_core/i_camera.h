@@ -1,6 +1,7 @@
 #pragma once
 
 #include <glm/mat4x4.hpp>
+#include <engine/math.h>
 
 namespace cgt::render
 {
@@ -18,6 +19,9 @@ public:
     virtual glm::vec2 ScreenToWorld(u32 screenX, u32 screenY) const = 0;
     virtual glm::vec2 WorldToScreen(glm::vec2 world) const = 0;
 
+    // world space rectangle that ends up on the screen, on the z = 0 plane
+    virtual cgt::math::AABB GetViewBounds() const = 0;
+
     virtual bool IsOrthographic() const = 0;
 };
 
@@ -1,25 +1,104 @@
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <render_core/render_config.h>
 #include <render_core/sprite_draw_list.h>
+#include <render_core/static_sprite_batch.h>
 #include <render_core/i_camera.h>
+#include <render_core/frame_dumper.h>
+#include <render_core/image.h>
+
+namespace cgt
+{
+class ImGuiHelper;
+}
 
 namespace cgt::render
 {
 
+class SpriteFrame;
+
+// what ended a batch of sprites before the end of the sprites being drawn
+enum class BatchCut
+{
+    None,
+    TextureChange,
+    MaxBatchSize,
+};
+
 struct RenderStats
 {
-    void Reset() { spriteCount = 0; drawcallCount = 0; }
+    // bucket i counts batches of [2^i, 2^(i + 1)) sprites, the last one is for full batches of 1024
+    static constexpr u32 BATCH_SIZE_BUCKET_COUNT = 11;
+
+    void Reset() { *this = RenderStats(); }
+
+    void AddBatch(usize spriteCount, BatchCut cut)
+    {
+        u32 bucket = 0;
+        while (bucket + 1 < BATCH_SIZE_BUCKET_COUNT && spriteCount >= (2ull << bucket))
+        {
+            ++bucket;
+        }
+        ++batchSizeHistogram[bucket];
+
+        batchesCutByTexture += cut == BatchCut::TextureChange ? 1 : 0;
+        batchesCutBySize += cut == BatchCut::MaxBatchSize ? 1 : 0;
+    }
 
     void operator+=(const RenderStats& other)
     {
         spriteCount += other.spriteCount;
+        culledSpriteCount += other.culledSpriteCount;
+        staticSpriteCount += other.staticSpriteCount;
         drawcallCount += other.drawcallCount;
+        atlasDrawcallsSaved += other.atlasDrawcallsSaved;
+        mergedDrawcallsSaved += other.mergedDrawcallsSaved;
+        submitTime += other.submitTime;
+        sortTime += other.sortTime;
+        cullTime += other.cullTime;
+        encodeTime += other.encodeTime;
+        uploadTime += other.uploadTime;
+        drawTime += other.drawTime;
+        uploadedBytes += other.uploadedBytes;
+        batchesCutByTexture += other.batchesCutByTexture;
+        batchesCutBySize += other.batchesCutBySize;
+        for (u32 bucket = 0; bucket < BATCH_SIZE_BUCKET_COUNT; ++bucket)
+        {
+            batchSizeHistogram[bucket] += other.batchSizeHistogram[bucket];
+        }
     }
 
+    // everything that was submitted, culled sprites included
     u32 spriteCount = 0;
+    // dropped by view culling before they were encoded
+    u32 culledSpriteCount = 0;
+    // drawn from static batches, so encoded and uploaded only when the batch was created
+    u32 staticSpriteCount = 0;
     u32 drawcallCount = 0;
+    // filled in by whoever submits atlas sprites, backends don't know about atlases
+    u32 atlasDrawcallsSaved = 0;
+    // by sorting the draw lists of a frame together instead of submitting them one by one. Negative when it cost drawcalls:
+    // ordering by layer across the lists can split texture runs that stayed together within a list
+    i32 mergedDrawcallsSaved = 0;
+    // seconds spent on the CPU in the submissions
+    float submitTime = 0.0f;
+
+    // parts of the submit time, in seconds: sorting and merging the sprites, view culling, encoding instances,
+    // mapping and unmapping the instance buffers and issuing the draw calls along with their state changes
+    float sortTime = 0.0f;
+    float cullTime = 0.0f;
+    float encodeTime = 0.0f;
+    float uploadTime = 0.0f;
+    float drawTime = 0.0f;
+    // instance data and batch constants written for the GPU, static batches upload theirs only once
+    u64 uploadedBytes = 0;
+
+    // batches encoded during the submissions, the ones ending along with their sprites are counted in neither
+    u32 batchesCutByTexture = 0;
+    u32 batchesCutBySize = 0;
+    u32 batchSizeHistogram[BATCH_SIZE_BUCKET_COUNT] = {};
 };
 
 class IRenderContext
@@ -28,18 +107,38 @@ public:
     // meant to be implemented by concrete rendering libraries
     static std::shared_ptr<IRenderContext> BuildWithConfig(RenderConfig config);
 
-    virtual TextureHandle LoadTexture(const std::filesystem::path& absolutePath) = 0;
-    virtual ImTextureID GetImTextureID(const TextureHandle& texture) = 0;
-    virtual usize GetTextureSortKey(const TextureHandle& texture) = 0;
+    virtual TextureOwner LoadTexture(const std::filesystem::path& absolutePath) = 0;
+    virtual TextureOwner CreateTexture(const Image& image) = 0;
+    virtual ImTextureID GetImTextureID(TextureHandle texture) = 0;
+    // the uv rects sprites of the texture refer to by SpriteSource::uvRect, at most SpriteSource::MAX_UV_RECTS of them.
+    // Uploaded once and replacing the previous ones, so it can't happen while a RenderThread draws with the context either
+    virtual void SetTextureUVRects(TextureHandle texture, const std::vector<math::AABB>& uvRects) = 0;
 
     virtual void Clear(glm::vec4 clearColor) = 0;
+    // sprites the camera can't see are culled first unless the config turned it off, the visible ones are copied out
+    // for that, so the list only gets sorted in place when culling is off
     virtual RenderStats Submit(SpriteDrawList& drawList, const ICamera& camera, bool sortBeforeRendering = true) = 0;
+
+    // sorts and encodes the sprites once and keeps them resident, the batch has to be destroyed before the render context
+    virtual std::unique_ptr<StaticSpriteBatch> CreateStaticBatch(const SpriteDrawList& drawList) = 0;
+    // draws the ranges of the batch the camera can see, nothing gets encoded or uploaded
+    virtual RenderStats SubmitStaticBatch(const StaticSpriteBatch& batch, const ICamera& camera) = 0;
+    // draws all of the lists and static batches of the frame with a single sort and pipeline setup, ordered by layer across them
+    virtual RenderStats SubmitFrame(const SpriteFrame& frame, const ICamera& camera) = 0;
+
     virtual void Present() = 0;
 
+    // copies the frame rendered so far, false if the backend can't read its target back in the current configuration
+    virtual bool ReadFrame(Image& outImage) = 0;
+
     virtual ~IRenderContext() = default;
 
 protected:
-    friend class ImGuiHelper;
+    friend class cgt::ImGuiHelper;
+    friend class Texture;
+    friend class RenderThread;
+
+    virtual void ReleaseTexture(TextureHandle texture) = 0;
 
     virtual void ImGuiBindingsInit() = 0;
     virtual void ImGuiBindingsNewFrame() = 0;
@@ -48,8 +147,12 @@ protected:
 
     virtual void Im3dBindingsInit() = 0;
     virtual void Im3dBindingsNewFrame() = 0;
-    virtual void Im3dBindingsRender(const ICamera& camera) = 0;
+    // the lists are the ones of the frame Im3d just ended, or copies of them when the frame is drawn on the render thread
+    virtual void Im3dBindingsRender(const ICamera& camera, const Im3d::DrawList* drawLists, u32 drawListCount) = 0;
     virtual void Im3dBindingsShutdown() = 0;
+
+    // set while a RenderThread draws with the context, texture pools aren't synchronized so textures can't come and go meanwhile
+    std::atomic<bool> m_HasRenderThread = false;
 };
 
 }
@@ -0,0 +1,44 @@
+#include <render_core/pch.h>
+
+#include <render_core/image.h>
+#include <engine/assets.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_PNG
+#define STBI_ONLY_BMP
+#define STBI_ONLY_TGA
+#include <engine/extern/tracy/profiler/src/stb_image.h>
+
+namespace cgt::render
+{
+
+bool DecodeImage(const u8* data, usize size, Image& outImage)
+{
+    ZoneScoped;
+
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    stbi_uc* pixels = stbi_load_from_memory(data, (int)size, &width, &height, &channels, 4);
+    if (!pixels)
+    {
+        return false;
+    }
+
+    // stb_image writes RGBA bytes, which is what the pixels are on little endian machines
+    outImage.width = (u32)width;
+    outImage.height = (u32)height;
+    outImage.pixels.resize((usize)width * height);
+    std::memcpy(outImage.pixels.data(), pixels, outImage.pixels.size() * sizeof(u32));
+    stbi_image_free(pixels);
+
+    return true;
+}
+
+bool LoadImageFile(const std::filesystem::path& absolutePath, Image& outImage)
+{
+    auto fileData = LoadFileBytes(absolutePath);
+    return !fileData.empty() && DecodeImage(fileData.data(), fileData.size(), outImage);
+}
+
+}
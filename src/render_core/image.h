@@ -0,0 +1,18 @@
+#pragma once
+
+namespace cgt::render
+{
+
+// RGBA8 rows without any padding, red in the lowest byte
+struct Image
+{
+    u32 width = 0;
+    u32 height = 0;
+    std::vector<u32> pixels;
+};
+
+// PNG, BMP or TGA, false if the data couldn't be decoded
+bool DecodeImage(const u8* data, usize size, Image& outImage);
+bool LoadImageFile(const std::filesystem::path& absolutePath, Image& outImage);
+
+}
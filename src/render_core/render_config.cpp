@@ -11,11 +11,45 @@ RenderConfig RenderConfig::Default(std::shared_ptr<Window> window)
     return RenderConfig(window);
 }
 
+RenderConfig RenderConfig::Offscreen(u32 width, u32 height)
+{
+    auto window = WindowConfig::Default()
+        .WithDimensions(width, height)
+        .WithHeadless(true)
+        .Build();
+
+    return RenderConfig(window).WithOffscreen(true);
+}
+
 RenderConfig::RenderConfig(std::shared_ptr<Window> window)
     : m_Window(std::move(window))
 {
 }
 
+RenderConfig RenderConfig::WithOffscreen(bool offscreen)
+{
+    m_Offscreen = offscreen;
+    return *this;
+}
+
+RenderConfig RenderConfig::WithFrameDumps(FrameDumpConfig frameDumps)
+{
+    m_FrameDumps = std::move(frameDumps);
+    return *this;
+}
+
+RenderConfig RenderConfig::WithCompactSpriteInstances(bool compactSpriteInstances)
+{
+    m_CompactSpriteInstances = compactSpriteInstances;
+    return *this;
+}
+
+RenderConfig RenderConfig::WithSpriteCulling(bool spriteCulling)
+{
+    m_SpriteCulling = spriteCulling;
+    return *this;
+}
+
 std::shared_ptr<IRenderContext> RenderConfig::Build()
 {
     return IRenderContext::BuildWithConfig(*this);
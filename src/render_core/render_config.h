@@ -1,6 +1,9 @@
 #pragma once
 
+#include <optional>
+
 #include <engine/window.h>
+#include <render_core/frame_dumper.h>
 
 namespace cgt::render
 {
@@ -11,14 +14,34 @@ class RenderConfig
 {
 public:
     static RenderConfig Default(std::shared_ptr<Window> window);
+    // renders into a CPU readable target of the given size, behind a headless window
+    static RenderConfig Offscreen(u32 width, u32 height);
     explicit RenderConfig(std::shared_ptr<Window> window);
 
+    // Present keeps the frame in a CPU readable target instead of showing it in the window
+    RenderConfig WithOffscreen(bool offscreen);
+    // presented frames get dumped to a directory asynchronously, offscreen or not as long as the backend can read them back
+    RenderConfig WithFrameDumps(FrameDumpConfig frameDumps);
+    // batches whose sprites fit the ranges of the quantized instance format get uploaded in it, on by default.
+    // Sprites need uv rects from the table of their texture for it, the ones from atlases and tilesets come with them
+    RenderConfig WithCompactSpriteInstances(bool compactSpriteInstances);
+    // sprites outside of the camera view are dropped before they're sorted and encoded, on by default
+    RenderConfig WithSpriteCulling(bool spriteCulling);
+
     std::shared_ptr<IRenderContext> Build();
 
     std::shared_ptr<Window> GetSDLWindow() { return m_Window; }
+    bool IsOffscreen() const { return m_Offscreen; }
+    const std::optional<FrameDumpConfig>& GetFrameDumps() const { return m_FrameDumps; }
+    bool UseCompactSpriteInstances() const { return m_CompactSpriteInstances; }
+    bool UseSpriteCulling() const { return m_SpriteCulling; }
 
 private:
     std::shared_ptr<Window> m_Window;
+    bool m_Offscreen = false;
+    std::optional<FrameDumpConfig> m_FrameDumps;
+    bool m_CompactSpriteInstances = true;
+    bool m_SpriteCulling = true;
 };
 
 }
@@ -0,0 +1,126 @@
+#include <render_core/pch.h>
+
+#include <render_core/render_thread.h>
+#include <engine/imgui_helper.h>
+#include <engine/clock.h>
+
+namespace cgt::render
+{
+
+RenderThread::RenderThread(std::shared_ptr<IRenderContext> render, std::shared_ptr<ImGuiHelper> imguiHelper)
+    : m_Render(std::move(render))
+    , m_ImGuiHelper(std::move(imguiHelper))
+{
+    CGT_ASSERT_ALWAYS_MSG(!m_Render->m_HasRenderThread.exchange(true), "The render context already has a render thread");
+
+    for (FramePacket& packet : m_Packets)
+    {
+        m_FreePackets.push_back(&packet);
+    }
+
+    m_Thread = std::thread([this]() { RenderLoop(); });
+}
+
+RenderThread::~RenderThread()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Quit = true;
+    }
+    m_QueueChanged.notify_all();
+
+    m_Thread.join();
+    m_Render->m_HasRenderThread = false;
+}
+
+FramePacket& RenderThread::BeginFrame()
+{
+    ZoneScoped;
+
+    CGT_ASSERT_MSG(!m_FillingPacket, "The frame before wasn't submitted");
+
+    Clock waitClock;
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_QueueChanged.wait(lock, [this]() { return !m_FreePackets.empty(); });
+
+    m_FillingPacket = m_FreePackets.front();
+    m_FreePackets.pop_front();
+
+    // the render thread was working on the frame the game thread just waited for, everything else overlapped
+    m_Stats.waitTime = waitClock.Tick();
+    m_Stats.overlapTime = glm::max(m_Stats.renderTime - m_Stats.waitTime, 0.0f);
+
+    return *m_FillingPacket;
+}
+
+void RenderThread::SubmitFrame()
+{
+    CGT_ASSERT_MSG(m_FillingPacket, "No frame to submit, BeginFrame wasn't called");
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Queue.push_back(m_FillingPacket);
+        m_FillingPacket = nullptr;
+    }
+    m_QueueChanged.notify_all();
+}
+
+void RenderThread::Flush()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_QueueChanged.wait(lock, [this]() { return m_Queue.empty() && !m_RenderBusy; });
+}
+
+RenderStats RenderThread::GetLastFrameStats()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_LastFrameStats;
+}
+
+RenderThreadStats RenderThread::GetStats()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Stats;
+}
+
+void RenderThread::RenderLoop()
+{
+    tracy::SetThreadName("Render");
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    while (true)
+    {
+        m_QueueChanged.wait(lock, [this]() { return !m_Queue.empty() || m_Quit; });
+        if (m_Queue.empty())
+        {
+            break;
+        }
+
+        FramePacket& packet = *m_Queue.front();
+        m_Queue.pop_front();
+        m_RenderBusy = true;
+        lock.unlock();
+
+        Clock renderClock;
+        RenderStats stats;
+        {
+            ZoneScopedN("Render Frame");
+
+            m_Render->Clear(packet.clearColor);
+            stats = m_Render->SubmitFrame(packet.sprites, packet.camera);
+            stats += packet.gameStats;
+            m_ImGuiHelper->RenderCapturedUi(packet.ui, packet.camera);
+            m_Render->Present();
+        }
+        const float renderTime = renderClock.Tick();
+
+        lock.lock();
+        m_LastFrameStats = stats;
+        m_Stats.renderTime = renderTime;
+        m_FreePackets.push_back(&packet);
+        m_RenderBusy = false;
+        m_QueueChanged.notify_all();
+    }
+}
+
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include <render_core/frame_packet.h>
+
+namespace cgt
+{
+class ImGuiHelper;
+}
+
+namespace cgt::render
+{
+
+struct RenderThreadStats
+{
+    // seconds the render thread spent on the last frame it drew
+    float renderTime = 0.0f;
+    // seconds the game thread waited for a free packet before the frame it's building
+    float waitTime = 0.0f;
+    // the part of the render time hidden behind the work of the game thread: whatever it didn't have to wait for
+    float overlapTime = 0.0f;
+};
+
+/*
+ * Draws frame packets on a thread of its own, so the game thread can build the next frame while the last one is submitted.
+ * The packets are double buffered: the game thread fills one in while the render thread draws the other,
+ * and BeginFrame blocks until the render thread is done with the older one.
+ * Once it's running, clearing, submitting, presenting and drawing the UI all have to go through the packets.
+ * The render thread reads the texture pool of the context without locking it, so textures can't be created, loaded
+ * or released while it exists: load them before the thread starts and destroy their owners after it's gone.
+ */
+class RenderThread : private NonCopyable
+{
+public:
+    static constexpr usize PACKET_COUNT = 2;
+
+    RenderThread(std::shared_ptr<IRenderContext> render, std::shared_ptr<ImGuiHelper> imguiHelper);
+    // draws whatever is still queued
+    ~RenderThread();
+
+    // a packet to fill in, the one from the frame before last once the render thread is done with it
+    FramePacket& BeginFrame();
+    // hands the packet from BeginFrame over to the render thread
+    void SubmitFrame();
+
+    // blocks until every submitted packet is drawn
+    void Flush();
+
+    // stats of the last frame that was drawn, with the game stats of its packet
+    RenderStats GetLastFrameStats();
+    RenderThreadStats GetStats();
+
+private:
+    void RenderLoop();
+
+    std::shared_ptr<IRenderContext> m_Render;
+    std::shared_ptr<ImGuiHelper> m_ImGuiHelper;
+
+    FramePacket m_Packets[PACKET_COUNT];
+    // owned by the game thread between BeginFrame and SubmitFrame
+    FramePacket* m_FillingPacket = nullptr;
+
+    std::mutex m_Mutex;
+    std::condition_variable m_QueueChanged;
+    std::deque<FramePacket*> m_FreePackets;
+    std::deque<FramePacket*> m_Queue;
+    // the packet the render thread is drawing right now isn't in the queue anymore
+    bool m_RenderBusy = false;
+    bool m_Quit = false;
+
+    RenderStats m_LastFrameStats;
+    RenderThreadStats m_Stats;
+
+    std::thread m_Thread;
+};
+
+}
@@ -0,0 +1,252 @@
+#include <render_core/pch.h>
+
+#include <render_core/retained_sprite_store.h>
+
+namespace cgt::render
+{
+
+RetainedSpriteStore::RetainedSpriteStore()
+{
+    // slot 0 is the null handle
+    m_Slots.emplace_back();
+}
+
+RetainedSpriteHandle RetainedSpriteStore::Add(const SpriteDrawRequest& sprite)
+{
+    u32 slotIdx;
+    if (!m_FreeSlots.empty())
+    {
+        slotIdx = m_FreeSlots.back();
+        m_FreeSlots.pop_back();
+    }
+    else
+    {
+        slotIdx = (u32)m_Slots.size();
+        m_Slots.emplace_back();
+    }
+
+    m_Slots[slotIdx].isUsed = true;
+    Place(slotIdx, sprite);
+
+    return { slotIdx, m_Slots[slotIdx].generation };
+}
+
+void RetainedSpriteStore::Remove(RetainedSpriteHandle handle)
+{
+    Slot& slot = GetSlot(handle);
+    MakeHole(slot.listIdx);
+
+    slot.isUsed = false;
+    ++slot.generation;
+    m_FreeSlots.push_back(handle.index);
+}
+
+void RetainedSpriteStore::Clear()
+{
+    m_FreeSlots.clear();
+    for (u32 slotIdx = (u32)m_Slots.size() - 1; slotIdx > 0; --slotIdx)
+    {
+        Slot& slot = m_Slots[slotIdx];
+        if (slot.isUsed)
+        {
+            slot.isUsed = false;
+            ++slot.generation;
+        }
+        m_FreeSlots.push_back(slotIdx);
+    }
+
+    m_DrawList.clear();
+    m_ListSlots.clear();
+    m_ListKeys.clear();
+    m_SortedCount = 0;
+
+    m_Holes.clear();
+    m_HoleCount = 0;
+    m_FirstHoleIdx = NO_HOLES;
+}
+
+bool RetainedSpriteStore::IsValid(RetainedSpriteHandle handle) const
+{
+    if (handle.IsNull() || handle.index >= m_Slots.size())
+    {
+        return false;
+    }
+
+    const Slot& slot = m_Slots[handle.index];
+    return slot.isUsed && slot.generation == handle.generation;
+}
+
+const SpriteDrawRequest& RetainedSpriteStore::GetSprite(RetainedSpriteHandle handle) const
+{
+    return m_DrawList[GetSlot(handle).listIdx];
+}
+
+void RetainedSpriteStore::SetTransform(RetainedSpriteHandle handle, glm::vec2 position, float rotation)
+{
+    SpriteDrawRequest& sprite = m_DrawList.m_Sprites[GetSlot(handle).listIdx];
+    sprite.position = position;
+    sprite.rotation = rotation;
+}
+
+void RetainedSpriteStore::SetSprite(RetainedSpriteHandle handle, const SpriteDrawRequest& sprite)
+{
+    const u32 listIdx = GetSlot(handle).listIdx;
+    if (MakeSpriteSortKey(sprite) == m_ListKeys[listIdx])
+    {
+        m_DrawList.m_Sprites[listIdx] = sprite;
+        return;
+    }
+
+    MakeHole(listIdx);
+    Place(handle.index, sprite);
+}
+
+usize RetainedSpriteStore::Flush()
+{
+    std::vector<SpriteDrawRequest>& sprites = m_DrawList.m_Sprites;
+    const bool hasPending = m_SortedCount != sprites.size();
+    const bool tooManyHoles = m_HoleCount > sprites.size() / MAX_HOLES_DIVISOR;
+    if (!hasPending && !tooManyHoles)
+    {
+        return 0;
+    }
+
+    ZoneScoped;
+
+    // pending sprites removed before the flush leave holes behind too, those are just skipped
+    m_Pending.clear();
+    for (usize listIdx = m_SortedCount; listIdx < sprites.size(); ++listIdx)
+    {
+        if (m_ListSlots[listIdx] != 0)
+        {
+            m_Pending.push_back((u32)listIdx);
+        }
+    }
+    std::stable_sort(m_Pending.begin(), m_Pending.end(), [&](u32 a, u32 b) { return m_ListKeys[a] < m_ListKeys[b]; });
+
+    // everything before the first hole is still in place, pending sprites go in after the ones with equal keys
+    usize mergeStart = glm::min(m_FirstHoleIdx, m_SortedCount);
+    if (!m_Pending.empty())
+    {
+        const auto keysBegin = m_ListKeys.begin();
+        mergeStart = std::upper_bound(keysBegin, keysBegin + mergeStart, m_ListKeys[m_Pending.front()]) - keysBegin;
+    }
+
+    m_MergedSprites.clear();
+    m_MergedSlots.clear();
+    m_MergedKeys.clear();
+    auto append = [&](usize listIdx) {
+        m_MergedSprites.push_back(sprites[listIdx]);
+        m_MergedSlots.push_back(m_ListSlots[listIdx]);
+        m_MergedKeys.push_back(m_ListKeys[listIdx]);
+    };
+
+    usize pendingIdx = 0;
+    for (usize listIdx = mergeStart; listIdx < m_SortedCount; ++listIdx)
+    {
+        if (m_ListSlots[listIdx] == 0)
+        {
+            continue;
+        }
+
+        for (; pendingIdx < m_Pending.size() && m_ListKeys[m_Pending[pendingIdx]] < m_ListKeys[listIdx]; ++pendingIdx)
+        {
+            append(m_Pending[pendingIdx]);
+        }
+        append(listIdx);
+    }
+
+    for (; pendingIdx < m_Pending.size(); ++pendingIdx)
+    {
+        append(m_Pending[pendingIdx]);
+    }
+
+    const usize mergedCount = m_MergedSprites.size();
+    sprites.resize(mergeStart + mergedCount);
+    m_ListSlots.resize(mergeStart + mergedCount);
+    m_ListKeys.resize(mergeStart + mergedCount);
+    std::copy(m_MergedSprites.begin(), m_MergedSprites.end(), sprites.begin() + mergeStart);
+    std::copy(m_MergedSlots.begin(), m_MergedSlots.end(), m_ListSlots.begin() + mergeStart);
+    std::copy(m_MergedKeys.begin(), m_MergedKeys.end(), m_ListKeys.begin() + mergeStart);
+
+    for (usize listIdx = mergeStart; listIdx < sprites.size(); ++listIdx)
+    {
+        m_Slots[m_ListSlots[listIdx]].listIdx = (u32)listIdx;
+    }
+    m_SortedCount = sprites.size();
+
+    // holes before the merge start are still there
+    m_HoleCount = 0;
+    m_FirstHoleIdx = NO_HOLES;
+    for (auto& [key, holes] : m_Holes)
+    {
+        holes.erase(std::remove_if(holes.begin(), holes.end(), [&](u32 listIdx) { return listIdx >= mergeStart; }), holes.end());
+        for (u32 listIdx : holes)
+        {
+            m_FirstHoleIdx = glm::min(m_FirstHoleIdx, (usize)listIdx);
+        }
+        m_HoleCount += holes.size();
+    }
+
+    return mergedCount;
+}
+
+RetainedSpriteStore::Slot& RetainedSpriteStore::GetSlot(RetainedSpriteHandle handle)
+{
+    CGT_ASSERT_MSG(IsValid(handle), "Stale or null retained sprite handle");
+    return m_Slots[handle.index];
+}
+
+const RetainedSpriteStore::Slot& RetainedSpriteStore::GetSlot(RetainedSpriteHandle handle) const
+{
+    CGT_ASSERT_MSG(IsValid(handle), "Stale or null retained sprite handle");
+    return m_Slots[handle.index];
+}
+
+void RetainedSpriteStore::Place(u32 slotIdx, const SpriteDrawRequest& sprite)
+{
+    const u32 key = MakeSpriteSortKey(sprite);
+
+    u32 listIdx;
+    auto holes = m_Holes.find(key);
+    if (holes != m_Holes.end() && !holes->second.empty())
+    {
+        listIdx = holes->second.back();
+        holes->second.pop_back();
+        --m_HoleCount;
+
+        m_DrawList.m_Sprites[listIdx] = sprite;
+        m_ListSlots[listIdx] = slotIdx;
+    }
+    else
+    {
+        listIdx = (u32)m_DrawList.size();
+        m_DrawList.AddSprite() = sprite;
+        m_ListSlots.push_back(slotIdx);
+        m_ListKeys.push_back(key);
+    }
+
+    m_Slots[slotIdx].listIdx = listIdx;
+}
+
+void RetainedSpriteStore::MakeHole(u32 listIdx)
+{
+    m_ListSlots[listIdx] = 0;
+
+    // pending sprites aren't in the sorted part yet, the flush drops them
+    if (listIdx >= m_SortedCount)
+    {
+        return;
+    }
+
+    // keeps the layer and the texture, so the hole doesn't split a batch
+    SpriteDrawRequest& sprite = m_DrawList.m_Sprites[listIdx];
+    sprite.colorTint = glm::vec4(0.0f);
+    sprite.scale = glm::vec2(0.0f);
+
+    m_Holes[m_ListKeys[listIdx]].push_back(listIdx);
+    ++m_HoleCount;
+    m_FirstHoleIdx = glm::min(m_FirstHoleIdx, (usize)listIdx);
+}
+
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <render_core/sprite_draw_list.h>
+
+namespace cgt::render
+{
+
+// weak reference to a sprite of a RetainedSpriteStore, stale handles are told apart by the generation
+struct RetainedSpriteHandle
+{
+    bool IsNull() const { return index == 0; }
+
+    bool operator==(const RetainedSpriteHandle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const RetainedSpriteHandle& other) const { return !(*this == other); }
+
+    // 0 is no sprite
+    u32 index = 0;
+    u32 generation = 0;
+};
+
+/*
+ * Sprites that live across frames, kept in a draw list that stays sorted by layer and then by texture.
+ * Moving and rotating a sprite writes straight into the list. Removed sprites leave hidden holes behind,
+ * which get reused by sprites added later with the same layer and texture, so steady churn never moves anything.
+ * Sprites that found no hole get sorted and merged in on the next flush, along with compacting the holes away,
+ * the list is only rewritten from the first place that changed. Sprites added with equal layer and texture
+ * keep their order, unless they were put into holes.
+ * Submit the list with sortBeforeRendering off, sorting it would lose the order.
+ */
+class RetainedSpriteStore : private NonCopyable
+{
+public:
+    RetainedSpriteStore();
+
+    RetainedSpriteHandle Add(const SpriteDrawRequest& sprite);
+    void Remove(RetainedSpriteHandle handle);
+    // removes all of the sprites, every handle becomes stale
+    void Clear();
+
+    bool IsValid(RetainedSpriteHandle handle) const;
+    const SpriteDrawRequest& GetSprite(RetainedSpriteHandle handle) const;
+
+    // never changes the order
+    void SetTransform(RetainedSpriteHandle handle, glm::vec2 position, float rotation);
+    // the sprite moves to its new place in the order if its layer or texture changed
+    void SetSprite(RetainedSpriteHandle handle, const SpriteDrawRequest& sprite);
+
+    // puts sprites that found no hole in place, has to be called before the list is submitted.
+    // Returns the amount of sprites that had to be rewritten, 0 most of the time
+    usize Flush();
+
+    // only up to date right after a flush, hidden holes included
+    SpriteDrawList& GetDrawList() { return m_DrawList; }
+    usize GetHoleCount() const { return m_HoleCount; }
+
+private:
+    // holes are compacted away once they take up more than this part of the list
+    static constexpr usize MAX_HOLES_DIVISOR = 8;
+    static constexpr usize NO_HOLES = std::numeric_limits<usize>::max();
+
+    struct Slot
+    {
+        u32 listIdx = 0;
+        u32 generation = 0;
+        bool isUsed = false;
+    };
+
+    Slot& GetSlot(RetainedSpriteHandle handle);
+    const Slot& GetSlot(RetainedSpriteHandle handle) const;
+
+    // into a hole when there's one with the same key, appended for the next flush otherwise
+    void Place(u32 slotIdx, const SpriteDrawRequest& sprite);
+    void MakeHole(u32 listIdx);
+
+    std::vector<Slot> m_Slots;
+    std::vector<u32> m_FreeSlots;
+
+    // the list along with the slot of every sprite in it and its sort key, slot 0 marks a hole.
+    // Sprites up to the sorted count are in order, the ones after it wait for the next flush
+    SpriteDrawList m_DrawList;
+    std::vector<u32> m_ListSlots;
+    std::vector<u32> m_ListKeys;
+    usize m_SortedCount = 0;
+
+    // list positions of the holes by their sort keys
+    std::unordered_map<u32, std::vector<u32>> m_Holes;
+    usize m_HoleCount = 0;
+    usize m_FirstHoleIdx = NO_HOLES;
+
+    // kept around between flushes, so they don't get reallocated every frame
+    std::vector<u32> m_Pending;
+    std::vector<SpriteDrawRequest> m_MergedSprites;
+    std::vector<u32> m_MergedSlots;
+    std::vector<u32> m_MergedKeys;
+};
+
+}
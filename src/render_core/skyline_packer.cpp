@@ -0,0 +1,108 @@
+#include <render_core/pch.h>
+
+#include <render_core/skyline_packer.h>
+
+namespace cgt::render
+{
+
+SkylinePacker::SkylinePacker(u32 width, u32 height)
+    : m_Width(width)
+    , m_Height(height)
+{
+    m_Skyline.push_back({ 0, 0, width });
+}
+
+bool SkylinePacker::FindRestingHeight(usize segmentIdx, u32 width, u32 height, u32& outY) const
+{
+    const u32 x = m_Skyline[segmentIdx].x;
+    if (x + width > m_Width)
+    {
+        return false;
+    }
+
+    u32 y = 0;
+    u32 remainingWidth = width;
+    for (usize i = segmentIdx; remainingWidth > 0; ++i)
+    {
+        CGT_ASSERT(i < m_Skyline.size());
+
+        y = glm::max(y, m_Skyline[i].y);
+        if (y + height > m_Height)
+        {
+            return false;
+        }
+
+        remainingWidth -= glm::min(remainingWidth, m_Skyline[i].width);
+    }
+
+    outY = y;
+    return true;
+}
+
+bool SkylinePacker::Pack(u32 width, u32 height, glm::uvec2& outPosition)
+{
+    if (width == 0 || height == 0)
+    {
+        outPosition = glm::uvec2(0);
+        return true;
+    }
+
+    usize bestSegmentIdx = m_Skyline.size();
+    u32 bestY = UINT32_MAX;
+    for (usize i = 0; i < m_Skyline.size(); ++i)
+    {
+        u32 y;
+        if (FindRestingHeight(i, width, height, y) && y < bestY)
+        {
+            bestSegmentIdx = i;
+            bestY = y;
+        }
+    }
+
+    if (bestSegmentIdx == m_Skyline.size())
+    {
+        return false;
+    }
+
+    const u32 x = m_Skyline[bestSegmentIdx].x;
+    outPosition = glm::uvec2(x, bestY);
+    m_UsedSize = glm::max(m_UsedSize, glm::uvec2(x + width, bestY + height));
+
+    // the new segment goes on top, the ones it covers get cut back or removed
+    m_Skyline.insert(m_Skyline.begin() + bestSegmentIdx, { x, bestY + height, width });
+
+    const u32 right = x + width;
+    usize nextIdx = bestSegmentIdx + 1;
+    while (nextIdx < m_Skyline.size() && m_Skyline[nextIdx].x < right)
+    {
+        Segment& segment = m_Skyline[nextIdx];
+        const u32 segmentRight = segment.x + segment.width;
+        if (segmentRight <= right)
+        {
+            m_Skyline.erase(m_Skyline.begin() + nextIdx);
+            continue;
+        }
+
+        segment.width = segmentRight - right;
+        segment.x = right;
+        break;
+    }
+
+    // neighbours at the same height become one segment
+    for (usize i = 0; i + 1 < m_Skyline.size();)
+    {
+        if (m_Skyline[i].y == m_Skyline[i + 1].y)
+        {
+            m_Skyline[i].width += m_Skyline[i + 1].width;
+            m_Skyline.erase(m_Skyline.begin() + i + 1);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    return true;
+}
+
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+namespace cgt::render
+{
+
+/*
+ * Packs rectangles into a fixed size area by keeping track of its skyline: the top edge of everything placed so far,
+ * as a list of horizontal segments. Every rectangle goes where its top ends up lowest, ties go to the left.
+ * Space below overhangs is lost, which doesn't matter much when rectangles are added tallest first.
+ */
+class SkylinePacker
+{
+public:
+    SkylinePacker(u32 width, u32 height);
+
+    // false if the rectangle doesn't fit anywhere anymore
+    bool Pack(u32 width, u32 height, glm::uvec2& outPosition);
+
+    // bounds of everything packed so far
+    glm::uvec2 GetUsedSize() const { return m_UsedSize; }
+
+private:
+    struct Segment
+    {
+        u32 x;
+        u32 y;
+        u32 width;
+    };
+
+    // the lowest y the rectangle can rest at when its left edge is at the segment, false if it sticks out
+    bool FindRestingHeight(usize segmentIdx, u32 width, u32 height, u32& outY) const;
+
+    u32 m_Width;
+    u32 m_Height;
+    glm::uvec2 m_UsedSize = glm::uvec2(0);
+
+    // sorted by x and covering the whole width without gaps
+    std::vector<Segment> m_Skyline;
+};
+
+}
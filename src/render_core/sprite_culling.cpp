@@ -0,0 +1,134 @@
+#include <render_core/pch.h>
+
+#include <render_core/sprite_culling.h>
+#include <engine/clock.h>
+
+namespace cgt::render
+{
+
+namespace
+{
+
+bool IsSpriteVisible(const SpriteDrawRequest& sprite, const math::AABB& viewBounds)
+{
+    return math::AABBOverlap(GetSpriteBounds(sprite), viewBounds);
+}
+
+}
+
+math::AABB ComputeViewBounds(const glm::mat4& viewProjection)
+{
+    // corners of the NDC square, the same way CameraSimpleOrtho::GetViewBounds does it
+    const glm::mat4 vpInverse = glm::inverse(viewProjection);
+    const glm::vec2 a = vpInverse * glm::vec4(-1.0f, -1.0f, 0.0f, 1.0f);
+    const glm::vec2 b = vpInverse * glm::vec4(1.0f, 1.0f, 0.0f, 1.0f);
+
+    return math::AABB::FromPoints(a, b);
+}
+
+math::AABB GetSpriteBounds(const SpriteDrawRequest& sprite)
+{
+    // the quad spans [-0.5, 0.5] scaled, half of its diagonal reaches the furthest corner at any rotation
+    const float radius = glm::sqrt(sprite.scale.x * sprite.scale.x + sprite.scale.y * sprite.scale.y) * 0.5f;
+    return { sprite.position - radius, sprite.position + radius };
+}
+
+u32 CullSprites(const SpriteDrawRequest* sprites, usize count, const math::AABB& viewBounds, SpriteDrawList& outVisible)
+{
+    ZoneScoped;
+
+    usize runStart = 0;
+    usize visibleCount = 0;
+    auto endRun = [&](usize runEnd) {
+        if (runEnd > runStart)
+        {
+            outVisible.AddSprites(sprites + runStart, (u32)(runEnd - runStart));
+            visibleCount += runEnd - runStart;
+        }
+        runStart = runEnd + 1;
+    };
+
+    usize i = 0;
+
+#if CGT_SIMD_SSE2
+    // position and scale are next to each other, four sprites of them transpose into one register per component
+    static_assert(offsetof(SpriteDrawRequest, position) + sizeof(glm::vec2) == offsetof(SpriteDrawRequest, scale));
+
+    const __m128 viewMinX = _mm_set1_ps(viewBounds.min.x);
+    const __m128 viewMinY = _mm_set1_ps(viewBounds.min.y);
+    const __m128 viewMaxX = _mm_set1_ps(viewBounds.max.x);
+    const __m128 viewMaxY = _mm_set1_ps(viewBounds.max.y);
+    const __m128 half = _mm_set1_ps(0.5f);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 positionX = _mm_loadu_ps(&sprites[i].position.x);
+        __m128 positionY = _mm_loadu_ps(&sprites[i + 1].position.x);
+        __m128 scaleX = _mm_loadu_ps(&sprites[i + 2].position.x);
+        __m128 scaleY = _mm_loadu_ps(&sprites[i + 3].position.x);
+        _MM_TRANSPOSE4_PS(positionX, positionY, scaleX, scaleY);
+
+        const __m128 radius = _mm_mul_ps(_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(scaleX, scaleX), _mm_mul_ps(scaleY, scaleY))), half);
+
+        // written so that NaN positions end up invisible
+        const __m128 visible = _mm_and_ps(
+            _mm_and_ps(_mm_cmple_ps(viewMinX, _mm_add_ps(positionX, radius)), _mm_cmple_ps(_mm_sub_ps(positionX, radius), viewMaxX)),
+            _mm_and_ps(_mm_cmple_ps(viewMinY, _mm_add_ps(positionY, radius)), _mm_cmple_ps(_mm_sub_ps(positionY, radius), viewMaxY)));
+
+        const i32 visibleMask = _mm_movemask_ps(visible);
+        if (visibleMask == 0xF)
+        {
+            continue;
+        }
+
+        for (u32 lane = 0; lane < 4; ++lane)
+        {
+            if ((visibleMask & (1 << lane)) == 0)
+            {
+                endRun(i + lane);
+            }
+        }
+    }
+#endif
+
+    for (; i < count; ++i)
+    {
+        if (!IsSpriteVisible(sprites[i], viewBounds))
+        {
+            endRun(i);
+        }
+    }
+
+    endRun(count);
+
+    return (u32)(count - visibleCount);
+}
+
+SpriteDrawList& PrepareSpritesForSubmit(SpriteDrawList& drawList, const glm::mat4& viewProjection, bool cull, bool sort, SpriteDrawList& visibleScratch, RenderStats& outStats)
+{
+    // sprites recorded on other threads join the list here
+    drawList.MergeSegments();
+    outStats.spriteCount += (u32)drawList.size();
+
+    // the visible sprites are copied out, so only the list of the caller is sorted in place when culling is off
+    SpriteDrawList* sprites = &drawList;
+    if (cull)
+    {
+        Clock cullClock;
+        visibleScratch.clear();
+        outStats.culledSpriteCount += CullSprites(drawList.data(), drawList.size(), ComputeViewBounds(viewProjection), visibleScratch);
+        sprites = &visibleScratch;
+        outStats.cullTime += cullClock.Tick();
+    }
+
+    if (sort)
+    {
+        Clock sortClock;
+        sprites->SortForRendering();
+        outStats.sortTime += sortClock.Tick();
+    }
+
+    return *sprites;
+}
+
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <render_core/i_render_context.h>
+
+namespace cgt::render
+{
+
+// world space rectangle the view projection puts on the screen, for orthographic cameras looking down the z axis
+math::AABB ComputeViewBounds(const glm::mat4& viewProjection);
+
+// bounds of the sprite that hold for any rotation of it: the circle around its quad
+math::AABB GetSpriteBounds(const SpriteDrawRequest& sprite);
+
+/*
+ * Appends the sprites whose bounds overlap the view bounds to the list, in the order they come in,
+ * and returns the amount that was dropped. Tests four sprites at a time with SSE2 where it's available,
+ * visible runs of sprites are appended with a single copy.
+ */
+u32 CullSprites(const SpriteDrawRequest* sprites, usize count, const math::AABB& viewBounds, SpriteDrawList& outVisible);
+
+// the start of Submit shared by the backends: merges the segments of the list, culls it into the scratch list unless
+// culling is off and sorts what's left if asked to. Fills in the sprite counts and returns the list to draw from
+SpriteDrawList& PrepareSpritesForSubmit(SpriteDrawList& drawList, const glm::mat4& viewProjection, bool cull, bool sort, SpriteDrawList& visibleScratch, RenderStats& outStats);
+
+}
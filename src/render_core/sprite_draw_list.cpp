@@ -1,21 +1,153 @@
 #include <render_core/pch.h>
 
 #include <render_core/sprite_draw_list.h>
-#include <render_core/i_render_context.h>
 
 namespace cgt::render
 {
 
-void SpriteDrawList::SortForRendering(IRenderContext& render)
+namespace
 {
+
+// LSD radix sort over the upper 32 bits of the keys, one byte per pass. Every pass is stable, so keys with
+// the same upper half stay in the order of their lower half. Passes over a byte that is the same for all keys are skipped
+void RadixSortByUpperHalf(std::vector<u64>& keys, std::vector<u64>& scratch)
+{
+    const u32 count = (u32)keys.size();
+    scratch.resize(count);
+
+    u32 histograms[4][256] {};
+    for (u64 key : keys)
+    {
+        const u32 upper = (u32)(key >> 32);
+        ++histograms[0][upper & 0xFF];
+        ++histograms[1][(upper >> 8) & 0xFF];
+        ++histograms[2][(upper >> 16) & 0xFF];
+        ++histograms[3][upper >> 24];
+    }
+
+    for (u32 pass = 0; pass < 4; ++pass)
+    {
+        const u32 shift = 32 + pass * 8;
+        u32* histogram = histograms[pass];
+        if (histogram[(keys[0] >> shift) & 0xFF] == count)
+        {
+            continue;
+        }
+
+        u32 offset = 0;
+        for (u32 digit = 0; digit < 256; ++digit)
+        {
+            const u32 digitCount = histogram[digit];
+            histogram[digit] = offset;
+            offset += digitCount;
+        }
+
+        for (u64 key : keys)
+        {
+            scratch[histogram[(key >> shift) & 0xFF]++] = key;
+        }
+        keys.swap(scratch);
+    }
+}
+
+}
+
+SpriteDrawRequest& SpriteDrawSegment::AddSprite()
+{
+    const usize chunkIdx = m_Count / CHUNK_SIZE;
+    if (chunkIdx == m_Chunks.size())
+    {
+        m_Chunks.emplace_back(new SpriteDrawRequest[CHUNK_SIZE]);
+    }
+
+    SpriteDrawRequest& sprite = m_Chunks[chunkIdx][m_Count % CHUNK_SIZE];
+    sprite = SpriteDrawRequest();
+    ++m_Count;
+
+    return sprite;
+}
+
+void SpriteDrawList::clear()
+{
+    m_Sprites.clear();
+    for (SpriteDrawSegment& segment : m_Segments)
+    {
+        segment.clear();
+    }
+}
+
+void SpriteDrawList::MergeSegments()
+{
+    usize mergedCount = m_Sprites.size();
+    for (const SpriteDrawSegment& segment : m_Segments)
+    {
+        mergedCount += segment.m_Count;
+    }
+
+    if (mergedCount == m_Sprites.size())
+    {
+        return;
+    }
+
     ZoneScoped;
 
-    std::sort(m_Sprites.begin(), m_Sprites.end(), [&render](const SpriteDrawRequest& a, const SpriteDrawRequest& b)
+    m_Sprites.reserve(mergedCount);
+    for (SpriteDrawSegment& segment : m_Segments)
     {
-        usize aKey = render.GetTextureSortKey(a.src.texture);
-        usize bKey = render.GetTextureSortKey(b.src.texture);
-        return a.layer < b.layer || aKey < bKey;
-    });
+        for (usize chunkStart = 0; chunkStart < segment.m_Count; chunkStart += SpriteDrawSegment::CHUNK_SIZE)
+        {
+            const SpriteDrawRequest* chunk = segment.m_Chunks[chunkStart / SpriteDrawSegment::CHUNK_SIZE].get();
+            const usize count = glm::min(segment.m_Count - chunkStart, (usize)SpriteDrawSegment::CHUNK_SIZE);
+            m_Sprites.insert(m_Sprites.end(), chunk, chunk + count);
+        }
+
+        segment.clear();
+    }
 }
 
-}
\ No newline at end of file
+void SpriteDrawList::SortForRendering()
+{
+    ZoneScoped;
+
+    MergeSegments();
+
+    const u32 count = (u32)m_Sprites.size();
+    if (count < 2)
+    {
+        return;
+    }
+
+    // layer in the top byte, the texture slot below it and the index of the sprite in the lower half
+    m_SortKeys.resize(count);
+    for (u32 i = 0; i < count; ++i)
+    {
+        const SpriteDrawRequest& sprite = m_Sprites[i];
+        m_SortKeys[i] = ((u64)sprite.layer << 56) | ((u64)sprite.src.texture.index << 32) | i;
+    }
+
+    RadixSortByUpperHalf(m_SortKeys, m_SortKeysScratch);
+
+    m_SortedSprites.resize(count);
+    for (u32 i = 0; i < count; ++i)
+    {
+        m_SortedSprites[i] = m_Sprites[(u32)m_SortKeys[i]];
+    }
+
+    m_Sprites.swap(m_SortedSprites);
+}
+
+u32 CountTextureRuns(const SpriteDrawList& sprites, usize begin, usize end)
+{
+    u32 runCount = 0;
+    for (usize spriteIdx = begin; spriteIdx < end; ++spriteIdx)
+    {
+        if (spriteIdx == begin || sprites[spriteIdx].src.texture != sprites[spriteIdx - 1].src.texture)
+        {
+            ++runCount;
+        }
+    }
+
+    return runCount;
+}
+
+}
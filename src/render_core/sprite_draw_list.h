@@ -1,22 +1,22 @@
 #pragma once
 
 #include <engine/math.h>
+#include <render_core/texture.h>
 
 namespace cgt::render
 {
 
-class IRenderContext;
-
-// backend dependent
-class TextureData;
-
-typedef std::shared_ptr<TextureData> TextureHandle;
-
 struct SpriteSource
 {
+    // the size of the uv rect tables textures can have, see IRenderContext::SetTextureUVRects
+    static constexpr u32 MAX_UV_RECTS = 4096;
+    static constexpr u16 NO_UV_RECT = 0xFFFF;
+
     TextureHandle texture;
     cgt::math::AABB uv = { glm::vec2(0.0f), glm::vec2(1.0f) };
     float baseRotation = 0.0f;
+    // the entry of the uv rect table of the texture that equals uv, sprites without one can't use the compact instance format
+    u16 uvRect = NO_UV_RECT;
 };
 
 struct SpriteDrawRequest
@@ -29,23 +29,80 @@ struct SpriteDrawRequest
     u8 layer = 0;
 };
 
+// building draw lists is just copying memory around
+static_assert(std::is_trivially_copyable_v<SpriteDrawRequest>);
+
+/*
+ * Part of a draw list recorded by one thread while others record the rest of it.
+ * Sprites are stored in fixed size chunks, so growing never moves the ones already recorded,
+ * and the chunks are kept for the next frame once the segment is merged into its list.
+ * Aligned to a cache line, so neighbouring segments recorded on different threads don't share one.
+ */
+class alignas(64) SpriteDrawSegment
+{
+public:
+    static constexpr u32 CHUNK_SIZE = 1024;
+
+    SpriteDrawRequest& AddSprite();
+
+    usize size() const { return m_Count; }
+    void clear() { m_Count = 0; }
+
+private:
+    friend class SpriteDrawList;
+
+    std::vector<std::unique_ptr<SpriteDrawRequest[]>> m_Chunks;
+    usize m_Count = 0;
+};
+
 class SpriteDrawList : private NonCopyable
 {
 public:
     typedef std::vector<SpriteDrawRequest> SpriteList;
 
     SpriteDrawRequest& AddSprite() { return m_Sprites.emplace_back(); }
-    void SortForRendering(IRenderContext& render);
+    void AddSprites(const SpriteDrawRequest* sprites, u32 count) { m_Sprites.insert(m_Sprites.end(), sprites, sprites + count); }
+
+    // segments for recording on several threads at once, every thread has to stick to its own one.
+    // Setting the count isn't thread safe, it has to happen before the recording starts
+    void SetSegmentCount(u32 count) { m_Segments.resize(count); }
+    SpriteDrawSegment& GetSegment(u32 idx) { return m_Segments[idx]; }
+
+    // appends the sprites recorded into the segments in the order of the segments and clears them,
+    // called by the render context on submission, so iterating the list before that only sees sprites added directly
+    void MergeSegments();
+
+    // merges the segments and orders the sprites by layer and then by texture, sprites with equal ones keep the order they were added in
+    void SortForRendering();
 
     SpriteList::const_iterator begin() const { return m_Sprites.begin(); }
     SpriteList::const_iterator end() const { return m_Sprites.end(); }
     SpriteList::size_type size() const { return m_Sprites.size(); }
     const SpriteDrawRequest& operator[](SpriteList::size_type idx) const { return m_Sprites[idx]; }
+    const SpriteDrawRequest* data() const { return m_Sprites.data(); }
 
-    void clear() { m_Sprites.clear(); }
+    void clear();
 
 private:
+    // keeps its list sorted by editing it in place
+    friend class RetainedSpriteStore;
+
     std::vector<SpriteDrawRequest> m_Sprites;
+    std::vector<SpriteDrawSegment> m_Segments;
+
+    // kept around between sorts, so they don't get reallocated every frame
+    std::vector<u64> m_SortKeys;
+    std::vector<u64> m_SortKeysScratch;
+    std::vector<SpriteDrawRequest> m_SortedSprites;
 };
 
+// layer in the upper half and the texture slot in the lower one, ordering by it gives the order SortForRendering does
+inline u32 MakeSpriteSortKey(const SpriteDrawRequest& sprite)
+{
+    return ((u32)sprite.layer << 16) | sprite.src.texture.index;
+}
+
+// runs of sprites sharing a texture in [begin, end), the batches they take ignoring the batch size limit
+u32 CountTextureRuns(const SpriteDrawList& sprites, usize begin, usize end);
+
 }
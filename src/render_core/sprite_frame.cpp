@@ -0,0 +1,213 @@
+#include <render_core/pch.h>
+
+#include <render_core/sprite_frame.h>
+#include <render_core/sprite_culling.h>
+#include <engine/clock.h>
+
+namespace cgt::render
+{
+
+namespace
+{
+
+typedef PreparedSpriteFrame::SpriteGroup SpriteGroup;
+
+u16 GetTextureIndex(u32 sortKey)
+{
+    return (u16)(sortKey & 0xFFFF);
+}
+
+// appends the groups of the list, false if the list turns out not to be sorted
+bool SplitIntoGroups(const SpriteDrawList& drawList, u32 listIdx, std::vector<SpriteGroup>& outGroups)
+{
+    const usize firstGroup = outGroups.size();
+    for (u32 spriteIdx = 0; spriteIdx < drawList.size(); ++spriteIdx)
+    {
+        const u32 sortKey = MakeSpriteSortKey(drawList[spriteIdx]);
+        if (outGroups.size() > firstGroup)
+        {
+            SpriteGroup& group = outGroups.back();
+            if (sortKey == group.sortKey)
+            {
+                ++group.spriteCount;
+                continue;
+            }
+            if (sortKey < group.sortKey)
+            {
+                return false;
+            }
+        }
+
+        outGroups.push_back({ sortKey, listIdx, spriteIdx, 1 });
+    }
+
+    return true;
+}
+
+// sorted lists are merged a layer and texture at a time, culling every group straight into its place in the frame
+void MergeSortedLists(const SpriteFrame& frame, const math::AABB* viewBounds, PreparedSpriteFrame& outFrame, RenderStats& outStats)
+{
+    ZoneScoped;
+
+    // stable, so groups with equal keys keep the order of the lists
+    Clock phaseClock;
+    std::vector<SpriteGroup>& groups = outFrame.groups;
+    std::stable_sort(groups.begin(), groups.end(), [](const SpriteGroup& a, const SpriteGroup& b) { return a.sortKey < b.sortKey; });
+    outStats.sortTime += phaseClock.Tick();
+
+    // textures are compared by their indices, live textures never share one
+    const u32 NO_TEXTURE = UINT32_MAX;
+    std::vector<u32>& lastListTextures = outFrame.lastListTextures;
+    lastListTextures.assign(frame.GetDrawLists().size(), NO_TEXTURE);
+    u32 lastTexture = NO_TEXTURE;
+    u32 separateRunCount = 0;
+    u32 mergedRunCount = 0;
+
+    SpriteDrawList& sprites = outFrame.sprites;
+    for (const SpriteGroup& group : groups)
+    {
+        const SpriteDrawRequest* groupSprites = frame.GetDrawLists()[group.listIdx]->data() + group.firstSprite;
+        u32 visibleCount = group.spriteCount;
+        if (viewBounds)
+        {
+            const u32 culledCount = CullSprites(groupSprites, group.spriteCount, *viewBounds, sprites);
+            outStats.culledSpriteCount += culledCount;
+            visibleCount -= culledCount;
+        }
+        else
+        {
+            sprites.AddSprites(groupSprites, group.spriteCount);
+        }
+
+        if (visibleCount == 0)
+        {
+            continue;
+        }
+
+        const u32 texture = GetTextureIndex(group.sortKey);
+        separateRunCount += texture != lastListTextures[group.listIdx] ? 1 : 0;
+        mergedRunCount += texture != lastTexture ? 1 : 0;
+        lastListTextures[group.listIdx] = texture;
+        lastTexture = texture;
+    }
+
+    outStats.mergedDrawcallsSaved += (i32)separateRunCount - (i32)mergedRunCount;
+    outStats.cullTime += phaseClock.Tick();
+}
+
+// anything else is culled list by list and sorted as a whole
+void SortLists(const SpriteFrame& frame, const math::AABB* viewBounds, PreparedSpriteFrame& outFrame, RenderStats& outStats)
+{
+    ZoneScoped;
+
+    Clock phaseClock;
+    SpriteDrawList& sprites = outFrame.sprites;
+    u32 separateRunCount = 0;
+    for (SpriteDrawList* drawList : frame.GetDrawLists())
+    {
+        const usize listBegin = sprites.size();
+        if (viewBounds)
+        {
+            outStats.culledSpriteCount += CullSprites(drawList->data(), drawList->size(), *viewBounds, sprites);
+        }
+        else
+        {
+            sprites.AddSprites(drawList->data(), (u32)drawList->size());
+        }
+        separateRunCount += CountTextureRuns(sprites, listBegin, sprites.size());
+    }
+    outStats.cullTime += phaseClock.Tick();
+
+    // stable, so sprites with equal layers and textures keep the order of the lists and their order within them
+    sprites.SortForRendering();
+    outStats.mergedDrawcallsSaved += (i32)separateRunCount - (i32)CountTextureRuns(sprites, 0, sprites.size());
+    outStats.sortTime += phaseClock.Tick();
+}
+
+}
+
+void SpriteFrame::clear()
+{
+    m_DrawLists.clear();
+    m_StaticBatches.clear();
+}
+
+void PrepareFrameForSubmit(const SpriteFrame& frame, const glm::mat4& viewProjection, bool cull, PreparedSpriteFrame& outFrame, RenderStats& outStats)
+{
+    ZoneScoped;
+
+    const math::AABB viewBounds = ComputeViewBounds(viewProjection);
+
+    SpriteDrawList& sprites = outFrame.sprites;
+    sprites.clear();
+
+    // sprites recorded on other threads join the lists here
+    Clock phaseClock;
+    outFrame.groups.clear();
+    bool listsSorted = true;
+    for (u32 listIdx = 0; listIdx < frame.GetDrawLists().size(); ++listIdx)
+    {
+        SpriteDrawList& drawList = *frame.GetDrawLists()[listIdx];
+        drawList.MergeSegments();
+        outStats.spriteCount += (u32)drawList.size();
+
+        listsSorted = listsSorted && SplitIntoGroups(drawList, listIdx, outFrame.groups);
+    }
+    outStats.sortTime += phaseClock.Tick();
+
+    if (listsSorted)
+    {
+        MergeSortedLists(frame, cull ? &viewBounds : nullptr, outFrame, outStats);
+    }
+    else
+    {
+        SortLists(frame, cull ? &viewBounds : nullptr, outFrame, outStats);
+    }
+
+    phaseClock.Tick();
+    std::vector<SpriteFramePart>& staticParts = outFrame.staticParts;
+    staticParts.clear();
+    for (const StaticSpriteBatch* batch : frame.GetStaticBatches())
+    {
+        outFrame.staticDraws.clear();
+        const u32 visibleCount = batch->CollectVisibleDraws(viewBounds, outFrame.staticDraws);
+        outStats.spriteCount += batch->GetSpriteCount();
+        outStats.culledSpriteCount += batch->GetSpriteCount() - visibleCount;
+        outStats.staticSpriteCount += visibleCount;
+
+        for (const StaticSpriteBatch::Draw& draw : outFrame.staticDraws)
+        {
+            staticParts.push_back({ batch, draw.texture, draw.layer, draw.firstSprite, draw.spriteCount });
+        }
+    }
+    outStats.cullTime += phaseClock.Tick();
+
+    // draws of every batch are in layer order already, the ones of different batches with equal layers keep the order of the batches
+    std::stable_sort(staticParts.begin(), staticParts.end(), [](const SpriteFramePart& a, const SpriteFramePart& b) { return a.layer < b.layer; });
+
+    std::vector<SpriteFramePart>& parts = outFrame.parts;
+    parts.clear();
+    u32 spriteIdx = 0;
+    auto addSprites = [&](u32 end) {
+        if (end > spriteIdx)
+        {
+            parts.push_back({ nullptr, TextureHandle(), sprites[spriteIdx].layer, spriteIdx, end - spriteIdx });
+            spriteIdx = end;
+        }
+    };
+
+    for (const SpriteFramePart& staticPart : staticParts)
+    {
+        // the merged sprites of lower layers go before the draw
+        const auto spritesBegin = sprites.begin() + spriteIdx;
+        const auto lowerEnd = std::partition_point(spritesBegin, sprites.end(), [&](const SpriteDrawRequest& sprite) { return sprite.layer < staticPart.layer; });
+        addSprites(spriteIdx + (u32)(lowerEnd - spritesBegin));
+
+        parts.push_back(staticPart);
+    }
+
+    addSprites((u32)sprites.size());
+    outStats.sortTime += phaseClock.Tick();
+}
+
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <render_core/i_render_context.h>
+
+namespace cgt::render
+{
+
+/*
+ * Everything drawn with the sprite pipeline in a frame, submitted at once with IRenderContext::SubmitFrame.
+ * The sprites of all of the draw lists are merged into one list and sorted together, so layers order sprites
+ * across lists instead of the order of the submissions, and sprites of different lists sharing a texture go out
+ * in the same batches. Draws of the static batches go in between by their layers, before the sprites of equal ones.
+ * Only pointers are kept, the lists and batches have to stay alive until the frame is submitted.
+ */
+class SpriteFrame : private NonCopyable
+{
+public:
+    // the list isn't sorted or changed in any other way, sprites recorded into its segments are merged on submission
+    void AddDrawList(SpriteDrawList& drawList) { m_DrawLists.push_back(&drawList); }
+    void AddStaticBatch(const StaticSpriteBatch& batch) { m_StaticBatches.push_back(&batch); }
+
+    const std::vector<SpriteDrawList*>& GetDrawLists() const { return m_DrawLists; }
+    const std::vector<const StaticSpriteBatch*>& GetStaticBatches() const { return m_StaticBatches; }
+
+    void clear();
+
+private:
+    std::vector<SpriteDrawList*> m_DrawLists;
+    std::vector<const StaticSpriteBatch*> m_StaticBatches;
+};
+
+// a piece of a prepared frame in drawing order
+struct SpriteFramePart
+{
+    // null for a run of the merged sprites, which may span several textures
+    const StaticSpriteBatch* staticBatch = nullptr;
+    // only set for draws of static batches
+    TextureHandle texture;
+    u8 layer = 0;
+    u32 firstSprite = 0;
+    u32 spriteCount = 0;
+};
+
+// a frame ready to be drawn, kept by the backends between frames, so it doesn't get reallocated every time
+struct PreparedSpriteFrame
+{
+    // the visible sprites of all of the draw lists, sorted
+    SpriteDrawList sprites;
+    std::vector<SpriteFramePart> parts;
+
+    // runs of one layer and texture in the draw lists, so lists that are sorted already only have to be merged
+    struct SpriteGroup
+    {
+        u32 sortKey = 0;
+        u32 listIdx = 0;
+        u32 firstSprite = 0;
+        u32 spriteCount = 0;
+    };
+
+    std::vector<SpriteGroup> groups;
+    std::vector<u32> lastListTextures;
+    std::vector<StaticSpriteBatch::Draw> staticDraws;
+    std::vector<SpriteFramePart> staticParts;
+};
+
+/*
+ * The start of SubmitFrame shared by the backends: merges the sprites of the lists into one list, culled unless
+ * culling is off, sorts it and splits it by the layers of the visible static draws. Fills in the sprite counts
+ * and the draw calls saved against submitting every list on its own in the order it's in.
+ */
+void PrepareFrameForSubmit(const SpriteFrame& frame, const glm::mat4& viewProjection, bool cull, PreparedSpriteFrame& outFrame, RenderStats& outStats);
+
+}
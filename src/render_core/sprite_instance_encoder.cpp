@@ -0,0 +1,331 @@
+#include <render_core/pch.h>
+
+#include <render_core/sprite_instance_encoder.h>
+#include <engine/job_system.h>
+
+namespace cgt::render
+{
+
+namespace
+{
+
+// the same constant glm::radians multiplies with
+const float DEGREES_TO_RADIANS = 0.01745329251994329576923690768489f;
+
+void EncodeSpriteInstanceScalar(const SpriteDrawRequest& sprite, SpriteInstanceData& outInstance)
+{
+    outInstance.colorTint = sprite.colorTint;
+    outInstance.position = sprite.position;
+    outInstance.uvMin = sprite.src.uv.min;
+    outInstance.uvMax = sprite.src.uv.max;
+    outInstance.scale = sprite.scale;
+    outInstance.rotation = (sprite.rotation - sprite.src.baseRotation) * DEGREES_TO_RADIANS;
+}
+
+const float SMALLEST_NORMAL_HALF = 6.103515625e-05f;
+const float LARGEST_HALF = 65504.0f;
+
+// finite values within the half float range only, anything below the smallest normal half becomes zero
+u16 FloatToHalf(float value)
+{
+    u32 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    const u32 sign = (bits >> 16) & 0x8000;
+    const u32 absBits = bits & 0x7FFFFFFF;
+    if (absBits < 0x38800000)
+    {
+        return (u16)sign;
+    }
+
+    // rebias the exponent from 127 to 15 and round the mantissa to the nearest even
+    const u32 rebiased = absBits - 0x38000000;
+    const u32 rounded = (rebiased + 0x0FFF + ((rebiased >> 13) & 1)) >> 13;
+    return (u16)(sign | rounded);
+}
+
+bool IsHalfRepresentable(float value)
+{
+    const float absValue = glm::abs(value);
+    return absValue == 0.0f || (absValue >= SMALLEST_NORMAL_HALF && absValue <= LARGEST_HALF);
+}
+
+// rounds half to even like the default SSE rounding mode, without a call into the C library
+i32 RoundToInt(float value)
+{
+#if CGT_SIMD_SSE2
+    return _mm_cvtss_si32(_mm_set_ss(value));
+#else
+    return (i32)std::nearbyint(value);
+#endif
+}
+
+void EncodeCompactSpriteInstanceScalar(const SpriteDrawRequest& sprite, glm::vec2 origin, float inverseStep, CompactSpriteInstanceData& outInstance)
+{
+    const float rotationStepsPerDegree = 65536.0f / 360.0f;
+    const glm::vec4 tint = sprite.colorTint * 255.0f;
+    const glm::vec2 position = (sprite.position - origin) * inverseStep;
+
+    // the rotation wraps around through the truncation to 16 bits
+    CompactSpriteInstanceData instance;
+    instance.colorTint = (u32)RoundToInt(tint.r) | ((u32)RoundToInt(tint.g) << 8) | ((u32)RoundToInt(tint.b) << 16) | ((u32)RoundToInt(tint.a) << 24);
+    instance.position[0] = (i16)RoundToInt(position.x);
+    instance.position[1] = (i16)RoundToInt(position.y);
+    instance.scale[0] = FloatToHalf(sprite.scale.x);
+    instance.scale[1] = FloatToHalf(sprite.scale.y);
+    instance.rotation = (u16)RoundToInt((sprite.rotation - sprite.src.baseRotation) * rotationStepsPerDegree);
+    instance.uvRect = sprite.src.uvRect;
+
+    outInstance = instance;
+}
+
+#if CGT_SIMD_SSE2
+
+// FloatToHalf on four floats, the halves end up in the low bits of the lanes
+__m128i FloatToHalf4(__m128 values)
+{
+    const __m128i bits = _mm_castps_si128(values);
+    const __m128i sign = _mm_and_si128(_mm_srli_epi32(bits, 16), _mm_set1_epi32(0x8000));
+    const __m128i absBits = _mm_and_si128(bits, _mm_set1_epi32(0x7FFFFFFF));
+    const __m128i isTiny = _mm_cmplt_epi32(absBits, _mm_set1_epi32(0x38800000));
+
+    const __m128i rebiased = _mm_sub_epi32(absBits, _mm_set1_epi32(0x38000000));
+    const __m128i odd = _mm_and_si128(_mm_srli_epi32(rebiased, 13), _mm_set1_epi32(1));
+    const __m128i rounded = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(rebiased, _mm_set1_epi32(0x0FFF)), odd), 13);
+    return _mm_or_si128(sign, _mm_andnot_si128(isTiny, rounded));
+}
+
+// keeps the low 16 bits of the lanes sign extended, so a saturating pack truncates them like a cast would
+__m128i SignExtend16(__m128i values)
+{
+    return _mm_srai_epi32(_mm_slli_epi32(values, 16), 16);
+}
+
+#endif
+
+// the instance data is read from whole 16 byte pieces of the sprite
+static_assert(offsetof(SpriteDrawRequest, colorTint) + sizeof(glm::vec4) == offsetof(SpriteDrawRequest, position));
+static_assert(offsetof(SpriteDrawRequest, position) + sizeof(glm::vec2) == offsetof(SpriteDrawRequest, scale));
+static_assert(offsetof(SpriteSource, uv) + sizeof(math::AABB) == offsetof(SpriteSource, baseRotation));
+
+}
+
+#if CGT_SIMD_SSE2
+
+void EncodeSpriteInstances(const SpriteDrawRequest* sprites, usize count, SpriteInstanceData* outInstances)
+{
+    ZoneScoped;
+
+    const __m128 degreesToRadians = _mm_set1_ps(DEGREES_TO_RADIANS);
+
+    usize i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const SpriteDrawRequest* s = sprites + i;
+        const __m128 rotations = _mm_setr_ps(s[0].rotation, s[1].rotation, s[2].rotation, s[3].rotation);
+        const __m128 baseRotations = _mm_setr_ps(s[0].src.baseRotation, s[1].src.baseRotation, s[2].src.baseRotation, s[3].src.baseRotation);
+        alignas(16) float radians[4];
+        _mm_store_ps(radians, _mm_mul_ps(_mm_sub_ps(rotations, baseRotations), degreesToRadians));
+
+        for (u32 lane = 0; lane < 4; ++lane)
+        {
+            const SpriteDrawRequest& sprite = s[lane];
+            float* out = (float*)(outInstances + i + lane);
+
+            // tint | position, uv min | uv max, scale | rotation: the instance is written front to back in full
+            const __m128 tint = _mm_loadu_ps(&sprite.colorTint.x);
+            const __m128 positionScale = _mm_loadu_ps(&sprite.position.x);
+            const __m128 uv = _mm_loadu_ps(&sprite.src.uv.min.x);
+            _mm_storeu_ps(out, tint);
+            _mm_storeu_ps(out + 4, _mm_movelh_ps(positionScale, uv));
+            _mm_storeu_ps(out + 8, _mm_movehl_ps(positionScale, uv));
+            out[12] = radians[lane];
+        }
+    }
+
+    for (; i < count; ++i)
+    {
+        EncodeSpriteInstanceScalar(sprites[i], outInstances[i]);
+    }
+}
+
+#else
+
+void EncodeSpriteInstances(const SpriteDrawRequest* sprites, usize count, SpriteInstanceData* outInstances)
+{
+    ZoneScoped;
+
+    for (usize i = 0; i < count; ++i)
+    {
+        EncodeSpriteInstanceScalar(sprites[i], outInstances[i]);
+    }
+}
+
+#endif
+
+void EncodeSpriteInstancesParallel(JobSystem& jobSystem, const SpriteDrawRequest* sprites, usize count, SpriteInstanceData* outInstances, u32 chunkSize)
+{
+    ZoneScoped;
+
+    jobSystem.ParallelFor((u32)count, chunkSize, [=](u32 begin, u32 end) {
+        EncodeSpriteInstances(sprites + begin, end - begin, outInstances + begin);
+    });
+}
+
+bool CompactSpriteEncoder::Prepare(const SpriteDrawRequest* sprites, usize count, u32 uvRectCount)
+{
+    ZoneScoped;
+
+    m_Sprites = sprites;
+    m_Count = count;
+
+    if (count == 0)
+    {
+        m_Origin = glm::vec2(0.0f);
+        m_PositionStep = MAX_POSITION_STEP;
+        return true;
+    }
+
+    // batches spread too wide for the format are the usual reason to fall back, so the positions are checked on their own first.
+    // The sprite goes first into min and max for NaNs to make it into the bounds, where they fail the step check
+    glm::vec2 positionMin(std::numeric_limits<float>::max());
+    glm::vec2 positionMax(std::numeric_limits<float>::lowest());
+    for (usize i = 0; i < count; ++i)
+    {
+        positionMin = glm::min(sprites[i].position, positionMin);
+        positionMax = glm::max(sprites[i].position, positionMax);
+    }
+
+    // also rejects infinite positions
+    m_Origin = glm::floor((positionMin + positionMax) * 0.5f);
+    const glm::vec2 maxOffset = glm::max(glm::abs(positionMin - m_Origin), glm::abs(positionMax - m_Origin));
+    const float requiredStep = glm::max(maxOffset.x, maxOffset.y) / (float)INT16_MAX;
+    if (!(requiredStep <= MAX_POSITION_STEP))
+    {
+        return false;
+    }
+
+    m_PositionStep = MAX_POSITION_STEP;
+    while (m_PositionStep * 0.5f >= requiredStep && m_PositionStep > 1.0f / 65536.0f)
+    {
+        m_PositionStep *= 0.5f;
+    }
+
+    for (usize i = 0; i < count; ++i)
+    {
+        const SpriteDrawRequest& sprite = sprites[i];
+
+        // written so that NaNs fail them too, NO_UV_RECT is past the end of any table
+        const bool tintInRange = sprite.colorTint == glm::clamp(sprite.colorTint, glm::vec4(0.0f), glm::vec4(1.0f));
+        const bool rotationInRange = glm::abs(sprite.rotation - sprite.src.baseRotation) <= MAX_ROTATION_DEGREES;
+        if (!tintInRange || !rotationInRange || !IsHalfRepresentable(sprite.scale.x) || !IsHalfRepresentable(sprite.scale.y)
+            || sprite.src.uvRect >= uvRectCount)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void CompactSpriteEncoder::Encode(CompactSpriteInstanceData* outInstances, CompactSpriteBatchConstants& outConstants) const
+{
+    ZoneScoped;
+
+    outConstants.origin = m_Origin;
+    outConstants.positionStep = m_PositionStep;
+    outConstants.unused = 0.0f;
+
+    const float inverseStep = 1.0f / m_PositionStep;
+
+    usize i = 0;
+#if CGT_SIMD_SSE2
+    const __m128 tintScale = _mm_set1_ps(255.0f);
+    const __m128 origin = _mm_setr_ps(m_Origin.x, m_Origin.y, m_Origin.x, m_Origin.y);
+    const __m128 inverseSteps = _mm_set1_ps(inverseStep);
+    const __m128 rotationStepsPerDegree = _mm_set1_ps(65536.0f / 360.0f);
+    const __m128i lowHalf = _mm_set1_epi32(0xFFFF);
+    for (; i + 4 <= m_Count; i += 4)
+    {
+        const SpriteDrawRequest* s = m_Sprites + i;
+
+        // four tints to RGBA8, the ranges were checked so the saturating packs don't clamp anything
+        const __m128i tint01 = _mm_packs_epi32(
+            _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(&s[0].colorTint.x), tintScale)),
+            _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(&s[1].colorTint.x), tintScale)));
+        const __m128i tint23 = _mm_packs_epi32(
+            _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(&s[2].colorTint.x), tintScale)),
+            _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(&s[3].colorTint.x), tintScale)));
+        const __m128i tints = _mm_packus_epi16(tint01, tint23);
+
+        // position | scale of every sprite, positions and scales of two sprites go into a register each
+        const __m128 positionScale0 = _mm_loadu_ps(&s[0].position.x);
+        const __m128 positionScale1 = _mm_loadu_ps(&s[1].position.x);
+        const __m128 positionScale2 = _mm_loadu_ps(&s[2].position.x);
+        const __m128 positionScale3 = _mm_loadu_ps(&s[3].position.x);
+        const __m128i positions01 = _mm_cvtps_epi32(_mm_mul_ps(_mm_sub_ps(_mm_movelh_ps(positionScale0, positionScale1), origin), inverseSteps));
+        const __m128i positions23 = _mm_cvtps_epi32(_mm_mul_ps(_mm_sub_ps(_mm_movelh_ps(positionScale2, positionScale3), origin), inverseSteps));
+        const __m128i positions = _mm_packs_epi32(positions01, positions23);
+        const __m128i scales01 = SignExtend16(FloatToHalf4(_mm_movehl_ps(positionScale1, positionScale0)));
+        const __m128i scales23 = SignExtend16(FloatToHalf4(_mm_movehl_ps(positionScale3, positionScale2)));
+        const __m128i scales = _mm_packs_epi32(scales01, scales23);
+
+        const __m128 rotations = _mm_setr_ps(s[0].rotation, s[1].rotation, s[2].rotation, s[3].rotation);
+        const __m128 baseRotations = _mm_setr_ps(s[0].src.baseRotation, s[1].src.baseRotation, s[2].src.baseRotation, s[3].src.baseRotation);
+        const __m128i rotationSteps = _mm_cvtps_epi32(_mm_mul_ps(_mm_sub_ps(rotations, baseRotations), rotationStepsPerDegree));
+        const __m128i uvRects = _mm_setr_epi32(s[0].src.uvRect, s[1].src.uvRect, s[2].src.uvRect, s[3].src.uvRect);
+        const __m128i rotationsAndUVRects = _mm_or_si128(_mm_and_si128(rotationSteps, lowHalf), _mm_slli_epi32(uvRects, 16));
+
+        // every register holds one field of the four instances, transposed into four whole instances
+        const __m128i tintsPositions01 = _mm_unpacklo_epi32(tints, positions);
+        const __m128i tintsPositions23 = _mm_unpackhi_epi32(tints, positions);
+        const __m128i scalesRotations01 = _mm_unpacklo_epi32(scales, rotationsAndUVRects);
+        const __m128i scalesRotations23 = _mm_unpackhi_epi32(scales, rotationsAndUVRects);
+        __m128i* out = (__m128i*)(outInstances + i);
+        _mm_storeu_si128(out, _mm_unpacklo_epi64(tintsPositions01, scalesRotations01));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi64(tintsPositions01, scalesRotations01));
+        _mm_storeu_si128(out + 2, _mm_unpacklo_epi64(tintsPositions23, scalesRotations23));
+        _mm_storeu_si128(out + 3, _mm_unpackhi_epi64(tintsPositions23, scalesRotations23));
+    }
+#endif
+
+    for (; i < m_Count; ++i)
+    {
+        EncodeCompactSpriteInstanceScalar(m_Sprites[i], m_Origin, inverseStep, outInstances[i]);
+    }
+}
+
+usize CompactSpriteEncoder::GetEncodedSize() const
+{
+    return m_Count * sizeof(CompactSpriteInstanceData) + sizeof(CompactSpriteBatchConstants);
+}
+
+usize FindSpriteBatchEnd(const SpriteDrawList& drawList, usize begin, usize maxBatchSize)
+{
+    const usize end = glm::min(drawList.size(), begin + maxBatchSize);
+    if (begin >= end)
+    {
+        return end;
+    }
+
+    const TextureHandle texture = drawList[begin].src.texture;
+    usize batchEnd = begin + 1;
+    while (batchEnd < end && drawList[batchEnd].src.texture == texture)
+    {
+        ++batchEnd;
+    }
+
+    return batchEnd;
+}
+
+BatchCut GetSpriteBatchCut(const SpriteDrawList& drawList, usize batchEnd, usize end)
+{
+    if (batchEnd >= end)
+    {
+        return BatchCut::None;
+    }
+
+    return drawList[batchEnd].src.texture != drawList[batchEnd - 1].src.texture ? BatchCut::TextureChange : BatchCut::MaxBatchSize;
+}
+
+}
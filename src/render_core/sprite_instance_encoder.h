@@ -0,0 +1,104 @@
+#pragma once
+
+#include <render_core/sprite_draw_list.h>
+#include <render_core/i_render_context.h>
+
+namespace cgt
+{
+class JobSystem;
+}
+
+namespace cgt::render
+{
+
+// per instance input of the sprite vertex shader, tightly packed
+struct SpriteInstanceData
+{
+    glm::vec4 colorTint;
+    glm::vec2 position;
+    glm::vec2 uvMin;
+    glm::vec2 uvMax;
+    glm::vec2 scale;
+    // radians, the base rotation of the sprite source already taken out
+    float rotation;
+};
+
+static_assert(sizeof(SpriteInstanceData) == 52);
+
+// quantized version of the instance data, for batches whose sprites fit its ranges
+struct CompactSpriteInstanceData
+{
+    // RGBA8, red in the lowest byte
+    u32 colorTint;
+    // fixed point offset from the batch origin, in batch position steps
+    i16 position[2];
+    // half floats
+    u16 scale[2];
+    // a full turn over the 16 bits
+    u16 rotation;
+    // index into the uv rect table of the texture
+    u16 uvRect;
+};
+
+static_assert(sizeof(CompactSpriteInstanceData) == 16);
+
+// per batch constants of the compact format, laid out the way the shader constant buffer is
+struct CompactSpriteBatchConstants
+{
+    glm::vec2 origin;
+    float positionStep;
+    float unused;
+};
+
+/*
+ * Turning sprites into instance data, shared by all of the backends. Sprites are encoded four at a time with SSE2
+ * where it's available, the scalar fallback gives the same results. Every instance is written front to back
+ * in full, so the output can be a mapped GPU buffer, which should never be read from.
+ * Encoding disjoint ranges from different threads is safe.
+ */
+
+// writes count instances, one for every sprite
+void EncodeSpriteInstances(const SpriteDrawRequest* sprites, usize count, SpriteInstanceData* outInstances);
+
+// splits the encoding over the job system in chunks of chunkSize, the calling thread takes part
+void EncodeSpriteInstancesParallel(JobSystem& jobSystem, const SpriteDrawRequest* sprites, usize count, SpriteInstanceData* outInstances, u32 chunkSize = 4096);
+
+/*
+ * Encodes batches in the compact format when that doesn't lose visible precision: positions have to fit the 16 bit fixed point range
+ * with a step of at most MAX_POSITION_STEP world units, tints have to be within [0, 1], scales have to be representable as half floats,
+ * rotations can't go past MAX_ROTATION_DEGREES and every sprite has to come with a uv rect from the table of its texture.
+ * Steps are powers of two around an integer origin, so positions on the usual grids are encoded exactly.
+ * Uvs are never looked at, the tables are built when textures load, so encoding is a quantize pass, four sprites at a time with SSE2.
+ * Holds on to the batch from Prepare to Encode, meant to be owned by the render context.
+ */
+class CompactSpriteEncoder : private NonCopyable
+{
+public:
+    // a quarter of a pixel at 256 pixels per unit, which leaves a range of 32 units around the origin
+    static constexpr float MAX_POSITION_STEP = 1.0f / 1024.0f;
+    // keeps the rotation steps within 32 bits before they're wrapped to 16
+    static constexpr float MAX_ROTATION_DEGREES = 360.0f * 32767.0f;
+
+    // false if the batch needs the full format, uvRectCount is the size of the table of the batch texture
+    bool Prepare(const SpriteDrawRequest* sprites, usize count, u32 uvRectCount);
+
+    // only after a successful Prepare, the sprites have to be the same and still alive
+    void Encode(CompactSpriteInstanceData* outInstances, CompactSpriteBatchConstants& outConstants) const;
+
+    // what actually has to be uploaded for the batch, instances and constants together
+    usize GetEncodedSize() const;
+
+private:
+    const SpriteDrawRequest* m_Sprites = nullptr;
+    usize m_Count = 0;
+
+    glm::vec2 m_Origin = glm::vec2(0.0f);
+    float m_PositionStep = 0.0f;
+};
+
+// end of the batch starting at begin: sprites with the same texture, at most maxBatchSize of them
+usize FindSpriteBatchEnd(const SpriteDrawList& drawList, usize begin, usize maxBatchSize);
+// why a batch from FindSpriteBatchEnd ended where it did, end being the end of the sprites being drawn
+BatchCut GetSpriteBatchCut(const SpriteDrawList& drawList, usize batchEnd, usize end);
+
+}
@@ -0,0 +1,92 @@
+#include <render_core/pch.h>
+
+#include <render_core/static_sprite_batch.h>
+#include <render_core/sprite_culling.h>
+
+namespace cgt::render
+{
+
+u32 StaticSpriteBatch::CollectVisibleDraws(const math::AABB& viewBounds, std::vector<Draw>& outDraws) const
+{
+    ZoneScoped;
+
+    u32 visibleSprites = 0;
+    for (const Range& range : m_Ranges)
+    {
+        if (!math::AABBOverlap(range.bounds, viewBounds))
+        {
+            continue;
+        }
+
+        visibleSprites += range.spriteCount;
+
+        Draw* lastDraw = outDraws.empty() ? nullptr : &outDraws.back();
+        if (lastDraw && lastDraw->texture == range.texture && lastDraw->layer == range.layer
+            && lastDraw->firstSprite + lastDraw->spriteCount == range.firstSprite)
+        {
+            lastDraw->spriteCount += range.spriteCount;
+        }
+        else
+        {
+            outDraws.push_back({ range.texture, range.layer, range.firstSprite, range.spriteCount });
+        }
+    }
+
+    return visibleSprites;
+}
+
+void StaticSpriteBatch::SortAndSplit(const SpriteDrawList& drawList, std::vector<SpriteDrawRequest>& outSortedSprites)
+{
+    ZoneScoped;
+
+    m_SpriteCount = (u32)drawList.size();
+    m_Ranges.clear();
+    outSortedSprites.clear();
+    if (m_SpriteCount == 0)
+    {
+        return;
+    }
+
+    glm::vec2 origin = drawList[0].position;
+    for (const SpriteDrawRequest& sprite : drawList)
+    {
+        origin = glm::min(origin, sprite.position);
+    }
+
+    // layer, chunk row, chunk column and texture from the most to the least significant bits,
+    // paired with the index of the sprite, which keeps sprites of equal keys in the order of the list
+    std::vector<std::pair<u64, u32>> keys(m_SpriteCount);
+    for (u32 spriteIdx = 0; spriteIdx < m_SpriteCount; ++spriteIdx)
+    {
+        const SpriteDrawRequest& sprite = drawList[spriteIdx];
+        const glm::uvec2 chunk = glm::uvec2((sprite.position - origin) / (float)CHUNK_SIZE);
+        CGT_ASSERT(chunk.x <= 0xFFFF && chunk.y <= 0xFFFF);
+        const u64 key = ((u64)sprite.layer << 48) | ((u64)chunk.y << 32) | ((u64)chunk.x << 16) | sprite.src.texture.index;
+        keys[spriteIdx] = { key, spriteIdx };
+    }
+    std::sort(keys.begin(), keys.end());
+
+    outSortedSprites.reserve(m_SpriteCount);
+    for (u32 spriteIdx = 0; spriteIdx < m_SpriteCount; ++spriteIdx)
+    {
+        const SpriteDrawRequest& sprite = drawList[keys[spriteIdx].second];
+        const math::AABB bounds = GetSpriteBounds(sprite);
+        outSortedSprites.push_back(sprite);
+
+        if (spriteIdx == 0 || keys[spriteIdx].first != keys[spriteIdx - 1].first)
+        {
+            Range& range = m_Ranges.emplace_back();
+            range.texture = sprite.src.texture;
+            range.layer = sprite.layer;
+            range.firstSprite = spriteIdx;
+            range.bounds = bounds;
+        }
+
+        Range& range = m_Ranges.back();
+        range.bounds.min = glm::min(range.bounds.min, bounds.min);
+        range.bounds.max = glm::max(range.bounds.max, bounds.max);
+        ++range.spriteCount;
+    }
+}
+
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <render_core/sprite_draw_list.h>
+
+namespace cgt::render
+{
+
+/*
+ * Sprites that never change, sorted and encoded by the render context once when the batch is created and kept
+ * resident from then on. The sorted sprites are split into square chunks per layer and the chunks into ranges
+ * of one texture with their bounds, submitting the batch culls the ranges and draws the visible ones,
+ * neighbouring ones merged into one draw.
+ * Created by IRenderContext::CreateStaticBatch, only the context that created it can submit it and it has to outlive the batch.
+ */
+class StaticSpriteBatch : private NonCopyable
+{
+public:
+    // side of the culling chunks in world units, that's 16x16 tiles of one unit like the ones TilesetHelper makes
+    static constexpr u32 CHUNK_SIZE = 16;
+
+    struct Draw
+    {
+        TextureHandle texture;
+        u8 layer = 0;
+        u32 firstSprite = 0;
+        u32 spriteCount = 0;
+    };
+
+    virtual ~StaticSpriteBatch() = default;
+
+    u32 GetSpriteCount() const { return m_SpriteCount; }
+    u32 GetRangeCount() const { return (u32)m_Ranges.size(); }
+
+    // the draws covering every range that overlaps the view bounds, returns the amount of sprites in them
+    u32 CollectVisibleDraws(const math::AABB& viewBounds, std::vector<Draw>& outDraws) const;
+
+protected:
+    // orders the sprites by layer, then by chunk row and column and then by texture, and splits them into ranges
+    // of one layer, chunk and texture. Backends encode the sorted sprites into whatever they draw from
+    void SortAndSplit(const SpriteDrawList& drawList, std::vector<SpriteDrawRequest>& outSortedSprites);
+
+private:
+    struct Range
+    {
+        TextureHandle texture;
+        u8 layer = 0;
+        u32 firstSprite = 0;
+        u32 spriteCount = 0;
+        math::AABB bounds;
+    };
+
+    std::vector<Range> m_Ranges;
+    u32 m_SpriteCount = 0;
+};
+
+}
@@ -0,0 +1,22 @@
+#include <render_core/pch.h>
+
+#include <render_core/texture.h>
+#include <render_core/i_render_context.h>
+
+namespace cgt::render
+{
+
+Texture::Texture(IRenderContext& render, TextureHandle handle)
+    : m_Render(render)
+    , m_Handle(handle)
+{
+    CGT_ASSERT_MSG(!m_Render.m_HasRenderThread, "Textures can't be created while a render thread draws with the context");
+}
+
+Texture::~Texture()
+{
+    CGT_ASSERT_MSG(!m_Render.m_HasRenderThread, "Textures can't be released while a render thread draws with the context");
+    m_Render.ReleaseTexture(m_Handle);
+}
+
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+namespace cgt::render
+{
+
+class IRenderContext;
+
+/*
+ * Weak reference to a texture owned by the render context: a slot in its texture pool and the generation of that slot.
+ * It's trivially copyable, so sprites can be copied around without touching any reference counts.
+ * Handles that outlive their texture are told apart by the generation and render as the missing texture.
+ */
+struct TextureHandle
+{
+    bool IsNull() const { return index == 0; }
+
+    bool operator==(const TextureHandle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const TextureHandle& other) const { return !(*this == other); }
+
+    // 0 is no texture
+    u16 index = 0;
+    u16 generation = 0;
+};
+
+/*
+ * Strong owner of a texture loaded by the render context, the texture is released once the owner is destroyed.
+ * Has to be destroyed before the render context itself. Neither can happen while a RenderThread draws with the context.
+ */
+class Texture : private NonCopyable
+{
+public:
+    Texture(IRenderContext& render, TextureHandle handle);
+    ~Texture();
+
+    TextureHandle GetHandle() const { return m_Handle; }
+
+private:
+    IRenderContext& m_Render;
+    TextureHandle m_Handle;
+};
+
+typedef std::shared_ptr<Texture> TextureOwner;
+
+/*
+ * Generational pool of backend texture objects, meant to be owned by the render context.
+ * Slot 0 is reserved for the null handle, freed slots get reused with the next generation.
+ * Not synchronized: adding and removing textures can't overlap with anything reading the pool.
+ */
+template<typename TTexture>
+class TexturePool : private NonCopyable
+{
+public:
+    TexturePool()
+    {
+        m_Slots.emplace_back();
+    }
+
+    TextureHandle Add(TTexture&& texture)
+    {
+        u16 index;
+        if (!m_FreeSlots.empty())
+        {
+            index = m_FreeSlots.back();
+            m_FreeSlots.pop_back();
+        }
+        else
+        {
+            CGT_ASSERT_ALWAYS_MSG(m_Slots.size() <= UINT16_MAX, "Out of texture slots");
+            index = (u16)m_Slots.size();
+            m_Slots.emplace_back();
+        }
+
+        Slot& slot = m_Slots[index];
+        slot.texture = std::move(texture);
+        slot.isUsed = true;
+
+        return { index, slot.generation };
+    }
+
+    void Remove(TextureHandle handle)
+    {
+        CGT_ASSERT(Get(handle) != nullptr);
+
+        Slot& slot = m_Slots[handle.index];
+        slot.texture = TTexture();
+        slot.isUsed = false;
+        ++slot.generation;
+
+        m_FreeSlots.push_back(handle.index);
+    }
+
+    // null for the null handle and for handles of released textures
+    TTexture* Get(TextureHandle handle)
+    {
+        if (handle.index >= m_Slots.size())
+        {
+            return nullptr;
+        }
+
+        Slot& slot = m_Slots[handle.index];
+        return slot.isUsed && slot.generation == handle.generation ? &slot.texture : nullptr;
+    }
+
+private:
+    struct Slot
+    {
+        TTexture texture;
+        u16 generation = 0;
+        bool isUsed = false;
+    };
+
+    std::vector<Slot> m_Slots;
+    std::vector<u16> m_FreeSlots;
+};
+
+}
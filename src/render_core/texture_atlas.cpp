@@ -0,0 +1,278 @@
+#include <render_core/pch.h>
+
+#include <render_core/texture_atlas.h>
+#include <render_core/i_render_context.h>
+#include <render_core/skyline_packer.h>
+
+namespace cgt::render
+{
+
+math::AABB TextureAtlas::RemapUV(u32 region, const math::AABB& uv) const
+{
+    const math::AABB& regionUV = m_Regions[region].uv;
+    const glm::vec2 regionSize = regionUV.max - regionUV.min;
+    return { regionUV.min + uv.min * regionSize, regionUV.min + uv.max * regionSize };
+}
+
+SpriteSource TextureAtlas::GetSpriteSource(u32 region) const
+{
+    SpriteSource src;
+    src.texture = GetTexture(region);
+    src.uv = m_Regions[region].uv;
+    src.uvRect = m_Regions[region].firstUVRect;
+    return src;
+}
+
+SpriteSource TextureAtlas::GetSpriteSource(u32 region, u32 rect) const
+{
+    const Region& r = m_Regions[region];
+
+    SpriteSource src;
+    src.texture = GetTexture(region);
+    src.uv = r.rects[rect];
+    src.uvRect = r.firstUVRect != SpriteSource::NO_UV_RECT ? (u16)(r.firstUVRect + 1 + rect) : SpriteSource::NO_UV_RECT;
+    return src;
+}
+
+u32 TextureAtlas::FindRegion(u32 page, const math::AABB& uv, u32 hintRegion) const
+{
+    const glm::vec2 center = (uv.min + uv.max) * 0.5f;
+    auto contains = [&](u32 region)
+    {
+        const Region& r = m_Regions[region];
+        return r.page == page
+            && center.x >= r.uv.min.x && center.x <= r.uv.max.x
+            && center.y >= r.uv.min.y && center.y <= r.uv.max.y;
+    };
+
+    if (hintRegion < m_Regions.size() && contains(hintRegion))
+    {
+        return hintRegion;
+    }
+
+    for (u32 region = 0; region < m_Regions.size(); ++region)
+    {
+        if (contains(region))
+        {
+            return region;
+        }
+    }
+
+    return UINT32_MAX;
+}
+
+u32 TextureAtlas::CountDrawcallsSaved(const SpriteDrawList& drawList) const
+{
+    ZoneScoped;
+
+    // textures are compared by a key: the region for atlas pages, the handle itself for anything else
+    const u64 NOT_A_PAGE = 1ull << 32;
+
+    u32 textureSwitches = 0;
+    u32 regionSwitches = 0;
+    TextureHandle prevTexture;
+    u64 prevKey = UINT64_MAX;
+    u32 lastRegion = 0;
+    for (usize i = 0; i < drawList.size(); ++i)
+    {
+        const SpriteDrawRequest& sprite = drawList[i];
+
+        u64 key = NOT_A_PAGE | ((u64)sprite.src.texture.index << 16) | sprite.src.texture.generation;
+        for (u32 page = 0; page < m_Pages.size(); ++page)
+        {
+            if (sprite.src.texture == m_Pages[page]->GetHandle())
+            {
+                lastRegion = FindRegion(page, sprite.src.uv, lastRegion);
+                key = lastRegion;
+                break;
+            }
+        }
+
+        if (i > 0)
+        {
+            textureSwitches += sprite.src.texture != prevTexture ? 1 : 0;
+            regionSwitches += key != prevKey ? 1 : 0;
+        }
+
+        prevTexture = sprite.src.texture;
+        prevKey = key;
+    }
+
+    return regionSwitches > textureSwitches ? regionSwitches - textureSwitches : 0;
+}
+
+TextureAtlasBuilder::TextureAtlasBuilder(TextureAtlasConfig config)
+    : m_Config(config)
+{
+    CGT_ASSERT(m_Config.pageSize > 2 * m_Config.padding);
+}
+
+u32 TextureAtlasBuilder::AddImage(Image image)
+{
+    CGT_ASSERT(image.width > 0 && image.height > 0);
+    CGT_ASSERT(image.pixels.size() == (usize)image.width * image.height);
+
+    m_Images.emplace_back(std::move(image));
+    m_ImageRects.emplace_back();
+    return (u32)m_Images.size() - 1;
+}
+
+u32 TextureAtlasBuilder::AddImageFile(const std::filesystem::path& absolutePath)
+{
+    Image image;
+    const bool loaded = LoadImageFile(absolutePath, image);
+    CGT_ASSERT_ALWAYS_MSG(loaded, "Couldn't load image for the texture atlas from {}", absolutePath);
+
+    return AddImage(std::move(image));
+}
+
+void TextureAtlasBuilder::AddImageRects(u32 image, std::vector<math::AABB> uvs)
+{
+    CGT_ASSERT(image < m_ImageRects.size());
+
+    std::vector<math::AABB>& rects = m_ImageRects[image];
+    rects.insert(rects.end(), uvs.begin(), uvs.end());
+}
+
+std::unique_ptr<TextureAtlas> TextureAtlasBuilder::Build(IRenderContext& render)
+{
+    ZoneScoped;
+
+    struct Placement
+    {
+        u32 page;
+        glm::uvec2 position;
+    };
+
+    const u32 padding = m_Config.padding;
+    auto paddedSize = [&](const Image& image) { return glm::uvec2(image.width, image.height) + 2 * padding; };
+
+    // tallest first keeps the skyline flat, which wastes the least space under overhangs
+    std::vector<u32> order(m_Images.size());
+    for (u32 i = 0; i < order.size(); ++i)
+    {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](u32 a, u32 b) { return m_Images[a].height > m_Images[b].height; });
+
+    std::vector<SkylinePacker> packers;
+    std::vector<glm::uvec2> pageSizes;
+    std::vector<Placement> placements(m_Images.size());
+    for (u32 imageIdx : order)
+    {
+        const glm::uvec2 size = paddedSize(m_Images[imageIdx]);
+        Placement& placement = placements[imageIdx];
+
+        if (size.x > m_Config.pageSize || size.y > m_Config.pageSize)
+        {
+            placement.page = (u32)pageSizes.size();
+            placement.position = glm::uvec2(0);
+            pageSizes.push_back(size);
+            // keeps page and packer indices the same, nothing else fits here
+            packers.emplace_back(0, 0);
+            continue;
+        }
+
+        bool packed = false;
+        for (u32 page = 0; page < packers.size() && !packed; ++page)
+        {
+            if (packers[page].Pack(size.x, size.y, placement.position))
+            {
+                placement.page = page;
+                packed = true;
+            }
+        }
+
+        if (!packed)
+        {
+            placement.page = (u32)packers.size();
+            SkylinePacker& packer = packers.emplace_back(m_Config.pageSize, m_Config.pageSize);
+            pageSizes.emplace_back(0);
+
+            packed = packer.Pack(size.x, size.y, placement.position);
+            CGT_ASSERT(packed);
+        }
+    }
+
+    // pages only get as big as what was packed into them
+    for (u32 page = 0; page < packers.size(); ++page)
+    {
+        pageSizes[page] = glm::max(pageSizes[page], packers[page].GetUsedSize());
+    }
+
+    std::vector<Image> pages(pageSizes.size());
+    for (u32 page = 0; page < pages.size(); ++page)
+    {
+        pages[page].width = pageSizes[page].x;
+        pages[page].height = pageSizes[page].y;
+        pages[page].pixels.resize((usize)pageSizes[page].x * pageSizes[page].y, 0);
+    }
+
+    auto atlas = std::unique_ptr<TextureAtlas>(new TextureAtlas());
+    atlas->m_Regions.resize(m_Images.size());
+    for (u32 imageIdx = 0; imageIdx < m_Images.size(); ++imageIdx)
+    {
+        const Image& image = m_Images[imageIdx];
+        const Placement& placement = placements[imageIdx];
+        Image& page = pages[placement.page];
+
+        // the padding repeats the closest edge pixel
+        const glm::uvec2 size = paddedSize(image);
+        for (u32 y = 0; y < size.y; ++y)
+        {
+            const u32 srcY = (u32)glm::clamp((i32)y - (i32)padding, 0, (i32)image.height - 1);
+            const u32* srcRow = image.pixels.data() + (usize)srcY * image.width;
+            u32* dstRow = page.pixels.data() + (usize)(placement.position.y + y) * page.width + placement.position.x;
+            for (u32 x = 0; x < size.x; ++x)
+            {
+                const u32 srcX = (u32)glm::clamp((i32)x - (i32)padding, 0, (i32)image.width - 1);
+                dstRow[x] = srcRow[srcX];
+            }
+        }
+
+        const glm::vec2 pageSize(page.width, page.height);
+        const glm::vec2 imageMin = glm::vec2(placement.position + padding);
+        TextureAtlas::Region& region = atlas->m_Regions[imageIdx];
+        region.page = placement.page;
+        region.uv.min = imageMin / pageSize;
+        region.uv.max = (imageMin + glm::vec2(image.width, image.height)) / pageSize;
+    }
+
+    // regions go into the tables whole, with their rects right after them. Ones that don't fit anymore are left out,
+    // their sprites are still drawn, just never in the compact format
+    std::vector<std::vector<math::AABB>> pageUVRects(pages.size());
+    for (u32 imageIdx = 0; imageIdx < m_Images.size(); ++imageIdx)
+    {
+        TextureAtlas::Region& region = atlas->m_Regions[imageIdx];
+        region.rects.reserve(m_ImageRects[imageIdx].size());
+        for (const math::AABB& uv : m_ImageRects[imageIdx])
+        {
+            region.rects.push_back(atlas->RemapUV(imageIdx, uv));
+        }
+
+        std::vector<math::AABB>& uvRects = pageUVRects[region.page];
+        if (uvRects.size() + 1 + region.rects.size() > SpriteSource::MAX_UV_RECTS)
+        {
+            region.firstUVRect = SpriteSource::NO_UV_RECT;
+            continue;
+        }
+
+        region.firstUVRect = (u16)uvRects.size();
+        uvRects.push_back(region.uv);
+        uvRects.insert(uvRects.end(), region.rects.begin(), region.rects.end());
+    }
+
+    atlas->m_Pages.reserve(pages.size());
+    for (u32 page = 0; page < pages.size(); ++page)
+    {
+        TextureOwner& texture = atlas->m_Pages.emplace_back(render.CreateTexture(pages[page]));
+        render.SetTextureUVRects(texture->GetHandle(), pageUVRects[page]);
+    }
+
+    m_Images.clear();
+    m_ImageRects.clear();
+
+    return atlas;
+}
+
+}
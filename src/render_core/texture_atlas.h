@@ -0,0 +1,90 @@
+#pragma once
+
+#include <render_core/image.h>
+#include <render_core/sprite_draw_list.h>
+
+namespace cgt::render
+{
+
+class IRenderContext;
+
+struct TextureAtlasConfig
+{
+    // images bigger than a page get a page of their own
+    u32 pageSize = 2048;
+    // pixels around every image, filled by repeating its edges so point sampling at the border never picks a neighbour
+    u32 padding = 2;
+};
+
+/*
+ * Images packed into a few big textures, so sprites that used to come from different textures can be batched together.
+ * Every added image is a region on one of the pages, sprite uvs relative to the image are remapped onto the page.
+ * The whole region and the rects added along with its image make up the uv rect tables of the pages, so sprites from them
+ * can use the compact instance format. Built by TextureAtlasBuilder, owns its pages.
+ */
+class TextureAtlas : private NonCopyable
+{
+public:
+    TextureHandle GetTexture(u32 region) const { return m_Pages[m_Regions[region].page]->GetHandle(); }
+    const math::AABB& GetRegionUV(u32 region) const { return m_Regions[region].uv; }
+
+    // maps uvs relative to the original image onto its page
+    math::AABB RemapUV(u32 region, const math::AABB& uv) const;
+    // the whole image
+    SpriteSource GetSpriteSource(u32 region) const;
+    // one of the rects added to the builder along with the image, in the order they were added
+    SpriteSource GetSpriteSource(u32 region, u32 rect) const;
+
+    u32 GetPageCount() const { return (u32)m_Pages.size(); }
+    u32 GetRegionCount() const { return (u32)m_Regions.size(); }
+
+    // drawcalls the draw list would have needed on top if every region was still a texture of its own,
+    // texture switches only, ignoring batches split by the backend batch size
+    u32 CountDrawcallsSaved(const SpriteDrawList& drawList) const;
+
+private:
+    friend class TextureAtlasBuilder;
+
+    struct Region
+    {
+        u32 page;
+        math::AABB uv;
+        // on the page already
+        std::vector<math::AABB> rects;
+        // where the region is in the uv rect table of the page, its rects follow it. NO_UV_RECT if the table was full
+        u16 firstUVRect;
+    };
+
+    TextureAtlas() = default;
+
+    // the region of the page the uv comes from, searching from the given region first since sprites tend to repeat
+    u32 FindRegion(u32 page, const math::AABB& uv, u32 hintRegion) const;
+
+    std::vector<TextureOwner> m_Pages;
+    std::vector<Region> m_Regions;
+};
+
+/*
+ * Collects images and packs them into the pages of a TextureAtlas, tallest images first.
+ * Each image is a region, identified by the index returned when it's added.
+ */
+class TextureAtlasBuilder : private NonCopyable
+{
+public:
+    explicit TextureAtlasBuilder(TextureAtlasConfig config = TextureAtlasConfig());
+
+    u32 AddImage(Image image);
+    u32 AddImageFile(const std::filesystem::path& absolutePath);
+    // parts of the image sprites get drawn from, like the tiles of a tileset, in uvs relative to the image
+    void AddImageRects(u32 image, std::vector<math::AABB> uvs);
+
+    // creates the page textures along with their uv rect tables, the builder is left empty
+    std::unique_ptr<TextureAtlas> Build(IRenderContext& render);
+
+private:
+    TextureAtlasConfig m_Config;
+    std::vector<Image> m_Images;
+    std::vector<std::vector<math::AABB>> m_ImageRects;
+};
+
+}
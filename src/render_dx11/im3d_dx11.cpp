@@ -123,12 +123,8 @@ Im3dDx11::Im3dDx11(ComPtr<ID3D11Device> device, ComPtr<ID3D11DeviceContext> cont
         D3D11_CPU_ACCESS_WRITE);
 }
 
-void Im3dDx11::Render(const ICamera& camera, u32 viewportWidth, u32 viewportHeight)
+void Im3dDx11::Render(const ICamera& camera, const Im3d::DrawList* drawLists, u32 drawListCount, u32 viewportWidth, u32 viewportHeight)
 {
-    Im3d::EndFrame();
-
-    Im3d::AppData& ad = Im3d::GetAppData();
-
     D3D11_VIEWPORT viewport = {
         0.0f, 0.0f,                                             // TopLeftX, TopLeftY
         (float)viewportWidth, (float)viewportHeight, 0.0f, 1.0f // MinDepth, MaxDepth
@@ -138,9 +134,9 @@ void Im3dDx11::Render(const ICamera& camera, u32 viewportWidth, u32 viewportHeig
     m_Context->OMSetDepthStencilState(m_DepthStencilState.Get(), 0);
     m_Context->RSSetState(m_RasterizerState.Get());
 
-    for (u32 i = 0, n = Im3d::GetDrawListCount(); i < n; ++i)
+    for (u32 i = 0; i < drawListCount; ++i)
     {
-        auto& drawList = Im3d::GetDrawLists()[i];
+        auto& drawList = drawLists[i];
 
         struct Layout
         {
@@ -149,7 +145,8 @@ void Im3dDx11::Render(const ICamera& camera, u32 viewportWidth, u32 viewportHeig
         };
         Layout layout;
         layout.viewProj = camera.GetViewProjection();
-        layout.viewport = ad.m_viewportSize;
+        // not the viewport size of the app data, the game thread may be on the next frame already
+        layout.viewport = Im3d::Vec2((float)viewportWidth, (float)viewportHeight);
         UpdateBuffer(m_Context.Get(), m_ConstantBuffer.Get(), layout);
 
         if (!m_VertexBuffer.Get() || m_VertexBufferSize < drawList.m_vertexCount)
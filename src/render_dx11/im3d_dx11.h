@@ -10,7 +10,7 @@ class Im3dDx11
 public:
     Im3dDx11(ComPtr<ID3D11Device> device, ComPtr<ID3D11DeviceContext> context);
 
-    void Render(const ICamera& camera, u32 viewportWidth, u32 viewportHeight);
+    void Render(const ICamera& camera, const Im3d::DrawList* drawLists, u32 drawListCount, u32 viewportWidth, u32 viewportHeight);
 
 private:
     struct ShaderSet
@@ -12,16 +12,35 @@
 namespace cgt::render
 {
 
-struct SpriteInstanceData
-{
-    glm::vec4 colorTint;
-    glm::vec2 position;
-    glm::vec2 uvMin;
-    glm::vec2 uvMax;
-    glm::vec2 scale;
-    float rotation;
+namespace
+{
+
+// all of the sprites in one immutable instance buffer, the draws offset into it with the start instance
+class StaticSpriteBatchDX11 : public StaticSpriteBatch
+{
+public:
+    StaticSpriteBatchDX11(ID3D11Device* device, const SpriteDrawList& drawList)
+    {
+        std::vector<SpriteDrawRequest> sortedSprites;
+        SortAndSplit(drawList, sortedSprites);
+        if (sortedSprites.empty())
+        {
+            return;
+        }
+
+        std::vector<SpriteInstanceData> instances(sortedSprites.size());
+        EncodeSpriteInstances(sortedSprites.data(), sortedSprites.size(), instances.data());
+
+        instanceData = CreateStaticBuffer(device, instances, D3D11_BIND_VERTEX_BUFFER);
+        DirectX::SetDebugObjectName(instanceData.Get(), "Static Sprite Instance Data");
+    }
+
+    // null for empty batches
+    ComPtr<ID3D11Buffer> instanceData;
 };
 
+}
+
 std::shared_ptr<IRenderContext> IRenderContext::BuildWithConfig(RenderConfig config)
 {
     return RenderContextDX11::BuildWithConfig(std::move(config));
@@ -54,49 +73,46 @@ std::shared_ptr<RenderContextDX11> RenderContextDX11::BuildWithConfig(RenderConf
     CGT_CHECK_HRESULT(hresult, "Failed to create a stub missing texture!");
 
     context->m_CommonStates = std::make_unique<DirectX::CommonStates>(context->m_Device.Get());
+    context->m_SpriteCulling = config.UseSpriteCulling();
 
-    ComPtr<IDXGIDevice> dxgiDevice;
-    hresult = context->m_Device->QueryInterface(__uuidof(IDXGIDevice), (void**)dxgiDevice.GetAddressOf());
-    CGT_CHECK_HRESULT(hresult, "Couldn't query for IDXGIDevice!");
-
-    ComPtr<IDXGIAdapter> dxgiAdapter;
-    hresult = dxgiDevice->GetParent(__uuidof(IDXGIAdapter), (void**)dxgiAdapter.GetAddressOf());
-    CGT_CHECK_HRESULT(hresult, "Couldn't query for IDXGIAdapter!");
-
-    ComPtr<IDXGIFactory> dxgiFactory;
-    hresult = dxgiAdapter->GetParent(__uuidof(IDXGIFactory), (void**)dxgiFactory.GetAddressOf());
-    CGT_CHECK_HRESULT(hresult, "Couldn't query for IDXGIFactory!");
-
-    SDL_SysWMinfo wmInfo;
-    SDL_VERSION(&wmInfo.version);
-    SDL_GetWindowWMInfo(context->m_Window->GetSDLWindow(), &wmInfo);
-    HWND hwnd = wmInfo.info.win.window;
-
-    DXGI_MODE_DESC modeDesc {};
-    modeDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-    modeDesc.Width = context->m_Window->GetWidth();
-    modeDesc.Height = context->m_Window->GetHeight();
-    modeDesc.RefreshRate.Numerator = 60;
-    modeDesc.RefreshRate.Denominator = 1;
-
-    DXGI_SWAP_CHAIN_DESC swapDesc {};
-    swapDesc.BufferDesc = modeDesc;
-    swapDesc.SampleDesc = DXGI_SAMPLE_DESC { 1, 0 };
-    swapDesc.SwapEffect = DXGI_SWAP_EFFECT_DISCARD;
-    swapDesc.Windowed = true;
-    swapDesc.OutputWindow = hwnd;
-    swapDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
-    swapDesc.BufferCount = 1;
-
-    hresult = dxgiFactory->CreateSwapChain(context->m_Device.Get(), &swapDesc, context->m_Swapchain.GetAddressOf());
-    CGT_CHECK_HRESULT(hresult, "Failed to create a swapchain!");
-
-    ComPtr<ID3D11Texture2D> backBuffer;
-    hresult = context->m_Swapchain->GetBuffer(0, __uuidof(ID3D11Texture2D), (void**)backBuffer.GetAddressOf());
-    CGT_CHECK_HRESULT(hresult, "Failed to get swapchain back buffer!");
+    if (config.GetFrameDumps())
+    {
+        context->m_FrameDumper = std::make_unique<FrameDumper>(*config.GetFrameDumps());
+    }
 
-    hresult = context->m_Device->CreateRenderTargetView(backBuffer.Get(), nullptr, context->m_RTView.GetAddressOf());
-    CGT_CHECK_HRESULT(hresult, "Failed to create render target view!");
+    // headless windows have nothing to present to
+    if (config.IsOffscreen() || context->m_Window->IsHeadless())
+    {
+        D3D11_TEXTURE2D_DESC targetDesc {};
+        targetDesc.Width = context->m_Window->GetWidth();
+        targetDesc.Height = context->m_Window->GetHeight();
+        targetDesc.MipLevels = 1;
+        targetDesc.ArraySize = 1;
+        targetDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        targetDesc.SampleDesc = DXGI_SAMPLE_DESC { 1, 0 };
+        targetDesc.Usage = D3D11_USAGE_DEFAULT;
+        targetDesc.BindFlags = D3D11_BIND_RENDER_TARGET;
+
+        hresult = context->m_Device->CreateTexture2D(&targetDesc, nullptr, context->m_OffscreenTarget.GetAddressOf());
+        CGT_CHECK_HRESULT(hresult, "Failed to create the offscreen render target!");
+        DirectX::SetDebugObjectName(context->m_OffscreenTarget.Get(), "Offscreen Target");
+
+        D3D11_TEXTURE2D_DESC readbackDesc = targetDesc;
+        readbackDesc.Usage = D3D11_USAGE_STAGING;
+        readbackDesc.BindFlags = 0;
+        readbackDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+
+        hresult = context->m_Device->CreateTexture2D(&readbackDesc, nullptr, context->m_OffscreenReadback.GetAddressOf());
+        CGT_CHECK_HRESULT(hresult, "Failed to create the offscreen readback texture!");
+        DirectX::SetDebugObjectName(context->m_OffscreenReadback.Get(), "Offscreen Readback");
+
+        hresult = context->m_Device->CreateRenderTargetView(context->m_OffscreenTarget.Get(), nullptr, context->m_RTView.GetAddressOf());
+        CGT_CHECK_HRESULT(hresult, "Failed to create render target view!");
+    }
+    else
+    {
+        context->CreateSwapchain();
+    }
 
     ComPtr<ID3D10Blob> vertexShaderBlob = CompileShader(
         AssetPath("engine/shaders/dx11/sprites.hlsl"),
@@ -147,6 +163,61 @@ std::shared_ptr<RenderContextDX11> RenderContextDX11::BuildWithConfig(RenderConf
     CGT_CHECK_HRESULT(hresult, "Failed to create shader input layout!");
     DirectX::SetDebugObjectName(context->m_InputLayout.Get(), "Sprite VS Input Layout");
 
+    if (config.UseCompactSpriteInstances())
+    {
+        ComPtr<ID3D10Blob> compactVertexShaderBlob = CompileShader(
+            AssetPath("engine/shaders/dx11/sprites.hlsl"),
+            "VSMainCompact",
+            "vs_4_0",
+            nullptr);
+        hresult = context->m_Device->CreateVertexShader(
+            compactVertexShaderBlob->GetBufferPointer(),
+            compactVertexShaderBlob->GetBufferSize(),
+            nullptr,
+            context->m_CompactVertexShader.GetAddressOf());
+        CGT_CHECK_HRESULT(hresult, "Failed to create compact vertex shader from bytecode!");
+        DirectX::SetDebugObjectName(context->m_CompactVertexShader.Get(), "Sprite Compact VS");
+
+        const D3D11_INPUT_ELEMENT_DESC compactInputElementDesc[] =
+            {
+                // per-vertex
+                { "QUAD_POSITION", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+                { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 1, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+                // per-instance
+                { "COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 2, offsetof(CompactSpriteInstanceData, colorTint), D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+                { "SPRITE_POSITION", 0, DXGI_FORMAT_R16G16_SINT, 2, offsetof(CompactSpriteInstanceData, position), D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+                { "SCALE", 0, DXGI_FORMAT_R16G16_FLOAT, 2, offsetof(CompactSpriteInstanceData, scale), D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+                { "ROTATION_UV_RECT", 0, DXGI_FORMAT_R16G16_UINT, 2, offsetof(CompactSpriteInstanceData, rotation), D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+            };
+
+        hresult = context->m_Device->CreateInputLayout(
+            compactInputElementDesc,
+            SDL_arraysize(compactInputElementDesc),
+            compactVertexShaderBlob->GetBufferPointer(),
+            compactVertexShaderBlob->GetBufferSize(),
+            context->m_CompactInputLayout.GetAddressOf());
+        CGT_CHECK_HRESULT(hresult, "Failed to create compact shader input layout!");
+        DirectX::SetDebugObjectName(context->m_CompactInputLayout.Get(), "Sprite Compact VS Input Layout");
+
+        context->m_CompactSpriteInstanceData = CreateBuffer(
+            context->m_Device.Get(),
+            nullptr,
+            sizeof(CompactSpriteInstanceData) * MAX_BATCH_SIZE,
+            D3D11_BIND_VERTEX_BUFFER,
+            D3D11_USAGE_DYNAMIC,
+            D3D11_CPU_ACCESS_WRITE);
+        DirectX::SetDebugObjectName(context->m_CompactSpriteInstanceData.Get(), "Compact Sprite Instance Data");
+
+        context->m_CompactBatchConstants = CreateBuffer(
+            context->m_Device.Get(),
+            nullptr,
+            sizeof(CompactSpriteBatchConstants),
+            D3D11_BIND_CONSTANT_BUFFER,
+            D3D11_USAGE_DYNAMIC,
+            D3D11_CPU_ACCESS_WRITE);
+        DirectX::SetDebugObjectName(context->m_CompactBatchConstants.Get(), "Compact Batch Constants");
+    }
+
     const float quadVertices[] =
         {
             -0.5f, 0.5f,
@@ -209,10 +280,63 @@ std::shared_ptr<RenderContextDX11> RenderContextDX11::BuildWithConfig(RenderConf
     return context;
 }
 
+void RenderContextDX11::CreateSwapchain()
+{
+    HRESULT hresult;
+
+    ComPtr<IDXGIDevice> dxgiDevice;
+    hresult = m_Device->QueryInterface(__uuidof(IDXGIDevice), (void**)dxgiDevice.GetAddressOf());
+    CGT_CHECK_HRESULT(hresult, "Couldn't query for IDXGIDevice!");
+
+    ComPtr<IDXGIAdapter> dxgiAdapter;
+    hresult = dxgiDevice->GetParent(__uuidof(IDXGIAdapter), (void**)dxgiAdapter.GetAddressOf());
+    CGT_CHECK_HRESULT(hresult, "Couldn't query for IDXGIAdapter!");
+
+    ComPtr<IDXGIFactory> dxgiFactory;
+    hresult = dxgiAdapter->GetParent(__uuidof(IDXGIFactory), (void**)dxgiFactory.GetAddressOf());
+    CGT_CHECK_HRESULT(hresult, "Couldn't query for IDXGIFactory!");
+
+    SDL_SysWMinfo wmInfo;
+    SDL_VERSION(&wmInfo.version);
+    SDL_GetWindowWMInfo(m_Window->GetSDLWindow(), &wmInfo);
+    HWND hwnd = wmInfo.info.win.window;
+
+    DXGI_MODE_DESC modeDesc {};
+    modeDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    modeDesc.Width = m_Window->GetWidth();
+    modeDesc.Height = m_Window->GetHeight();
+    modeDesc.RefreshRate.Numerator = 60;
+    modeDesc.RefreshRate.Denominator = 1;
+
+    DXGI_SWAP_CHAIN_DESC swapDesc {};
+    swapDesc.BufferDesc = modeDesc;
+    swapDesc.SampleDesc = DXGI_SAMPLE_DESC { 1, 0 };
+    swapDesc.SwapEffect = DXGI_SWAP_EFFECT_DISCARD;
+    swapDesc.Windowed = true;
+    swapDesc.OutputWindow = hwnd;
+    swapDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+    swapDesc.BufferCount = 1;
+
+    hresult = dxgiFactory->CreateSwapChain(m_Device.Get(), &swapDesc, m_Swapchain.GetAddressOf());
+    CGT_CHECK_HRESULT(hresult, "Failed to create a swapchain!");
+
+    ComPtr<ID3D11Texture2D> backBuffer;
+    hresult = m_Swapchain->GetBuffer(0, __uuidof(ID3D11Texture2D), (void**)backBuffer.GetAddressOf());
+    CGT_CHECK_HRESULT(hresult, "Failed to get swapchain back buffer!");
+
+    hresult = m_Device->CreateRenderTargetView(backBuffer.Get(), nullptr, m_RTView.GetAddressOf());
+    CGT_CHECK_HRESULT(hresult, "Failed to create render target view!");
+}
+
 void RenderContextDX11::Clear(glm::vec4 clearColor)
 {
     ZoneScoped;
 
+    if (m_FrameDumper)
+    {
+        m_FrameDumper->BeginFrame();
+    }
+
     SetUpRenderTarget();
     m_Context->ClearRenderTargetView(m_RTView.Get(), &clearColor.x);
 }
@@ -221,100 +345,219 @@ RenderStats RenderContextDX11::Submit(SpriteDrawList& drawList, const ICamera& c
 {
     ZoneScoped;
 
+    Clock submitClock;
     RenderStats stats {};
-    {
-        ZoneScopedN("Setup");
-        stats.spriteCount = drawList.size();
+    const glm::mat4 viewProjection = camera.GetViewProjection();
+    BindSpritePipeline(viewProjection, stats);
 
-        SetUpRenderTarget();
+    const SpriteDrawList& sprites = PrepareSpritesForSubmit(drawList, viewProjection, m_SpriteCulling, sortBeforeRendering, m_VisibleSprites, stats);
+    DrawSprites(sprites, 0, sprites.size(), stats);
 
-        m_Context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-        m_Context->IASetIndexBuffer(m_QuadIndices.Get(), DXGI_FORMAT_R16_UINT, 0);
-        m_Context->IASetInputLayout(m_InputLayout.Get());
+    stats.submitTime = submitClock.Tick();
+    return stats;
+}
 
-        const UINT strides[] =
-            {
-                sizeof(glm::vec2), // POSITION
-                sizeof(glm::vec2), // TEXCOORD
-                sizeof(SpriteInstanceData),
-            };
-        const UINT offsets[] = { 0, 0, 0, };
-        ID3D11Buffer* buffers[] =
-            {
-                m_QuadVertices.Get(),
-                m_QuadUV.Get(),
-                m_SpriteInstanceData.Get(),
-            };
-        m_Context->IASetVertexBuffers(0, SDL_arraysize(buffers), buffers, strides, offsets);
+std::unique_ptr<StaticSpriteBatch> RenderContextDX11::CreateStaticBatch(const SpriteDrawList& drawList)
+{
+    ZoneScoped;
 
-        m_Context->GSSetShader(nullptr, nullptr, 0);
+    return std::make_unique<StaticSpriteBatchDX11>(m_Device.Get(), drawList);
+}
 
-        m_Context->VSSetShader(m_VertexShader.Get(), nullptr, 0);
-        glm::mat4 viewProjection = camera.GetViewProjection();
-        UpdateBuffer(m_Context.Get(), m_FrameConstants.Get(), viewProjection);
-        m_Context->VSSetConstantBuffers(0, 1, m_FrameConstants.GetAddressOf());
+RenderStats RenderContextDX11::SubmitStaticBatch(const StaticSpriteBatch& batch, const ICamera& camera)
+{
+    ZoneScoped;
 
-        m_Context->PSSetShader(m_PixelShader.Get(), nullptr, 0);
-        ID3D11SamplerState* sampler = m_CommonStates->PointClamp();
-        m_Context->PSSetSamplers(0, 1, &sampler);
+    Clock submitClock;
+    RenderStats stats {};
+    const glm::mat4 viewProjection = camera.GetViewProjection();
 
-        m_Context->OMSetBlendState(m_CommonStates->NonPremultiplied(), nullptr, 0xFFFFFFFF);
-        m_Context->OMSetDepthStencilState(m_CommonStates->DepthNone(), 0);
+    Clock cullClock;
+    m_StaticDraws.clear();
+    const u32 visibleCount = batch.CollectVisibleDraws(ComputeViewBounds(viewProjection), m_StaticDraws);
+    stats.cullTime = cullClock.Tick();
+    stats.spriteCount = batch.GetSpriteCount();
+    stats.culledSpriteCount = stats.spriteCount - visibleCount;
+    stats.staticSpriteCount = visibleCount;
+
+    if (!m_StaticDraws.empty())
+    {
+        BindSpritePipeline(viewProjection, stats);
     }
 
-    if (sortBeforeRendering)
+    for (const StaticSpriteBatch::Draw& draw : m_StaticDraws)
     {
-        drawList.SortForRendering(*this);
+        DrawStatic(batch, draw.texture, draw.firstSprite, draw.spriteCount, stats);
     }
 
-    auto GetSpriteTexture = [this](const SpriteDrawRequest& sprite)
+    stats.submitTime = submitClock.Tick();
+    return stats;
+}
+
+RenderStats RenderContextDX11::SubmitFrame(const SpriteFrame& frame, const ICamera& camera)
+{
+    ZoneScoped;
+
+    Clock submitClock;
+    RenderStats stats {};
+    const glm::mat4 viewProjection = camera.GetViewProjection();
+    BindSpritePipeline(viewProjection, stats);
+
+    PrepareFrameForSubmit(frame, viewProjection, m_SpriteCulling, m_PreparedFrame, stats);
+    for (const SpriteFramePart& part : m_PreparedFrame.parts)
     {
-        return sprite.src.texture.get() != nullptr
-            ? sprite.src.texture->m_View.Get()
-            : m_MissingTexture.m_View.Get();
-    };
+        if (part.staticBatch)
+        {
+            DrawStatic(*part.staticBatch, part.texture, part.firstSprite, part.spriteCount, stats);
+        }
+        else
+        {
+            DrawSprites(m_PreparedFrame.sprites, part.firstSprite, part.firstSprite + part.spriteCount, stats);
+        }
+    }
+
+    stats.submitTime = submitClock.Tick();
+    return stats;
+}
 
-    for (usize spriteIdx = 0; spriteIdx < drawList.size();)
+void RenderContextDX11::DrawSprites(const SpriteDrawList& sprites, usize begin, usize end, RenderStats& outStats)
+{
+    // every phase of a batch ends with a tick of the clock
+    Clock phaseClock;
+    for (usize spriteIdx = begin; spriteIdx < end;)
     {
         ZoneScopedN("Drawcall");
 
-        auto* currentTexture = GetSpriteTexture(drawList[spriteIdx]);
-        m_Context->PSSetShaderResources(0, 1, &currentTexture);
+        const TextureHandle currentTexture = sprites[spriteIdx].src.texture;
+        auto* currentTextureView = GetTextureView(currentTexture);
+        m_Context->PSSetShaderResources(0, 1, &currentTextureView);
+        const TextureData* currentTextureData = m_Textures.Get(currentTexture);
+        const u32 uvRectCount = currentTextureData ? currentTextureData->uvRectCount : 0;
 
-        D3D11_MAPPED_SUBRESOURCE spriteInstanceSubres {};
-        m_Context->Map(m_SpriteInstanceData.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &spriteInstanceSubres);
-        auto* spriteInstanceBuff = (SpriteInstanceData*)spriteInstanceSubres.pData;
+        const usize batchEnd = FindSpriteBatchEnd(sprites, spriteIdx, glm::min(MAX_BATCH_SIZE, end - spriteIdx));
+        const usize spritesInBatch = batchEnd - spriteIdx;
+        const SpriteDrawRequest* batchSprites = sprites.data() + spriteIdx;
+        outStats.AddBatch(spritesInBatch, GetSpriteBatchCut(sprites, batchEnd, end));
+        spriteIdx = batchEnd;
 
-        usize spritesInBatch = 0;
-        do
+        const bool compactBatch = m_CompactVertexShader && m_CompactEncoder.Prepare(batchSprites, spritesInBatch, uvRectCount);
+        if (compactBatch)
         {
-            auto& sprite = drawList[spriteIdx];
-            auto* texture = GetSpriteTexture(sprite);
-            if (texture != currentTexture)
-            {
-                break;
-            }
+            BindInstanceBuffer(m_CompactSpriteInstanceData.Get(), true);
+            outStats.drawTime += phaseClock.Tick();
+
+            D3D11_MAPPED_SUBRESOURCE instanceSubres {};
+            D3D11_MAPPED_SUBRESOURCE constantsSubres {};
+            m_Context->Map(m_CompactSpriteInstanceData.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &instanceSubres);
+            m_Context->Map(m_CompactBatchConstants.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &constantsSubres);
+            outStats.uploadTime += phaseClock.Tick();
+
+            m_CompactEncoder.Encode((CompactSpriteInstanceData*)instanceSubres.pData, *(CompactSpriteBatchConstants*)constantsSubres.pData);
+            outStats.encodeTime += phaseClock.Tick();
+
+            m_Context->Unmap(m_CompactBatchConstants.Get(), 0);
+            m_Context->Unmap(m_CompactSpriteInstanceData.Get(), 0);
+            outStats.uploadTime += phaseClock.Tick();
+            outStats.uploadedBytes += m_CompactEncoder.GetEncodedSize();
+
+            m_Context->VSSetConstantBuffers(1, 1, m_CompactBatchConstants.GetAddressOf());
+            m_Context->VSSetConstantBuffers(2, 1, currentTextureData->uvRects.GetAddressOf());
+        }
+        else
+        {
+            BindInstanceBuffer(m_SpriteInstanceData.Get(), false);
+            outStats.drawTime += phaseClock.Tick();
 
-            auto& spriteInstance = spriteInstanceBuff[spritesInBatch];
-            spriteInstance.colorTint = sprite.colorTint;
-            spriteInstance.position = sprite.position;
-            spriteInstance.uvMin = sprite.src.uv.min;
-            spriteInstance.uvMax = sprite.src.uv.max;
-            spriteInstance.scale = sprite.scale;
-            spriteInstance.rotation = glm::radians(sprite.rotation - sprite.src.baseRotation);
+            D3D11_MAPPED_SUBRESOURCE spriteInstanceSubres {};
+            m_Context->Map(m_SpriteInstanceData.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &spriteInstanceSubres);
+            outStats.uploadTime += phaseClock.Tick();
 
-            ++spriteIdx;
-            ++spritesInBatch;
-        } while (spritesInBatch < MAX_BATCH_SIZE && spriteIdx < drawList.size());
+            EncodeSpriteInstances(batchSprites, spritesInBatch, (SpriteInstanceData*)spriteInstanceSubres.pData);
+            outStats.encodeTime += phaseClock.Tick();
 
-        m_Context->Unmap(m_SpriteInstanceData.Get(), 0);
+            m_Context->Unmap(m_SpriteInstanceData.Get(), 0);
+            outStats.uploadTime += phaseClock.Tick();
+            outStats.uploadedBytes += spritesInBatch * sizeof(SpriteInstanceData);
+        }
 
-        ++stats.drawcallCount;
+        ++outStats.drawcallCount;
         m_Context->DrawIndexedInstanced(6, spritesInBatch, 0, 0, 0);
+        outStats.drawTime += phaseClock.Tick();
     }
+}
 
+void RenderContextDX11::DrawStatic(const StaticSpriteBatch& batch, TextureHandle texture, u32 firstSprite, u32 spriteCount, RenderStats& outStats)
+{
+    ZoneScopedN("Drawcall");
 
-    return stats;
+    Clock drawClock;
+    BindInstanceBuffer(static_cast<const StaticSpriteBatchDX11&>(batch).instanceData.Get(), false);
+
+    auto* textureView = GetTextureView(texture);
+    m_Context->PSSetShaderResources(0, 1, &textureView);
+
+    ++outStats.drawcallCount;
+    m_Context->DrawIndexedInstanced(6, spriteCount, 0, 0, firstSprite);
+    outStats.drawTime += drawClock.Tick();
+}
+
+void RenderContextDX11::BindInstanceBuffer(ID3D11Buffer* instanceData, bool compact)
+{
+    if (instanceData == m_BoundInstanceData)
+    {
+        return;
+    }
+
+    // the compact buffer is the only one in the compact format, so the shader and the layout only change along with the buffer
+    m_BoundInstanceData = instanceData;
+    const UINT stride = compact ? sizeof(CompactSpriteInstanceData) : sizeof(SpriteInstanceData);
+    const UINT offset = 0;
+    m_Context->IASetVertexBuffers(2, 1, &instanceData, &stride, &offset);
+    m_Context->IASetInputLayout(compact ? m_CompactInputLayout.Get() : m_InputLayout.Get());
+    m_Context->VSSetShader(compact ? m_CompactVertexShader.Get() : m_VertexShader.Get(), nullptr, 0);
+}
+
+void RenderContextDX11::BindSpritePipeline(const glm::mat4& viewProjection, RenderStats& outStats)
+{
+    ZoneScoped;
+
+    Clock bindClock;
+    SetUpRenderTarget();
+
+    m_Context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    m_Context->IASetIndexBuffer(m_QuadIndices.Get(), DXGI_FORMAT_R16_UINT, 0);
+    m_Context->IASetInputLayout(m_InputLayout.Get());
+
+    const UINT strides[] =
+        {
+            sizeof(glm::vec2), // POSITION
+            sizeof(glm::vec2), // TEXCOORD
+            sizeof(SpriteInstanceData),
+        };
+    const UINT offsets[] = { 0, 0, 0, };
+    ID3D11Buffer* buffers[] =
+        {
+            m_QuadVertices.Get(),
+            m_QuadUV.Get(),
+            m_SpriteInstanceData.Get(),
+        };
+    m_Context->IASetVertexBuffers(0, SDL_arraysize(buffers), buffers, strides, offsets);
+    m_BoundInstanceData = m_SpriteInstanceData.Get();
+
+    m_Context->GSSetShader(nullptr, nullptr, 0);
+
+    m_Context->VSSetShader(m_VertexShader.Get(), nullptr, 0);
+    UpdateBuffer(m_Context.Get(), m_FrameConstants.Get(), viewProjection);
+    m_Context->VSSetConstantBuffers(0, 1, m_FrameConstants.GetAddressOf());
+
+    m_Context->PSSetShader(m_PixelShader.Get(), nullptr, 0);
+    ID3D11SamplerState* sampler = m_CommonStates->PointClamp();
+    m_Context->PSSetSamplers(0, 1, &sampler);
+
+    m_Context->OMSetBlendState(m_CommonStates->NonPremultiplied(), nullptr, 0xFFFFFFFF);
+    m_Context->OMSetDepthStencilState(m_CommonStates->DepthNone(), 0);
+
+    outStats.drawTime += bindClock.Tick();
 }
 
 void RenderContextDX11::SetUpRenderTarget()
@@ -338,12 +581,58 @@ void RenderContextDX11::Present()
 {
     {
         ZoneScoped;
-        m_Swapchain->Present(0, 0);
+
+        if (m_FrameDumper)
+        {
+            m_FrameDumper->EndFrame(*this);
+        }
+
+        if (m_Swapchain)
+        {
+            m_Swapchain->Present(0, 0);
+        }
     }
 
     FrameMark; // notify Tracy Profiler that the frame was rendered
 }
 
+bool RenderContextDX11::ReadFrame(Image& outImage)
+{
+    ZoneScoped;
+
+    if (!m_OffscreenTarget)
+    {
+        return false;
+    }
+
+    // stalls until the GPU is done with the frame
+    m_Context->CopyResource(m_OffscreenReadback.Get(), m_OffscreenTarget.Get());
+
+    D3D11_MAPPED_SUBRESOURCE readbackSubres {};
+    HRESULT hresult = m_Context->Map(m_OffscreenReadback.Get(), 0, D3D11_MAP_READ, 0, &readbackSubres);
+    if (FAILED(hresult))
+    {
+        return false;
+    }
+
+    D3D11_TEXTURE2D_DESC desc {};
+    m_OffscreenReadback->GetDesc(&desc);
+
+    // R8G8B8A8_UNORM has the same byte order as the RGBA8 pixels, only the row pitch may differ
+    outImage.width = desc.Width;
+    outImage.height = desc.Height;
+    outImage.pixels.resize((usize)desc.Width * desc.Height);
+    for (u32 y = 0; y < desc.Height; ++y)
+    {
+        const u8* row = (const u8*)readbackSubres.pData + (usize)y * readbackSubres.RowPitch;
+        std::memcpy(outImage.pixels.data() + (usize)y * desc.Width, row, desc.Width * sizeof(u32));
+    }
+
+    m_Context->Unmap(m_OffscreenReadback.Get(), 0);
+
+    return true;
+}
+
 void RenderContextDX11::ImGuiBindingsInit()
 {
     ImGui_ImplDX11_Init(m_Device.Get(), m_Context.Get());
@@ -372,9 +661,9 @@ void RenderContextDX11::Im3dBindingsInit()
 
 void RenderContextDX11::Im3dBindingsNewFrame() {}
 
-void RenderContextDX11::Im3dBindingsRender(const ICamera& camera)
+void RenderContextDX11::Im3dBindingsRender(const ICamera& camera, const Im3d::DrawList* drawLists, u32 drawListCount)
 {
-    m_Im3dRender->Render(camera, m_Window->GetWidth(), m_Window->GetHeight());
+    m_Im3dRender->Render(camera, drawLists, drawListCount, m_Window->GetWidth(), m_Window->GetHeight());
 }
 
 void RenderContextDX11::Im3dBindingsShutdown()
@@ -387,14 +676,46 @@ RenderContextDX11::RenderContextDX11(std::shared_ptr<Window> window)
 {
 }
 
-TextureHandle RenderContextDX11::LoadTexture(const std::filesystem::path& absolutePath)
+TextureOwner RenderContextDX11::LoadTexture(const std::filesystem::path& absolutePath)
 {
     auto fileData = LoadFileBytes(absolutePath);
-    auto newTexture = std::shared_ptr<TextureData>(new TextureData());
-    HRESULT hresult = LoadTextureFromMemory(fileData.data(), fileData.size(), *newTexture);
+    TextureData newTexture;
+    HRESULT hresult = LoadTextureFromMemory(fileData.data(), fileData.size(), newTexture);
     CGT_CHECK_HRESULT(hresult, "Couldn't create texture from file at {}", absolutePath);
 
-    return newTexture;
+    return std::make_shared<Texture>(*this, m_Textures.Add(std::move(newTexture)));
+}
+
+TextureOwner RenderContextDX11::CreateTexture(const Image& image)
+{
+    D3D11_TEXTURE2D_DESC desc {};
+    desc.Width = image.width;
+    desc.Height = image.height;
+    desc.MipLevels = 1;
+    desc.ArraySize = 1;
+    desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    desc.SampleDesc = DXGI_SAMPLE_DESC { 1, 0 };
+    desc.Usage = D3D11_USAGE_IMMUTABLE;
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+    D3D11_SUBRESOURCE_DATA initialData {};
+    initialData.pSysMem = image.pixels.data();
+    initialData.SysMemPitch = image.width * sizeof(u32);
+
+    ComPtr<ID3D11Texture2D> texture;
+    HRESULT hresult = m_Device->CreateTexture2D(&desc, &initialData, texture.GetAddressOf());
+    CGT_CHECK_HRESULT(hresult, "Couldn't create a {}x{} texture", image.width, image.height);
+
+    TextureData newTexture;
+    hresult = m_Device->CreateShaderResourceView(texture.Get(), nullptr, newTexture.view.GetAddressOf());
+    CGT_CHECK_HRESULT(hresult, "Couldn't create a shader resource view for a {}x{} texture", image.width, image.height);
+
+    return std::make_shared<Texture>(*this, m_Textures.Add(std::move(newTexture)));
+}
+
+void RenderContextDX11::ReleaseTexture(TextureHandle texture)
+{
+    m_Textures.Remove(texture);
 }
 
 HRESULT RenderContextDX11::LoadTextureFromMemory(const u8* data, usize size, TextureData& outData)
@@ -405,20 +726,45 @@ HRESULT RenderContextDX11::LoadTextureFromMemory(const u8* data, usize size, Tex
         data,
         size,
         textureResource.GetAddressOf(),
-        outData.m_View.GetAddressOf());
+        outData.view.GetAddressOf());
 
     return hresult;
 }
 
-ImTextureID RenderContextDX11::GetImTextureID(const TextureHandle& texture)
+ImTextureID RenderContextDX11::GetImTextureID(TextureHandle texture)
 {
-    return texture->m_View.Get();
+    return GetTextureView(texture);
+}
+
+void RenderContextDX11::SetTextureUVRects(TextureHandle texture, const std::vector<math::AABB>& uvRects)
+{
+    ZoneScoped;
+
+    CGT_ASSERT(uvRects.size() <= SpriteSource::MAX_UV_RECTS);
+
+    TextureData* textureData = m_Textures.Get(texture);
+    CGT_ASSERT(textureData != nullptr);
+    if (!textureData || !m_CompactVertexShader)
+    {
+        return;
+    }
+
+    // always as big as the shader declares it, the rects past the count are never indexed
+    std::vector<glm::vec4> constants(SpriteSource::MAX_UV_RECTS, glm::vec4(0.0f));
+    for (usize i = 0; i < uvRects.size(); ++i)
+    {
+        constants[i] = glm::vec4(uvRects[i].min, uvRects[i].max);
+    }
+
+    textureData->uvRects = CreateStaticBuffer(m_Device.Get(), constants, D3D11_BIND_CONSTANT_BUFFER);
+    DirectX::SetDebugObjectName(textureData->uvRects.Get(), "Texture UV Rects");
+    textureData->uvRectCount = (u32)uvRects.size();
 }
 
-usize RenderContextDX11::GetTextureSortKey(const TextureHandle& texture)
+ID3D11ShaderResourceView* RenderContextDX11::GetTextureView(TextureHandle texture)
 {
-    usize uPtr = reinterpret_cast<usize>(texture.get() ? texture->m_View.Get() : 0);
-    return uPtr;
+    TextureData* textureData = m_Textures.Get(texture);
+    return textureData ? textureData->view.Get() : m_MissingTexture.view.Get();
 }
 
 }
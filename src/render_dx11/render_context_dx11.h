@@ -3,6 +3,9 @@
 #include <engine/window.h>
 #include <render_core/i_render_context.h>
 #include <render_core/i_camera.h>
+#include <render_core/sprite_instance_encoder.h>
+#include <render_core/sprite_culling.h>
+#include <render_core/sprite_frame.h>
 #include <DirectXTK/CommonStates.h>
 
 namespace cgt::render
@@ -10,14 +13,12 @@ namespace cgt::render
 
 class Im3dDx11;
 
-class TextureData : private NonCopyable
+struct TextureData
 {
-private:
-    friend class RenderContextDX11;
-
-    TextureData() = default;
-
-    ComPtr<ID3D11ShaderResourceView> m_View;
+    ComPtr<ID3D11ShaderResourceView> view;
+    // constant buffer with the uv rects compact batches index, null until they're set or without compact sprite instances
+    ComPtr<ID3D11Buffer> uvRects;
+    u32 uvRectCount = 0;
 };
 
 class RenderContextDX11 : public IRenderContext, private NonCopyable
@@ -25,15 +26,24 @@ class RenderContextDX11 : public IRenderContext, private NonCopyable
 public:
     static std::shared_ptr<RenderContextDX11> BuildWithConfig(RenderConfig config);
 
-    TextureHandle LoadTexture(const std::filesystem::path& absolutePath) override;
-    ImTextureID GetImTextureID(const TextureHandle& texture) override;
-    usize GetTextureSortKey(const TextureHandle& texture) override;
+    TextureOwner LoadTexture(const std::filesystem::path& absolutePath) override;
+    TextureOwner CreateTexture(const Image& image) override;
+    ImTextureID GetImTextureID(TextureHandle texture) override;
+    void SetTextureUVRects(TextureHandle texture, const std::vector<math::AABB>& uvRects) override;
 
     void Clear(glm::vec4 clearColor) override;
     RenderStats Submit(SpriteDrawList& drawList, const ICamera& camera, bool sortBeforeRendering = true) override;
+    std::unique_ptr<StaticSpriteBatch> CreateStaticBatch(const SpriteDrawList& drawList) override;
+    RenderStats SubmitStaticBatch(const StaticSpriteBatch& batch, const ICamera& camera) override;
+    RenderStats SubmitFrame(const SpriteFrame& frame, const ICamera& camera) override;
     void Present() override;
 
+    // offscreen only, the swapchain back buffer isn't readable
+    bool ReadFrame(Image& outImage) override;
+
 protected:
+    void ReleaseTexture(TextureHandle texture) override;
+
     void ImGuiBindingsInit() override;
     void ImGuiBindingsNewFrame() override;
     void ImGuiBindingsRender(ImDrawData* drawData) override;
@@ -41,7 +51,7 @@ protected:
 
     void Im3dBindingsInit() override;
     void Im3dBindingsNewFrame() override;
-    void Im3dBindingsRender(const ICamera& camera) override;
+    void Im3dBindingsRender(const ICamera& camera, const Im3d::DrawList* drawLists, u32 drawListCount) override;
     void Im3dBindingsShutdown() override;
 
 private:
@@ -49,14 +59,30 @@ private:
 
     explicit RenderContextDX11(std::shared_ptr<Window> window);
 
+    void CreateSwapchain();
     void SetUpRenderTarget();
+    // the sprite shaders and states, with the full instance format read from the dynamic instance buffer. Counts as draw time
+    void BindSpritePipeline(const glm::mat4& viewProjection, RenderStats& outStats);
+    // switches the instance buffer along with the shader and the layout of its format, only when it's a different buffer
+    void BindInstanceBuffer(ID3D11Buffer* instanceData, bool compact);
+
+    // encodes and draws the sorted sprites from begin to end in batches
+    void DrawSprites(const SpriteDrawList& sprites, usize begin, usize end, RenderStats& outStats);
+    void DrawStatic(const StaticSpriteBatch& batch, TextureHandle texture, u32 firstSprite, u32 spriteCount, RenderStats& outStats);
     HRESULT LoadTextureFromMemory(const u8* data, usize size, TextureData& outData);
 
+    // the missing texture for null and stale handles
+    ID3D11ShaderResourceView* GetTextureView(TextureHandle texture);
+
     std::shared_ptr<Window> m_Window;
+    std::unique_ptr<FrameDumper> m_FrameDumper;
 
     ComPtr<ID3D11Device> m_Device;
     ComPtr<ID3D11DeviceContext> m_Context;
+    // null when offscreen, rendering goes to the offscreen target instead
     ComPtr<IDXGISwapChain> m_Swapchain;
+    ComPtr<ID3D11Texture2D> m_OffscreenTarget;
+    ComPtr<ID3D11Texture2D> m_OffscreenReadback;
     ComPtr<ID3D11RenderTargetView> m_RTView;
 
     std::unique_ptr<DirectX::CommonStates> m_CommonStates;
@@ -71,7 +97,23 @@ private:
     ComPtr<ID3D11Buffer> m_QuadIndices;
 
     ComPtr<ID3D11Buffer> m_SpriteInstanceData;
-
+    // what's bound to the instance slot right now, not owned
+    ID3D11Buffer* m_BoundInstanceData = nullptr;
+
+    // null without compact sprite instances
+    ComPtr<ID3D11VertexShader> m_CompactVertexShader;
+    ComPtr<ID3D11InputLayout> m_CompactInputLayout;
+    ComPtr<ID3D11Buffer> m_CompactSpriteInstanceData;
+    ComPtr<ID3D11Buffer> m_CompactBatchConstants;
+    CompactSpriteEncoder m_CompactEncoder;
+
+    bool m_SpriteCulling = true;
+    // the visible sprites of the list being submitted
+    SpriteDrawList m_VisibleSprites;
+    std::vector<StaticSpriteBatch::Draw> m_StaticDraws;
+    PreparedSpriteFrame m_PreparedFrame;
+
+    TexturePool<TextureData> m_Textures;
     TextureData m_MissingTexture;
 
     std::unique_ptr<Im3dDx11> m_Im3dRender;
@@ -0,0 +1 @@
+#include <render_null/pch.h>
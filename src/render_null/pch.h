@@ -0,0 +1,4 @@
+#pragma once
+
+#include <engine/api.h>
+#include <render_core/api.h>
@@ -0,0 +1,296 @@
+#include <render_null/pch.h>
+
+#include <render_null/render_context_null.h>
+#include <render_core/cpu_static_sprite_batch.h>
+
+namespace cgt::render
+{
+
+namespace
+{
+
+// handles are small enough to go into the pointer sized texture ids of ImGui directly
+ImTextureID ToImTextureID(TextureHandle texture)
+{
+    return (ImTextureID)(uptr)(((u32)texture.generation << 16) | texture.index);
+}
+
+}
+
+std::shared_ptr<IRenderContext> IRenderContext::BuildWithConfig(RenderConfig config)
+{
+    return RenderContextNull::BuildWithConfig(std::move(config));
+}
+
+std::shared_ptr<RenderContextNull> RenderContextNull::BuildWithConfig(RenderConfig config)
+{
+    auto context = std::shared_ptr<RenderContextNull>(new RenderContextNull(config.GetSDLWindow()));
+    context->m_SpriteInstanceData.resize(MAX_BATCH_SIZE);
+    context->m_SpriteCulling = config.UseSpriteCulling();
+    if (config.UseCompactSpriteInstances())
+    {
+        context->m_CompactSpriteInstanceData.resize(MAX_BATCH_SIZE);
+    }
+    if (config.GetFrameDumps())
+    {
+        context->m_FrameDumper = std::make_unique<FrameDumper>(*config.GetFrameDumps());
+    }
+
+    return context;
+}
+
+RenderContextNull::RenderContextNull(std::shared_ptr<Window> window)
+    : m_Window(std::move(window))
+    , m_FrameConstants(1.0f)
+{
+}
+
+void RenderContextNull::Clear(glm::vec4 clearColor)
+{
+    if (m_FrameDumper)
+    {
+        m_FrameDumper->BeginFrame();
+    }
+}
+
+RenderStats RenderContextNull::Submit(SpriteDrawList& drawList, const ICamera& camera, bool sortBeforeRendering)
+{
+    ZoneScoped;
+
+    Clock submitClock;
+    RenderStats stats {};
+    m_FrameConstants = camera.GetViewProjection();
+
+    const SpriteDrawList& sprites = PrepareSpritesForSubmit(drawList, m_FrameConstants, m_SpriteCulling, sortBeforeRendering, m_VisibleSprites, stats);
+
+    EncodeSprites(sprites, 0, sprites.size(), stats);
+
+    m_Counters.spriteCount += stats.spriteCount;
+    m_Counters.culledSpriteCount += stats.culledSpriteCount;
+    m_Counters.batchCount += stats.drawcallCount;
+
+    stats.submitTime = submitClock.Tick();
+    return stats;
+}
+
+std::unique_ptr<StaticSpriteBatch> RenderContextNull::CreateStaticBatch(const SpriteDrawList& drawList)
+{
+    ZoneScoped;
+
+    auto batch = std::make_unique<CpuStaticSpriteBatch>(drawList);
+    m_Counters.instanceBytes += batch->GetInstances().size() * sizeof(SpriteInstanceData);
+
+    return batch;
+}
+
+RenderStats RenderContextNull::SubmitStaticBatch(const StaticSpriteBatch& batch, const ICamera& camera)
+{
+    ZoneScoped;
+
+    Clock submitClock;
+    RenderStats stats {};
+    m_FrameConstants = camera.GetViewProjection();
+
+    // a draw call for every visible run of ranges, nothing gets encoded
+    Clock cullClock;
+    m_StaticDraws.clear();
+    const u32 visibleCount = batch.CollectVisibleDraws(ComputeViewBounds(m_FrameConstants), m_StaticDraws);
+    stats.cullTime = cullClock.Tick();
+
+    stats.spriteCount = batch.GetSpriteCount();
+    stats.culledSpriteCount = stats.spriteCount - visibleCount;
+    stats.staticSpriteCount = visibleCount;
+    stats.drawcallCount = (u32)m_StaticDraws.size();
+
+    m_Counters.spriteCount += stats.spriteCount;
+    m_Counters.culledSpriteCount += stats.culledSpriteCount;
+    m_Counters.batchCount += stats.drawcallCount;
+
+    stats.submitTime = submitClock.Tick();
+    return stats;
+}
+
+RenderStats RenderContextNull::SubmitFrame(const SpriteFrame& frame, const ICamera& camera)
+{
+    ZoneScoped;
+
+    Clock submitClock;
+    RenderStats stats {};
+    m_FrameConstants = camera.GetViewProjection();
+
+    PrepareFrameForSubmit(frame, m_FrameConstants, m_SpriteCulling, m_PreparedFrame, stats);
+    for (const SpriteFramePart& part : m_PreparedFrame.parts)
+    {
+        if (part.staticBatch)
+        {
+            // resident already, only the draw call is left
+            ++stats.drawcallCount;
+        }
+        else
+        {
+            EncodeSprites(m_PreparedFrame.sprites, part.firstSprite, part.firstSprite + part.spriteCount, stats);
+        }
+    }
+
+    m_Counters.spriteCount += stats.spriteCount;
+    m_Counters.culledSpriteCount += stats.culledSpriteCount;
+    m_Counters.batchCount += stats.drawcallCount;
+
+    stats.submitTime = submitClock.Tick();
+    return stats;
+}
+
+void RenderContextNull::EncodeSprites(const SpriteDrawList& sprites, usize begin, usize end, RenderStats& outStats)
+{
+    // the batching loop of the DX11 backend with the map and the draw call taken out
+    for (usize spriteIdx = begin; spriteIdx < end;)
+    {
+        ZoneScopedN("Drawcall");
+
+        Clock encodeClock;
+        const usize batchEnd = FindSpriteBatchEnd(sprites, spriteIdx, glm::min(MAX_BATCH_SIZE, end - spriteIdx));
+        const usize spritesInBatch = batchEnd - spriteIdx;
+        const SpriteDrawRequest* batchSprites = sprites.data() + spriteIdx;
+        outStats.AddBatch(spritesInBatch, GetSpriteBatchCut(sprites, batchEnd, end));
+        spriteIdx = batchEnd;
+
+        ++outStats.drawcallCount;
+        const NullTexture* texture = m_Textures.Get(batchSprites->src.texture);
+        const u32 uvRectCount = texture ? texture->uvRectCount : 0;
+        usize batchBytes;
+        if (!m_CompactSpriteInstanceData.empty() && m_CompactEncoder.Prepare(batchSprites, spritesInBatch, uvRectCount))
+        {
+            m_CompactEncoder.Encode(m_CompactSpriteInstanceData.data(), m_CompactBatchConstants);
+            batchBytes = m_CompactEncoder.GetEncodedSize();
+            ++m_Counters.compactBatchCount;
+        }
+        else
+        {
+            EncodeSpriteInstances(batchSprites, spritesInBatch, m_SpriteInstanceData.data());
+            batchBytes = spritesInBatch * sizeof(SpriteInstanceData);
+        }
+
+        // encoding into the stand-in buffers is all the work there is, nothing gets mapped or drawn
+        m_Counters.instanceBytes += batchBytes;
+        outStats.uploadedBytes += batchBytes;
+        outStats.encodeTime += encodeClock.Tick();
+    }
+}
+
+void RenderContextNull::Present()
+{
+    {
+        ZoneScoped;
+
+        if (m_FrameDumper)
+        {
+            m_FrameDumper->EndFrame(*this);
+        }
+
+        ++m_Counters.frameCount;
+
+        TracyPlot("Null Batches", (i64)(m_Counters.batchCount - m_FrameStartCounters.batchCount));
+        TracyPlot("Null Culled Sprites", (i64)(m_Counters.culledSpriteCount - m_FrameStartCounters.culledSpriteCount));
+        TracyPlot("Null Compact Batches", (i64)(m_Counters.compactBatchCount - m_FrameStartCounters.compactBatchCount));
+        TracyPlot("Null Instance Bytes", (i64)(m_Counters.instanceBytes - m_FrameStartCounters.instanceBytes));
+        TracyPlot("Null UI Bytes", (i64)(m_Counters.uiBytes - m_FrameStartCounters.uiBytes));
+
+        m_FrameStartCounters = m_Counters;
+    }
+
+    FrameMark; // notify Tracy Profiler that the frame was rendered
+}
+
+bool RenderContextNull::ReadFrame(Image& outImage)
+{
+    return false;
+}
+
+void RenderContextNull::ImGuiBindingsInit()
+{
+    ImGuiIO& io = ImGui::GetIO();
+    io.BackendRendererName = "cgt_render_null";
+
+    // ImGui doesn't start a frame without a built font atlas, the pixels aren't needed for anything though
+    u8* pixels = nullptr;
+    int width = 0;
+    int height = 0;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+    m_FontTexture = m_Textures.Add(NullTexture { "ImGui font atlas" });
+    io.Fonts->SetTexID(ToImTextureID(m_FontTexture));
+}
+
+void RenderContextNull::ImGuiBindingsNewFrame() {}
+
+void RenderContextNull::ImGuiBindingsRender(ImDrawData* drawData)
+{
+    ZoneScoped;
+
+    for (i32 listIdx = 0; listIdx < drawData->CmdListsCount; ++listIdx)
+    {
+        const ImDrawList* cmdList = drawData->CmdLists[listIdx];
+        m_Counters.uiBytes += cmdList->VtxBuffer.Size * sizeof(ImDrawVert) + cmdList->IdxBuffer.Size * sizeof(ImDrawIdx);
+        m_Counters.uiDrawcallCount += cmdList->CmdBuffer.Size;
+    }
+}
+
+void RenderContextNull::ImGuiBindingsShutdown()
+{
+    m_Textures.Remove(m_FontTexture);
+    m_FontTexture = {};
+}
+
+void RenderContextNull::Im3dBindingsInit() {}
+
+void RenderContextNull::Im3dBindingsNewFrame() {}
+
+void RenderContextNull::Im3dBindingsRender(const ICamera& camera, const Im3d::DrawList* drawLists, u32 drawListCount)
+{
+    ZoneScoped;
+
+    for (u32 listIdx = 0; listIdx < drawListCount; ++listIdx)
+    {
+        const Im3d::DrawList& drawList = drawLists[listIdx];
+        m_Counters.uiBytes += drawList.m_vertexCount * sizeof(Im3d::VertexData);
+        ++m_Counters.uiDrawcallCount;
+    }
+}
+
+void RenderContextNull::Im3dBindingsShutdown() {}
+
+TextureOwner RenderContextNull::LoadTexture(const std::filesystem::path& absolutePath)
+{
+    CGT_ASSERT_ALWAYS_MSG(std::filesystem::exists(absolutePath), "Couldn't create texture from file at {}", absolutePath);
+
+    return std::make_shared<Texture>(*this, m_Textures.Add(NullTexture { absolutePath }));
+}
+
+TextureOwner RenderContextNull::CreateTexture(const Image& image)
+{
+    return std::make_shared<Texture>(*this, m_Textures.Add(NullTexture { fmt::format("{}x{} image", image.width, image.height) }));
+}
+
+void RenderContextNull::ReleaseTexture(TextureHandle texture)
+{
+    m_Textures.Remove(texture);
+}
+
+ImTextureID RenderContextNull::GetImTextureID(TextureHandle texture)
+{
+    return ToImTextureID(texture);
+}
+
+void RenderContextNull::SetTextureUVRects(TextureHandle texture, const std::vector<math::AABB>& uvRects)
+{
+    CGT_ASSERT(uvRects.size() <= SpriteSource::MAX_UV_RECTS);
+
+    NullTexture* nullTexture = m_Textures.Get(texture);
+    CGT_ASSERT(nullTexture != nullptr);
+    if (nullTexture)
+    {
+        nullTexture->uvRectCount = (u32)uvRects.size();
+    }
+}
+
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <engine/window.h>
+#include <render_core/i_render_context.h>
+#include <render_core/i_camera.h>
+#include <render_core/sprite_instance_encoder.h>
+#include <render_core/sprite_culling.h>
+#include <render_core/sprite_frame.h>
+
+namespace cgt::render
+{
+
+// what would have been sent to a GPU, summed up since the context was created
+struct NullRenderCounters
+{
+    u64 frameCount = 0;
+    u64 spriteCount = 0;
+    // dropped by view culling, counted in the sprites too
+    u64 culledSpriteCount = 0;
+    u64 batchCount = 0;
+    u64 instanceBytes = 0;
+    // batches that went out in the compact instance format
+    u64 compactBatchCount = 0;
+
+    u64 uiDrawcallCount = 0;
+    u64 uiBytes = 0;
+};
+
+/*
+ * Render context that never draws anything, meant for measuring the CPU side of rendering without GPU or driver noise.
+ * Submissions go through the same sorting and batching as the DX11 backend, including filling a CPU instance buffer,
+ * the bytes and batches that would have been uploaded are counted and plotted to Tracy every frame.
+ * Textures aren't decoded, only their handles are tracked.
+ */
+class RenderContextNull : public IRenderContext, private NonCopyable
+{
+public:
+    static std::shared_ptr<RenderContextNull> BuildWithConfig(RenderConfig config);
+
+    TextureOwner LoadTexture(const std::filesystem::path& absolutePath) override;
+    TextureOwner CreateTexture(const Image& image) override;
+    ImTextureID GetImTextureID(TextureHandle texture) override;
+    void SetTextureUVRects(TextureHandle texture, const std::vector<math::AABB>& uvRects) override;
+
+    void Clear(glm::vec4 clearColor) override;
+    RenderStats Submit(SpriteDrawList& drawList, const ICamera& camera, bool sortBeforeRendering = true) override;
+    std::unique_ptr<StaticSpriteBatch> CreateStaticBatch(const SpriteDrawList& drawList) override;
+    RenderStats SubmitStaticBatch(const StaticSpriteBatch& batch, const ICamera& camera) override;
+    RenderStats SubmitFrame(const SpriteFrame& frame, const ICamera& camera) override;
+    void Present() override;
+
+    // there are no pixels, frame dumps only get timings
+    bool ReadFrame(Image& outImage) override;
+
+    const NullRenderCounters& GetCounters() const { return m_Counters; }
+
+protected:
+    void ReleaseTexture(TextureHandle texture) override;
+
+    void ImGuiBindingsInit() override;
+    void ImGuiBindingsNewFrame() override;
+    void ImGuiBindingsRender(ImDrawData* drawData) override;
+    void ImGuiBindingsShutdown() override;
+
+    void Im3dBindingsInit() override;
+    void Im3dBindingsNewFrame() override;
+    void Im3dBindingsRender(const ICamera& camera, const Im3d::DrawList* drawLists, u32 drawListCount) override;
+    void Im3dBindingsShutdown() override;
+
+private:
+    // the same limit as the DX11 instance buffer, so batches split in the same places
+    static constexpr usize MAX_BATCH_SIZE = 1024;
+
+    struct NullTexture
+    {
+        std::filesystem::path path;
+        // the size of the uv rect table compact batches of the texture can index
+        u32 uvRectCount = 0;
+    };
+
+    explicit RenderContextNull(std::shared_ptr<Window> window);
+
+    // encodes the sorted sprites from begin to end in batches the way they'd be uploaded
+    void EncodeSprites(const SpriteDrawList& sprites, usize begin, usize end, RenderStats& outStats);
+
+    std::shared_ptr<Window> m_Window;
+    std::unique_ptr<FrameDumper> m_FrameDumper;
+
+    TexturePool<NullTexture> m_Textures;
+    TextureHandle m_FontTexture;
+
+    bool m_SpriteCulling = true;
+    // the visible sprites of the list being submitted
+    SpriteDrawList m_VisibleSprites;
+    std::vector<StaticSpriteBatch::Draw> m_StaticDraws;
+    PreparedSpriteFrame m_PreparedFrame;
+
+    // stands in for the mapped instance buffer, one batch worth of instances
+    std::vector<SpriteInstanceData> m_SpriteInstanceData;
+    // the same for compact batches, empty when the format is turned off
+    std::vector<CompactSpriteInstanceData> m_CompactSpriteInstanceData;
+    CompactSpriteBatchConstants m_CompactBatchConstants;
+    CompactSpriteEncoder m_CompactEncoder;
+    // stands in for the frame constant buffer
+    glm::mat4 m_FrameConstants;
+
+    NullRenderCounters m_Counters;
+    NullRenderCounters m_FrameStartCounters;
+};
+
+}
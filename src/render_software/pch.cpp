@@ -0,0 +1 @@
+#include <render_software/pch.h>
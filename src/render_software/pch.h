@@ -0,0 +1,5 @@
+#pragma once
+
+#include <engine/api.h>
+#include <render_core/api.h>
+#include <render_core/missingno.png.h>
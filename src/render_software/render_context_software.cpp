@@ -0,0 +1,641 @@
+#include <render_software/pch.h>
+
+#include <render_software/render_context_software.h>
+#include <render_core/cpu_static_sprite_batch.h>
+#include <engine/assets.h>
+
+namespace cgt::render
+{
+
+namespace
+{
+
+// handles are small enough to go into the pointer sized texture ids of ImGui directly
+ImTextureID ToImTextureID(TextureHandle texture)
+{
+    return (ImTextureID)(uptr)(((u32)texture.generation << 16) | texture.index);
+}
+
+TextureHandle FromImTextureID(ImTextureID textureId)
+{
+    const uptr packed = (uptr)textureId;
+
+    TextureHandle texture;
+    texture.index = (u16)(packed & 0xFFFF);
+    texture.generation = (u16)((packed >> 16) & 0xFFFF);
+    return texture;
+}
+
+// the texel layout is the same, only the names differ
+SoftwareTexture ToSoftwareTexture(Image image)
+{
+    SoftwareTexture texture;
+    texture.width = image.width;
+    texture.height = image.height;
+    texture.texels = std::move(image.pixels);
+    return texture;
+}
+
+u32 PackColor(glm::vec4 color)
+{
+    const glm::vec4 scaled = glm::clamp(color, glm::vec4(0.0f), glm::vec4(1.0f)) * 255.0f + 0.5f;
+    return (u32)scaled.r | ((u32)scaled.g << 8) | ((u32)scaled.b << 16) | ((u32)scaled.a << 24);
+}
+
+glm::vec4 UnpackImGuiColor(ImU32 color)
+{
+    return glm::vec4(
+        (float)(color & 0xFF),
+        (float)((color >> 8) & 0xFF),
+        (float)((color >> 16) & 0xFF),
+        (float)(color >> 24)) * (1.0f / 255.0f);
+}
+
+// bounds of the pixels whose centers may be covered, clamped to the clip rect
+void SetTriangleBounds(RasterTriangle& triangle, i32 clipMinX, i32 clipMinY, i32 clipMaxX, i32 clipMaxY)
+{
+    const glm::vec2 min = glm::min(triangle.positions[0], glm::min(triangle.positions[1], triangle.positions[2]));
+    const glm::vec2 max = glm::max(triangle.positions[0], glm::max(triangle.positions[1], triangle.positions[2]));
+
+    triangle.minX = (i32)glm::clamp(glm::floor(min.x), (float)clipMinX, (float)clipMaxX);
+    triangle.minY = (i32)glm::clamp(glm::floor(min.y), (float)clipMinY, (float)clipMaxY);
+    triangle.maxX = (i32)glm::clamp(glm::ceil(max.x), (float)clipMinX, (float)clipMaxX);
+    triangle.maxY = (i32)glm::clamp(glm::ceil(max.y), (float)clipMinY, (float)clipMaxY);
+}
+
+// ortho cameras only, world to pixel is affine: pixel = fromWorldX * world.x + fromWorldY * world.y + offset
+struct ScreenTransform
+{
+    glm::vec2 fromWorldX;
+    glm::vec2 fromWorldY;
+    glm::vec2 offset;
+    float width = 0.0f;
+    float height = 0.0f;
+};
+
+ScreenTransform MakeScreenTransform(const glm::mat4& viewProjection, u32 width, u32 height)
+{
+    const float halfWidth = (float)width * 0.5f;
+    const float halfHeight = (float)height * 0.5f;
+
+    ScreenTransform screen;
+    screen.fromWorldX = glm::vec2(viewProjection[0][0] * halfWidth, -viewProjection[0][1] * halfHeight);
+    screen.fromWorldY = glm::vec2(viewProjection[1][0] * halfWidth, -viewProjection[1][1] * halfHeight);
+    screen.offset = glm::vec2((viewProjection[3][0] + 1.0f) * halfWidth, (1.0f - viewProjection[3][1]) * halfHeight);
+    screen.width = (float)width;
+    screen.height = (float)height;
+    return screen;
+}
+
+// rasterizer setup starts from the instances the GPU backends upload, sprites that can't be seen get empty bounds
+void SetUpRasterSprite(const SpriteInstanceData& sprite, const SoftwareTexture* texture, const ScreenTransform& screen, RasterSprite& rasterSprite)
+{
+    rasterSprite.minX = rasterSprite.maxX = 0;
+
+    // the same transform as the vertex shader: scale, rotate, translate, with the quad spanning [-0.5, 0.5]
+    const float angleCos = glm::cos(sprite.rotation);
+    const float angleSin = glm::sin(sprite.rotation);
+    const glm::vec2 quadX = screen.fromWorldX * (angleCos * sprite.scale.x) + screen.fromWorldY * (angleSin * sprite.scale.x);
+    const glm::vec2 quadY = screen.fromWorldX * (-angleSin * sprite.scale.y) + screen.fromWorldY * (angleCos * sprite.scale.y);
+    const glm::vec2 center = screen.offset + screen.fromWorldX * sprite.position.x + screen.fromWorldY * sprite.position.y;
+
+    const float determinant = quadX.x * quadY.y - quadY.x * quadX.y;
+    if (glm::abs(determinant) < 1e-8f || sprite.colorTint.a <= 0.0f)
+    {
+        return;
+    }
+
+    // inverting it gives the quad position of a pixel, x goes along the U axis and y against the V one
+    const float inverseDeterminant = 1.0f / determinant;
+    const glm::vec2 inverseRowX = glm::vec2(quadY.y, -quadY.x) * inverseDeterminant;
+    const glm::vec2 inverseRowY = glm::vec2(-quadX.y, quadX.x) * inverseDeterminant;
+
+    rasterSprite.quadStepX = glm::vec2(inverseRowX.x, -inverseRowY.x);
+    rasterSprite.quadStepY = glm::vec2(inverseRowX.y, -inverseRowY.y);
+    for (u32 axis = 0; axis < 2; ++axis)
+    {
+        const float step = rasterSprite.quadStepX[axis];
+        rasterSprite.inverseQuadStepX[axis] = glm::abs(step) < 1e-12f ? 0.0f : 1.0f / step;
+    }
+    rasterSprite.quadOrigin = glm::vec2(
+        0.5f - (inverseRowX.x * center.x + inverseRowX.y * center.y),
+        0.5f + (inverseRowY.x * center.x + inverseRowY.y * center.y));
+
+    const glm::vec2 textureSize((float)texture->width, (float)texture->height);
+    const glm::vec2 uvScale = sprite.uvMax - sprite.uvMin;
+    rasterSprite.texture = texture;
+    rasterSprite.texelOrigin = (sprite.uvMin + rasterSprite.quadOrigin * uvScale) * textureSize;
+    rasterSprite.texelStepX = rasterSprite.quadStepX * uvScale * textureSize;
+    rasterSprite.texelStepY = rasterSprite.quadStepY * uvScale * textureSize;
+
+    // tints above 1 are clamped, the span filler can't brighten texels
+    const glm::vec4 tint = glm::clamp(sprite.colorTint, glm::vec4(0.0f), glm::vec4(1.0f)) * 256.0f;
+    for (u32 channel = 0; channel < 4; ++channel)
+    {
+        rasterSprite.tint[channel] = (u16)tint[channel];
+    }
+
+    const glm::vec2 extent = (glm::abs(quadX) + glm::abs(quadY)) * 0.5f;
+    rasterSprite.minX = (i32)glm::clamp(glm::floor(center.x - extent.x), 0.0f, screen.width);
+    rasterSprite.minY = (i32)glm::clamp(glm::floor(center.y - extent.y), 0.0f, screen.height);
+    rasterSprite.maxX = (i32)glm::clamp(glm::ceil(center.x + extent.x), 0.0f, screen.width);
+    rasterSprite.maxY = (i32)glm::clamp(glm::ceil(center.y + extent.y), 0.0f, screen.height);
+}
+
+}
+
+std::shared_ptr<IRenderContext> IRenderContext::BuildWithConfig(RenderConfig config)
+{
+    return RenderContextSoftware::BuildWithConfig(std::move(config));
+}
+
+std::shared_ptr<RenderContextSoftware> RenderContextSoftware::BuildWithConfig(RenderConfig config)
+{
+    auto context = std::shared_ptr<RenderContextSoftware>(new RenderContextSoftware(config.GetSDLWindow()));
+    context->m_Offscreen = config.IsOffscreen();
+    context->m_SpriteCulling = config.UseSpriteCulling();
+    if (config.GetFrameDumps())
+    {
+        context->m_FrameDumper = std::make_unique<FrameDumper>(*config.GetFrameDumps());
+    }
+    context->m_MissingTexture = context->LoadTextureFromMemory(MISSINGNO_PNG, sizeof(MISSINGNO_PNG));
+    context->UpdateTargetSize();
+
+    return context;
+}
+
+RenderContextSoftware::RenderContextSoftware(std::shared_ptr<Window> window)
+    : m_Window(std::move(window))
+    , m_JobSystem(std::make_unique<JobSystem>())
+    , m_Rasterizer(*m_JobSystem)
+{
+}
+
+RenderContextSoftware::~RenderContextSoftware() = default;
+
+void RenderContextSoftware::UpdateTargetSize()
+{
+    const u32 width = m_Window->GetWidth();
+    const u32 height = m_Window->GetHeight();
+    if (width != m_Rasterizer.GetWidth() || height != m_Rasterizer.GetHeight())
+    {
+        m_Rasterizer.Resize(width, height);
+    }
+}
+
+void RenderContextSoftware::Clear(glm::vec4 clearColor)
+{
+    ZoneScoped;
+
+    if (m_FrameDumper)
+    {
+        m_FrameDumper->BeginFrame();
+    }
+
+    UpdateTargetSize();
+    m_Rasterizer.Clear(PackColor(clearColor));
+}
+
+RenderStats RenderContextSoftware::Submit(SpriteDrawList& drawList, const ICamera& camera, bool sortBeforeRendering)
+{
+    ZoneScoped;
+
+    Clock submitClock;
+    RenderStats stats {};
+    const glm::mat4 viewProjection = camera.GetViewProjection();
+
+    const SpriteDrawList& sprites = PrepareSpritesForSubmit(drawList, viewProjection, m_SpriteCulling, sortBeforeRendering, m_VisibleSprites, stats);
+    // there are no draw calls, the texture runs are counted instead, which is what the DX11 batches split on
+    stats.drawcallCount = CountTextureRuns(sprites, 0, sprites.size());
+
+    // nothing gets uploaded and there are no batches, setting up the raster sprites counts as encoding
+    Clock phaseClock;
+    m_Sprites.resize(sprites.size());
+    m_SpriteInstances.resize(sprites.size());
+    SetUpSprites(sprites, 0, sprites.size(), viewProjection, m_Sprites.data());
+    stats.encodeTime = phaseClock.Tick();
+
+    m_Rasterizer.DrawSprites(m_Sprites);
+    stats.drawTime = phaseClock.Tick();
+
+    stats.submitTime = submitClock.Tick();
+    return stats;
+}
+
+std::unique_ptr<StaticSpriteBatch> RenderContextSoftware::CreateStaticBatch(const SpriteDrawList& drawList)
+{
+    ZoneScoped;
+
+    return std::make_unique<CpuStaticSpriteBatch>(drawList);
+}
+
+RenderStats RenderContextSoftware::SubmitStaticBatch(const StaticSpriteBatch& batch, const ICamera& camera)
+{
+    ZoneScoped;
+
+    Clock submitClock;
+    RenderStats stats {};
+    const glm::mat4 viewProjection = camera.GetViewProjection();
+
+    Clock phaseClock;
+    m_StaticDraws.clear();
+    const u32 visibleCount = batch.CollectVisibleDraws(ComputeViewBounds(viewProjection), m_StaticDraws);
+    stats.cullTime = phaseClock.Tick();
+    stats.spriteCount = batch.GetSpriteCount();
+    stats.culledSpriteCount = stats.spriteCount - visibleCount;
+    stats.staticSpriteCount = visibleCount;
+    stats.drawcallCount = (u32)m_StaticDraws.size();
+
+    // the instances are already encoded, only the rasterizer setup is left
+    m_Sprites.resize(visibleCount);
+    u32 rasterIdx = 0;
+    for (const StaticSpriteBatch::Draw& draw : m_StaticDraws)
+    {
+        SetUpStaticSprites(batch, draw.texture, draw.firstSprite, draw.spriteCount, viewProjection, m_Sprites.data() + rasterIdx);
+        rasterIdx += draw.spriteCount;
+    }
+    stats.encodeTime = phaseClock.Tick();
+
+    m_Rasterizer.DrawSprites(m_Sprites);
+    stats.drawTime = phaseClock.Tick();
+
+    stats.submitTime = submitClock.Tick();
+    return stats;
+}
+
+RenderStats RenderContextSoftware::SubmitFrame(const SpriteFrame& frame, const ICamera& camera)
+{
+    ZoneScoped;
+
+    Clock submitClock;
+    RenderStats stats {};
+    const glm::mat4 viewProjection = camera.GetViewProjection();
+
+    PrepareFrameForSubmit(frame, viewProjection, m_SpriteCulling, m_PreparedFrame, stats);
+
+    Clock phaseClock;
+    usize rasterCount = 0;
+    for (const SpriteFramePart& part : m_PreparedFrame.parts)
+    {
+        rasterCount += part.spriteCount;
+    }
+
+    // raster sprites go in the order of the parts, the rasterizer blends them in that order
+    const SpriteDrawList& sprites = m_PreparedFrame.sprites;
+    m_Sprites.resize(rasterCount);
+    m_SpriteInstances.resize(sprites.size());
+    usize rasterIdx = 0;
+    for (const SpriteFramePart& part : m_PreparedFrame.parts)
+    {
+        if (part.staticBatch)
+        {
+            ++stats.drawcallCount;
+            SetUpStaticSprites(*part.staticBatch, part.texture, part.firstSprite, part.spriteCount, viewProjection, m_Sprites.data() + rasterIdx);
+        }
+        else
+        {
+            const usize partEnd = part.firstSprite + part.spriteCount;
+            stats.drawcallCount += CountTextureRuns(sprites, part.firstSprite, partEnd);
+            SetUpSprites(sprites, part.firstSprite, partEnd, viewProjection, m_Sprites.data() + rasterIdx);
+        }
+        rasterIdx += part.spriteCount;
+    }
+    stats.encodeTime = phaseClock.Tick();
+
+    m_Rasterizer.DrawSprites(m_Sprites);
+    stats.drawTime = phaseClock.Tick();
+
+    stats.submitTime = submitClock.Tick();
+    return stats;
+}
+
+void RenderContextSoftware::SetUpSprites(const SpriteDrawList& sprites, usize begin, usize end, const glm::mat4& viewProjection, RasterSprite* outSprites)
+{
+    ZoneScopedN("Setup");
+
+    const ScreenTransform screen = MakeScreenTransform(viewProjection, m_Rasterizer.GetWidth(), m_Rasterizer.GetHeight());
+    m_JobSystem->ParallelFor((u32)(end - begin), 4096, [&](u32 jobBegin, u32 jobEnd) {
+        EncodeSpriteInstances(sprites.data() + begin + jobBegin, jobEnd - jobBegin, m_SpriteInstances.data() + begin + jobBegin);
+
+        // the pool is only read while rendering, so the jobs can look textures up on their own
+        for (u32 spriteIdx = jobBegin; spriteIdx < jobEnd; ++spriteIdx)
+        {
+            const SoftwareTexture* texture = &GetTexture(sprites[begin + spriteIdx].src.texture);
+            SetUpRasterSprite(m_SpriteInstances[begin + spriteIdx], texture, screen, outSprites[spriteIdx]);
+        }
+    });
+}
+
+void RenderContextSoftware::SetUpStaticSprites(const StaticSpriteBatch& batch, TextureHandle texture, u32 firstSprite, u32 spriteCount, const glm::mat4& viewProjection, RasterSprite* outSprites)
+{
+    ZoneScopedN("Setup");
+
+    const ScreenTransform screen = MakeScreenTransform(viewProjection, m_Rasterizer.GetWidth(), m_Rasterizer.GetHeight());
+    const SoftwareTexture* softwareTexture = &GetTexture(texture);
+    const SpriteInstanceData* instances = static_cast<const CpuStaticSpriteBatch&>(batch).GetInstances().data() + firstSprite;
+
+    m_JobSystem->ParallelFor(spriteCount, 4096, [&](u32 jobBegin, u32 jobEnd) {
+        for (u32 spriteIdx = jobBegin; spriteIdx < jobEnd; ++spriteIdx)
+        {
+            SetUpRasterSprite(instances[spriteIdx], softwareTexture, screen, outSprites[spriteIdx]);
+        }
+    });
+}
+
+void RenderContextSoftware::Present()
+{
+    {
+        ZoneScoped;
+
+        if (m_FrameDumper)
+        {
+            m_FrameDumper->EndFrame(*this);
+        }
+
+        SDL_Window* sdlWindow = m_Window->GetSDLWindow();
+        SDL_Surface* windowSurface = sdlWindow && !m_Offscreen ? SDL_GetWindowSurface(sdlWindow) : nullptr;
+        if (windowSurface)
+        {
+            const u32 width = m_Rasterizer.GetWidth();
+            const u32 height = m_Rasterizer.GetHeight();
+            SDL_Surface* frame = SDL_CreateRGBSurfaceWithFormatFrom(
+                (void*)m_Rasterizer.GetPixels(),
+                (int)width,
+                (int)height,
+                32,
+                (int)(width * sizeof(u32)),
+                SDL_PIXELFORMAT_RGBA32);
+
+            SDL_BlitSurface(frame, nullptr, windowSurface, nullptr);
+            SDL_FreeSurface(frame);
+            SDL_UpdateWindowSurface(sdlWindow);
+        }
+    }
+
+    FrameMark; // notify Tracy Profiler that the frame was rendered
+}
+
+bool RenderContextSoftware::ReadFrame(Image& outImage)
+{
+    ZoneScoped;
+
+    outImage.width = m_Rasterizer.GetWidth();
+    outImage.height = m_Rasterizer.GetHeight();
+    outImage.pixels.assign(m_Rasterizer.GetPixels(), m_Rasterizer.GetPixels() + (usize)outImage.width * outImage.height);
+
+    return true;
+}
+
+void RenderContextSoftware::ImGuiBindingsInit()
+{
+    ImGuiIO& io = ImGui::GetIO();
+    io.BackendRendererName = "cgt_render_software";
+
+    u8* pixels = nullptr;
+    int width = 0;
+    int height = 0;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+    SoftwareTexture fontTexture;
+    fontTexture.width = (u32)width;
+    fontTexture.height = (u32)height;
+    fontTexture.texels.resize((usize)width * height);
+    std::memcpy(fontTexture.texels.data(), pixels, fontTexture.texels.size() * sizeof(u32));
+
+    m_FontTexture = m_Textures.Add(std::move(fontTexture));
+    io.Fonts->SetTexID(ToImTextureID(m_FontTexture));
+}
+
+void RenderContextSoftware::ImGuiBindingsNewFrame() {}
+
+void RenderContextSoftware::ImGuiBindingsRender(ImDrawData* drawData)
+{
+    ZoneScoped;
+
+    UpdateTargetSize();
+
+    const glm::vec2 displayPosition(drawData->DisplayPos.x, drawData->DisplayPos.y);
+    const glm::vec2 framebufferScale(drawData->FramebufferScale.x, drawData->FramebufferScale.y);
+    const i32 targetWidth = (i32)m_Rasterizer.GetWidth();
+    const i32 targetHeight = (i32)m_Rasterizer.GetHeight();
+
+    m_Triangles.clear();
+    for (int listIdx = 0; listIdx < drawData->CmdListsCount; ++listIdx)
+    {
+        const ImDrawList* cmdList = drawData->CmdLists[listIdx];
+        for (const ImDrawCmd& cmd : cmdList->CmdBuffer)
+        {
+            if (cmd.UserCallback)
+            {
+                if (cmd.UserCallback != ImDrawCallback_ResetRenderState)
+                {
+                    cmd.UserCallback(cmdList, &cmd);
+                }
+                continue;
+            }
+
+            const glm::vec2 clipMin = (glm::vec2(cmd.ClipRect.x, cmd.ClipRect.y) - displayPosition) * framebufferScale;
+            const glm::vec2 clipMax = (glm::vec2(cmd.ClipRect.z, cmd.ClipRect.w) - displayPosition) * framebufferScale;
+            const i32 clipMinX = glm::clamp((i32)clipMin.x, 0, targetWidth);
+            const i32 clipMinY = glm::clamp((i32)clipMin.y, 0, targetHeight);
+            const i32 clipMaxX = glm::clamp((i32)clipMax.x, 0, targetWidth);
+            const i32 clipMaxY = glm::clamp((i32)clipMax.y, 0, targetHeight);
+            if (clipMinX >= clipMaxX || clipMinY >= clipMaxY)
+            {
+                continue;
+            }
+
+            const SoftwareTexture* texture = &GetTexture(FromImTextureID(cmd.TextureId));
+            for (u32 elementIdx = 0; elementIdx + 2 < cmd.ElemCount; elementIdx += 3)
+            {
+                RasterTriangle& triangle = m_Triangles.emplace_back();
+                triangle.texture = texture;
+                for (u32 vertexIdx = 0; vertexIdx < 3; ++vertexIdx)
+                {
+                    const ImDrawVert& vertex = cmdList->VtxBuffer[cmd.VtxOffset + cmdList->IdxBuffer[cmd.IdxOffset + elementIdx + vertexIdx]];
+                    triangle.positions[vertexIdx] = (glm::vec2(vertex.pos.x, vertex.pos.y) - displayPosition) * framebufferScale;
+                    triangle.uvs[vertexIdx] = glm::vec2(vertex.uv.x, vertex.uv.y);
+                    triangle.colors[vertexIdx] = UnpackImGuiColor(vertex.col);
+                }
+
+                SetTriangleBounds(triangle, clipMinX, clipMinY, clipMaxX, clipMaxY);
+            }
+        }
+    }
+
+    m_Rasterizer.DrawTriangles(m_Triangles);
+}
+
+void RenderContextSoftware::ImGuiBindingsShutdown()
+{
+    m_Textures.Remove(m_FontTexture);
+    m_FontTexture = TextureHandle();
+}
+
+void RenderContextSoftware::Im3dBindingsInit() {}
+
+void RenderContextSoftware::Im3dBindingsNewFrame() {}
+
+void RenderContextSoftware::Im3dBindingsRender(const ICamera& camera, const Im3d::DrawList* drawLists, u32 drawListCount)
+{
+    ZoneScoped;
+
+    UpdateTargetSize();
+
+    const glm::mat4 viewProjection = camera.GetViewProjection();
+    const glm::vec2 targetSize((float)m_Rasterizer.GetWidth(), (float)m_Rasterizer.GetHeight());
+    const i32 targetWidth = (i32)m_Rasterizer.GetWidth();
+    const i32 targetHeight = (i32)m_Rasterizer.GetHeight();
+
+    // the same as im3d.hlsl: sizes are in pixels, points and lines thinner than the antialiasing width fade out instead
+    const float ANTIALIASING = 2.0f;
+    auto toScreen = [&](const Im3d::VertexData& vertex)
+    {
+        const glm::vec4 clip = viewProjection * glm::vec4(vertex.m_positionSize.x, vertex.m_positionSize.y, vertex.m_positionSize.z, 1.0f);
+        const glm::vec2 ndc = glm::vec2(clip.x, clip.y) / clip.w;
+        return glm::vec2(ndc.x * 0.5f + 0.5f, 0.5f - ndc.y * 0.5f) * targetSize;
+    };
+    auto toColor = [&](const Im3d::VertexData& vertex, bool fadeThin)
+    {
+        glm::vec4 color(vertex.m_color.getR(), vertex.m_color.getG(), vertex.m_color.getB(), vertex.m_color.getA());
+        if (fadeThin)
+        {
+            color.a *= glm::smoothstep(0.0f, 1.0f, vertex.m_positionSize.w / ANTIALIASING);
+        }
+        return color;
+    };
+    auto addQuad = [&](const glm::vec2 corners[4], const glm::vec4 colors[4])
+    {
+        const u32 indices[] = { 0, 1, 2, 2, 1, 3 };
+        for (u32 triangleIdx = 0; triangleIdx < 2; ++triangleIdx)
+        {
+            RasterTriangle& triangle = m_Triangles.emplace_back();
+            for (u32 vertexIdx = 0; vertexIdx < 3; ++vertexIdx)
+            {
+                triangle.positions[vertexIdx] = corners[indices[triangleIdx * 3 + vertexIdx]];
+                triangle.colors[vertexIdx] = colors[indices[triangleIdx * 3 + vertexIdx]];
+            }
+            SetTriangleBounds(triangle, 0, 0, targetWidth, targetHeight);
+        }
+    };
+
+    m_Triangles.clear();
+    for (u32 listIdx = 0; listIdx < drawListCount; ++listIdx)
+    {
+        const Im3d::DrawList& drawList = drawLists[listIdx];
+        const Im3d::VertexData* vertices = drawList.m_vertexData;
+
+        switch (drawList.m_primType)
+        {
+        case Im3d::DrawPrimitive_Points:
+            // drawn as squares, the pixel shader rounds them off
+            for (u32 i = 0; i < drawList.m_vertexCount; ++i)
+            {
+                const glm::vec2 center = toScreen(vertices[i]);
+                const float halfSize = glm::max(vertices[i].m_positionSize.w, ANTIALIASING) * 0.5f;
+                const glm::vec2 corners[] =
+                    {
+                        center + glm::vec2(-halfSize, -halfSize),
+                        center + glm::vec2(halfSize, -halfSize),
+                        center + glm::vec2(-halfSize, halfSize),
+                        center + glm::vec2(halfSize, halfSize),
+                    };
+                const glm::vec4 color = toColor(vertices[i], true);
+                const glm::vec4 colors[] = { color, color, color, color };
+                addQuad(corners, colors);
+            }
+            break;
+        case Im3d::DrawPrimitive_Lines:
+            for (u32 i = 0; i + 1 < drawList.m_vertexCount; i += 2)
+            {
+                const glm::vec2 start = toScreen(vertices[i]);
+                const glm::vec2 end = toScreen(vertices[i + 1]);
+                if (start == end)
+                {
+                    continue;
+                }
+
+                const glm::vec2 direction = glm::normalize(end - start);
+                const glm::vec2 tangent(-direction.y, direction.x);
+                const glm::vec2 startOffset = tangent * glm::max(vertices[i].m_positionSize.w, ANTIALIASING) * 0.5f;
+                const glm::vec2 endOffset = tangent * glm::max(vertices[i + 1].m_positionSize.w, ANTIALIASING) * 0.5f;
+                const glm::vec2 corners[] = { start - startOffset, start + startOffset, end - endOffset, end + endOffset };
+                const glm::vec4 startColor = toColor(vertices[i], true);
+                const glm::vec4 endColor = toColor(vertices[i + 1], true);
+                const glm::vec4 colors[] = { startColor, startColor, endColor, endColor };
+                addQuad(corners, colors);
+            }
+            break;
+        case Im3d::DrawPrimitive_Triangles:
+            for (u32 i = 0; i + 2 < drawList.m_vertexCount; i += 3)
+            {
+                RasterTriangle& triangle = m_Triangles.emplace_back();
+                for (u32 vertexIdx = 0; vertexIdx < 3; ++vertexIdx)
+                {
+                    triangle.positions[vertexIdx] = toScreen(vertices[i + vertexIdx]);
+                    triangle.colors[vertexIdx] = toColor(vertices[i + vertexIdx], false);
+                }
+                SetTriangleBounds(triangle, 0, 0, targetWidth, targetHeight);
+            }
+            break;
+        default:
+            IM3D_ASSERT(false);
+            break;
+        }
+    }
+
+    m_Rasterizer.DrawTriangles(m_Triangles);
+}
+
+void RenderContextSoftware::Im3dBindingsShutdown() {}
+
+TextureOwner RenderContextSoftware::CreateTexture(const Image& image)
+{
+    CGT_ASSERT_ALWAYS_MSG(!image.pixels.empty(), "Couldn't create an empty texture");
+
+    return std::make_shared<Texture>(*this, m_Textures.Add(ToSoftwareTexture(image)));
+}
+
+TextureOwner RenderContextSoftware::LoadTexture(const std::filesystem::path& absolutePath)
+{
+    auto fileData = LoadFileBytes(absolutePath);
+    SoftwareTexture newTexture = LoadTextureFromMemory(fileData.data(), fileData.size());
+    CGT_ASSERT_ALWAYS_MSG(!newTexture.texels.empty(), "Couldn't create texture from file at {}", absolutePath);
+
+    return std::make_shared<Texture>(*this, m_Textures.Add(std::move(newTexture)));
+}
+
+void RenderContextSoftware::ReleaseTexture(TextureHandle texture)
+{
+    m_Textures.Remove(texture);
+}
+
+SoftwareTexture RenderContextSoftware::LoadTextureFromMemory(const u8* data, usize size)
+{
+    Image image;
+    if (!DecodeImage(data, size, image))
+    {
+        return SoftwareTexture();
+    }
+
+    return ToSoftwareTexture(std::move(image));
+}
+
+ImTextureID RenderContextSoftware::GetImTextureID(TextureHandle texture)
+{
+    return ToImTextureID(texture);
+}
+
+void RenderContextSoftware::SetTextureUVRects(TextureHandle texture, const std::vector<math::AABB>& uvRects)
+{
+    // the rasterizer takes the uvs of every sprite as they are, there's no compact format to look them up for
+    CGT_ASSERT(uvRects.size() <= SpriteSource::MAX_UV_RECTS);
+}
+
+const SoftwareTexture& RenderContextSoftware::GetTexture(TextureHandle texture)
+{
+    const SoftwareTexture* softwareTexture = m_Textures.Get(texture);
+    return softwareTexture ? *softwareTexture : m_MissingTexture;
+}
+
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <engine/window.h>
+#include <render_core/i_render_context.h>
+#include <render_core/i_camera.h>
+#include <render_core/sprite_instance_encoder.h>
+#include <render_core/sprite_culling.h>
+#include <render_core/sprite_frame.h>
+#include <render_software/tile_rasterizer.h>
+
+namespace cgt
+{
+class JobSystem;
+}
+
+namespace cgt::render
+{
+
+/*
+ * Renders everything on the CPU into a RGBA8 color buffer, for platforms without the DX11 backend.
+ * Follows the semantics of the DX11 sprite pipeline: point clamp sampling, non-premultiplied alpha blending.
+ * Cameras have to be orthographic, sprites are rasterized as affine quads.
+ * Present copies the color buffer to the window surface unless it's offscreen, the buffer stays readable either way.
+ */
+class RenderContextSoftware : public IRenderContext, private NonCopyable
+{
+public:
+    static std::shared_ptr<RenderContextSoftware> BuildWithConfig(RenderConfig config);
+
+    ~RenderContextSoftware() override;
+
+    TextureOwner LoadTexture(const std::filesystem::path& absolutePath) override;
+    TextureOwner CreateTexture(const Image& image) override;
+    ImTextureID GetImTextureID(TextureHandle texture) override;
+    void SetTextureUVRects(TextureHandle texture, const std::vector<math::AABB>& uvRects) override;
+
+    void Clear(glm::vec4 clearColor) override;
+    RenderStats Submit(SpriteDrawList& drawList, const ICamera& camera, bool sortBeforeRendering = true) override;
+    std::unique_ptr<StaticSpriteBatch> CreateStaticBatch(const SpriteDrawList& drawList) override;
+    RenderStats SubmitStaticBatch(const StaticSpriteBatch& batch, const ICamera& camera) override;
+    RenderStats SubmitFrame(const SpriteFrame& frame, const ICamera& camera) override;
+    void Present() override;
+
+    bool ReadFrame(Image& outImage) override;
+
+    u32 GetWidth() const { return m_Rasterizer.GetWidth(); }
+    u32 GetHeight() const { return m_Rasterizer.GetHeight(); }
+    const u32* GetPixels() const { return m_Rasterizer.GetPixels(); }
+
+protected:
+    void ReleaseTexture(TextureHandle texture) override;
+
+    void ImGuiBindingsInit() override;
+    void ImGuiBindingsNewFrame() override;
+    void ImGuiBindingsRender(ImDrawData* drawData) override;
+    void ImGuiBindingsShutdown() override;
+
+    void Im3dBindingsInit() override;
+    void Im3dBindingsNewFrame() override;
+    void Im3dBindingsRender(const ICamera& camera, const Im3d::DrawList* drawLists, u32 drawListCount) override;
+    void Im3dBindingsShutdown() override;
+
+private:
+    explicit RenderContextSoftware(std::shared_ptr<Window> window);
+
+    // keeps the color buffer the size of the window
+    void UpdateTargetSize();
+
+    // raster sprites of the sorted sprites from begin to end, encoded into the instances at the same places first
+    void SetUpSprites(const SpriteDrawList& sprites, usize begin, usize end, const glm::mat4& viewProjection, RasterSprite* outSprites);
+    // raster sprites of a draw of a static batch, straight from its instances
+    void SetUpStaticSprites(const StaticSpriteBatch& batch, TextureHandle texture, u32 firstSprite, u32 spriteCount, const glm::mat4& viewProjection, RasterSprite* outSprites);
+
+    SoftwareTexture LoadTextureFromMemory(const u8* data, usize size);
+
+    // the missing texture for null and stale handles
+    const SoftwareTexture& GetTexture(TextureHandle texture);
+
+    std::shared_ptr<Window> m_Window;
+    bool m_Offscreen = false;
+    std::unique_ptr<FrameDumper> m_FrameDumper;
+
+    std::unique_ptr<JobSystem> m_JobSystem;
+    TileRasterizer m_Rasterizer;
+
+    TexturePool<SoftwareTexture> m_Textures;
+    SoftwareTexture m_MissingTexture;
+    TextureHandle m_FontTexture;
+
+    bool m_SpriteCulling = true;
+
+    // kept around between frames, so they don't get reallocated every time
+    SpriteDrawList m_VisibleSprites;
+    std::vector<StaticSpriteBatch::Draw> m_StaticDraws;
+    PreparedSpriteFrame m_PreparedFrame;
+    std::vector<SpriteInstanceData> m_SpriteInstances;
+    std::vector<RasterSprite> m_Sprites;
+    std::vector<RasterTriangle> m_Triangles;
+};
+
+}
@@ -0,0 +1,475 @@
+#include <render_software/pch.h>
+
+#include <render_software/tile_rasterizer.h>
+
+namespace cgt::render
+{
+
+namespace
+{
+
+struct TileRect
+{
+    i32 minX;
+    i32 minY;
+    i32 maxX;
+    i32 maxY;
+};
+
+// exact for everything up to 255 * 255
+inline u32 DivideBy255(u32 value)
+{
+    return (value + 1 + (value >> 8)) >> 8;
+}
+
+// src * srcAlpha + dst * (1 - srcAlpha) for all of the channels, alpha included, like the non-premultiplied blend state
+inline u32 BlendPixel(u32 src, u32 dst)
+{
+    const u32 alpha = src >> 24;
+    if (alpha == 0)
+    {
+        return dst;
+    }
+
+    u32 result = 0;
+    for (u32 shift = 0; shift < 32; shift += 8)
+    {
+        const u32 srcChannel = (src >> shift) & 0xFF;
+        const u32 dstChannel = (dst >> shift) & 0xFF;
+        result |= DivideBy255(srcChannel * alpha + dstChannel * (255 - alpha)) << shift;
+    }
+
+    return result;
+}
+
+// the same rounding as the SIMD path, so both give identical pixels
+inline u32 TintTexel(u32 texel, const u16 tint[4])
+{
+    u32 result = 0;
+    for (u32 channel = 0; channel < 4; ++channel)
+    {
+        const u32 shift = channel * 8;
+        result |= ((((texel >> shift) & 0xFF) * tint[channel]) >> 8) << shift;
+    }
+
+    return result;
+}
+
+inline u32 SampleTexel(const SoftwareTexture& texture, float u, float v)
+{
+    const u32 x = (u32)glm::clamp(u, 0.0f, (float)(texture.width - 1));
+    const u32 y = (u32)glm::clamp(v, 0.0f, (float)(texture.height - 1));
+    return texture.texels[y * texture.width + x];
+}
+
+// std::ceil is a library call without SSE4.1
+inline i32 CeilToInt(float value)
+{
+    const i32 truncated = (i32)value;
+    return truncated + (value > (float)truncated ? 1 : 0);
+}
+
+// narrows [inOutBegin, inOutEnd) down to the pixels with 0 <= origin + step * (x + 0.5) < 1,
+// inverseStep is 1 / step or 0 when step is 0
+void ClipSpan(float origin, float step, float inverseStep, i32& inOutBegin, i32& inOutEnd)
+{
+    if (inverseStep == 0.0f)
+    {
+        if (origin < 0.0f || origin >= 1.0f)
+        {
+            inOutEnd = inOutBegin;
+        }
+        return;
+    }
+
+    float begin = -origin * inverseStep - 0.5f;
+    float end = begin + inverseStep;
+    if (step < 0.0f)
+    {
+        std::swap(begin, end);
+    }
+
+    // clamped as floats first, the bounds can be far outside of the int range for thin sprites
+    begin = glm::clamp(begin, (float)inOutBegin, (float)inOutEnd);
+    end = glm::clamp(end, (float)inOutBegin, (float)inOutEnd);
+    inOutBegin = CeilToInt(begin);
+    inOutEnd = CeilToInt(end);
+}
+
+#if CGT_SIMD_SSE2
+// spans are split at tile edges, the pixels right after the end of one may belong to a tile another thread works on
+inline __m128i LoadPixels(const u32* pixels, i32 count)
+{
+    if (count == 4)
+    {
+        return _mm_loadu_si128((const __m128i*)pixels);
+    }
+
+    alignas(16) u32 lanes[4] = {};
+    std::copy(pixels, pixels + count, lanes);
+    return _mm_load_si128((const __m128i*)lanes);
+}
+
+inline void StorePixels(u32* pixels, __m128i values, i32 count)
+{
+    if (count == 4)
+    {
+        _mm_storeu_si128((__m128i*)pixels, values);
+        return;
+    }
+
+    alignas(16) u32 lanes[4];
+    _mm_store_si128((__m128i*)lanes, values);
+    std::copy(lanes, lanes + count, pixels);
+}
+#endif
+
+void FillSpan(u32* destination, i32 count, const SoftwareTexture& texture, float u, float v, float uStep, float vStep, const u16 tint[4])
+{
+    i32 x = 0;
+
+#if CGT_SIMD_SSE2
+    const __m128 lanes = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+    __m128 us = _mm_add_ps(_mm_set1_ps(u), _mm_mul_ps(lanes, _mm_set1_ps(uStep)));
+    __m128 vs = _mm_add_ps(_mm_set1_ps(v), _mm_mul_ps(lanes, _mm_set1_ps(vStep)));
+    const __m128 usStep = _mm_set1_ps(uStep * 4.0f);
+    const __m128 vsStep = _mm_set1_ps(vStep * 4.0f);
+
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 maxU = _mm_set1_ps((float)(texture.width - 1));
+    const __m128 maxV = _mm_set1_ps((float)(texture.height - 1));
+    const __m128i pitch = _mm_set1_epi32((i32)(texture.width << 16 | 1));
+
+    const __m128i zeroInt = _mm_setzero_si128();
+    const __m128i maxAlpha = _mm_set1_epi16(255);
+    const __m128i tints = _mm_setr_epi16(tint[0], tint[1], tint[2], tint[3], tint[0], tint[1], tint[2], tint[3]);
+    const __m128i opaqueAlpha = _mm_set1_epi32(255);
+    const bool isWhiteTint = tint[0] == 256 && tint[1] == 256 && tint[2] == 256 && tint[3] == 256;
+
+    const u32* texels = texture.texels.data();
+
+    // the last group of a span is partial, lanes past its end sample clamped texels but never touch the target
+    for (; x < count; x += 4)
+    {
+        const i32 pixelCount = glm::min(count - x, 4);
+
+        // clamping before the truncation makes it a floor, then x + y * width is a single multiply-add of 16 bit pairs
+        const __m128i texelU = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(us, zero), maxU));
+        const __m128i texelV = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(vs, zero), maxV));
+        const __m128i indices = _mm_madd_epi16(_mm_or_si128(texelU, _mm_slli_epi32(texelV, 16)), pitch);
+        us = _mm_add_ps(us, usStep);
+        vs = _mm_add_ps(vs, vsStep);
+
+        const __m128i src = _mm_setr_epi32(
+            texels[_mm_cvtsi128_si32(indices)],
+            texels[_mm_cvtsi128_si32(_mm_shuffle_epi32(indices, _MM_SHUFFLE(1, 1, 1, 1)))],
+            texels[_mm_cvtsi128_si32(_mm_shuffle_epi32(indices, _MM_SHUFFLE(2, 2, 2, 2)))],
+            texels[_mm_cvtsi128_si32(_mm_shuffle_epi32(indices, _MM_SHUFFLE(3, 3, 3, 3)))]);
+
+        // untinted opaque texels, which is most of them, replace what's there
+        if (isWhiteTint && _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_srli_epi32(src, 24), opaqueAlpha)) == 0xFFFF)
+        {
+            StorePixels(destination + x, src, pixelCount);
+            continue;
+        }
+
+        // two pixels per register as 16 bit channels, (texel << 8) * tint >> 16 is texel * tint >> 8
+        __m128i srcLow = _mm_mulhi_epu16(_mm_slli_epi16(_mm_unpacklo_epi8(src, zeroInt), 8), tints);
+        __m128i srcHigh = _mm_mulhi_epu16(_mm_slli_epi16(_mm_unpackhi_epi8(src, zeroInt), 8), tints);
+
+        // alpha of each pixel in all four of its channels
+        const __m128i alphaLow = _mm_shufflehi_epi16(_mm_shufflelo_epi16(srcLow, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        const __m128i alphaHigh = _mm_shufflehi_epi16(_mm_shufflelo_epi16(srcHigh, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_or_si128(alphaLow, alphaHigh), zeroInt)) == 0xFFFF)
+        {
+            continue;
+        }
+
+        const __m128i dst = LoadPixels(destination + x, pixelCount);
+        const __m128i dstLow = _mm_unpacklo_epi8(dst, zeroInt);
+        const __m128i dstHigh = _mm_unpackhi_epi8(dst, zeroInt);
+
+        // src * a + dst * (255 - a) is at most 255 * 255, so it fits into unsigned 16 bits
+        __m128i blendLow = _mm_add_epi16(_mm_mullo_epi16(srcLow, alphaLow), _mm_mullo_epi16(dstLow, _mm_sub_epi16(maxAlpha, alphaLow)));
+        __m128i blendHigh = _mm_add_epi16(_mm_mullo_epi16(srcHigh, alphaHigh), _mm_mullo_epi16(dstHigh, _mm_sub_epi16(maxAlpha, alphaHigh)));
+
+        const __m128i one = _mm_set1_epi16(1);
+        blendLow = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(blendLow, one), _mm_srli_epi16(blendLow, 8)), 8);
+        blendHigh = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(blendHigh, one), _mm_srli_epi16(blendHigh, 8)), 8);
+
+        StorePixels(destination + x, _mm_packus_epi16(blendLow, blendHigh), pixelCount);
+    }
+#else
+    for (; x < count; ++x)
+    {
+        const u32 texel = SampleTexel(texture, u + uStep * (float)x, v + vStep * (float)x);
+        destination[x] = BlendPixel(TintTexel(texel, tint), destination[x]);
+    }
+#endif
+}
+
+void RasterizeSprite(const RasterSprite& sprite, const TileRect& tile, u32* pixels, u32 pitch)
+{
+    const i32 minX = glm::max(sprite.minX, tile.minX);
+    const i32 maxX = glm::min(sprite.maxX, tile.maxX);
+    const i32 minY = glm::max(sprite.minY, tile.minY);
+    const i32 maxY = glm::min(sprite.maxY, tile.maxY);
+
+    for (i32 y = minY; y < maxY; ++y)
+    {
+        const float pixelY = (float)y + 0.5f;
+
+        i32 begin = minX;
+        i32 end = maxX;
+        ClipSpan(sprite.quadOrigin.x + sprite.quadStepY.x * pixelY, sprite.quadStepX.x, sprite.inverseQuadStepX.x, begin, end);
+        ClipSpan(sprite.quadOrigin.y + sprite.quadStepY.y * pixelY, sprite.quadStepX.y, sprite.inverseQuadStepX.y, begin, end);
+        if (begin >= end)
+        {
+            continue;
+        }
+
+        const float pixelX = (float)begin + 0.5f;
+        const float u = sprite.texelOrigin.x + sprite.texelStepY.x * pixelY + sprite.texelStepX.x * pixelX;
+        const float v = sprite.texelOrigin.y + sprite.texelStepY.y * pixelY + sprite.texelStepX.y * pixelX;
+
+        FillSpan(pixels + y * pitch + begin, end - begin, *sprite.texture, u, v, sprite.texelStepX.x, sprite.texelStepX.y, sprite.tint);
+    }
+}
+
+inline float EdgeFunction(glm::vec2 a, glm::vec2 b, glm::vec2 point)
+{
+    return (b.x - a.x) * (point.y - a.y) - (b.y - a.y) * (point.x - a.x);
+}
+
+// a shared edge goes in opposite directions in the two triangles, so exactly one of them owns the pixels right on it
+inline bool IsOwnedEdge(glm::vec2 a, glm::vec2 b)
+{
+    return b.y > a.y || (b.y == a.y && b.x < a.x);
+}
+
+inline u32 PackColor(glm::vec4 color)
+{
+    const glm::vec4 scaled = glm::clamp(color, glm::vec4(0.0f), glm::vec4(1.0f)) * 255.0f + 0.5f;
+    return (u32)scaled.r | ((u32)scaled.g << 8) | ((u32)scaled.b << 16) | ((u32)scaled.a << 24);
+}
+
+inline glm::vec4 UnpackColor(u32 color)
+{
+    return glm::vec4(
+        (float)(color & 0xFF),
+        (float)((color >> 8) & 0xFF),
+        (float)((color >> 16) & 0xFF),
+        (float)(color >> 24)) * (1.0f / 255.0f);
+}
+
+void RasterizeTriangle(const RasterTriangle& triangle, const TileRect& tile, u32* pixels, u32 pitch)
+{
+    const i32 minX = glm::max(triangle.minX, tile.minX);
+    const i32 maxX = glm::min(triangle.maxX, tile.maxX);
+    const i32 minY = glm::max(triangle.minY, tile.minY);
+    const i32 maxY = glm::min(triangle.maxY, tile.maxY);
+    if (minX >= maxX || minY >= maxY)
+    {
+        return;
+    }
+
+    // culling is off, the winding is flipped to make the inside positive
+    u32 i0 = 0;
+    u32 i1 = 1;
+    u32 i2 = 2;
+    float area = EdgeFunction(triangle.positions[0], triangle.positions[1], triangle.positions[2]);
+    if (area < 0.0f)
+    {
+        std::swap(i1, i2);
+        area = -area;
+    }
+    if (area == 0.0f)
+    {
+        return;
+    }
+
+    const glm::vec2 p0 = triangle.positions[i0];
+    const glm::vec2 p1 = triangle.positions[i1];
+    const glm::vec2 p2 = triangle.positions[i2];
+    const bool owns0 = IsOwnedEdge(p1, p2);
+    const bool owns1 = IsOwnedEdge(p2, p0);
+    const bool owns2 = IsOwnedEdge(p0, p1);
+
+    // how the edge functions change per pixel
+    const glm::vec2 step0(p1.y - p2.y, p2.x - p1.x);
+    const glm::vec2 step1(p2.y - p0.y, p0.x - p2.x);
+    const glm::vec2 step2(p0.y - p1.y, p1.x - p0.x);
+
+    const float inverseArea = 1.0f / area;
+    const glm::vec2 uv0 = triangle.uvs[i0];
+    const glm::vec2 uv1 = triangle.uvs[i1];
+    const glm::vec2 uv2 = triangle.uvs[i2];
+    const glm::vec4 color0 = triangle.colors[i0];
+    const glm::vec4 color1 = triangle.colors[i1];
+    const glm::vec4 color2 = triangle.colors[i2];
+
+    const bool isSolidColor = color0 == color1 && color1 == color2;
+    const u32 solidColor = PackColor(color0);
+
+    const SoftwareTexture* texture = triangle.texture;
+    const glm::vec2 textureSize = texture ? glm::vec2((float)texture->width, (float)texture->height) : glm::vec2(0.0f);
+
+    for (i32 y = minY; y < maxY; ++y)
+    {
+        const glm::vec2 rowStart((float)minX + 0.5f, (float)y + 0.5f);
+        float w0 = EdgeFunction(p1, p2, rowStart);
+        float w1 = EdgeFunction(p2, p0, rowStart);
+        float w2 = EdgeFunction(p0, p1, rowStart);
+
+        u32* row = pixels + y * pitch;
+        for (i32 x = minX; x < maxX; ++x, w0 += step0.x, w1 += step1.x, w2 += step2.x)
+        {
+            const bool isInside = (w0 > 0.0f || (w0 == 0.0f && owns0))
+                && (w1 > 0.0f || (w1 == 0.0f && owns1))
+                && (w2 > 0.0f || (w2 == 0.0f && owns2));
+            if (!isInside)
+            {
+                continue;
+            }
+
+            const float b0 = w0 * inverseArea;
+            const float b1 = w1 * inverseArea;
+            const float b2 = w2 * inverseArea;
+
+            u32 color = isSolidColor ? solidColor : PackColor(color0 * b0 + color1 * b1 + color2 * b2);
+            if (texture)
+            {
+                const glm::vec2 texel = (uv0 * b0 + uv1 * b1 + uv2 * b2) * textureSize;
+                const u32 sample = SampleTexel(*texture, texel.x, texel.y);
+
+                // white texels are what most of the UI is drawn with, those leave the color as is
+                if (sample != 0xFFFFFFFF)
+                {
+                    color = PackColor(UnpackColor(sample) * UnpackColor(color));
+                }
+            }
+
+            row[x] = BlendPixel(color, row[x]);
+        }
+    }
+}
+
+}
+
+TileRasterizer::TileRasterizer(JobSystem& jobSystem)
+    : m_JobSystem(jobSystem)
+{
+}
+
+void TileRasterizer::Resize(u32 width, u32 height)
+{
+    m_Width = width;
+    m_Height = height;
+    m_TileCountX = ((i32)width + TILE_SIZE - 1) / TILE_SIZE;
+    m_TileCountY = ((i32)height + TILE_SIZE - 1) / TILE_SIZE;
+    m_Pixels.assign((usize)width * height, 0);
+}
+
+void TileRasterizer::Clear(u32 color)
+{
+    ZoneScoped;
+
+    m_JobSystem.ParallelFor(m_Height, TILE_SIZE, [&](u32 begin, u32 end) {
+        std::fill(m_Pixels.begin() + begin * m_Width, m_Pixels.begin() + end * m_Width, color);
+    });
+}
+
+void TileRasterizer::DrawSprites(const std::vector<RasterSprite>& sprites)
+{
+    ZoneScoped;
+
+    BinPrimitives(sprites);
+    RasterizeTiles(sprites, [](const RasterSprite& sprite, const TileRect& tile, u32* pixels, u32 pitch) {
+        RasterizeSprite(sprite, tile, pixels, pitch);
+    });
+}
+
+void TileRasterizer::DrawTriangles(const std::vector<RasterTriangle>& triangles)
+{
+    ZoneScoped;
+
+    BinPrimitives(triangles);
+    RasterizeTiles(triangles, [](const RasterTriangle& triangle, const TileRect& tile, u32* pixels, u32 pitch) {
+        RasterizeTriangle(triangle, tile, pixels, pitch);
+    });
+}
+
+template<typename TPrimitive>
+void TileRasterizer::BinPrimitives(const std::vector<TPrimitive>& primitives)
+{
+    ZoneScoped;
+
+    // counting pass first, so all of the tiles share one array instead of a vector each
+    const i32 tileCount = m_TileCountX * m_TileCountY;
+    m_TileOffsets.assign(tileCount + 1, 0);
+
+    auto forEachTile = [&](const TPrimitive& primitive, auto&& function)
+    {
+        if (primitive.minX >= primitive.maxX || primitive.minY >= primitive.maxY)
+        {
+            return;
+        }
+
+        const i32 tileMaxX = (primitive.maxX - 1) / TILE_SIZE;
+        const i32 tileMaxY = (primitive.maxY - 1) / TILE_SIZE;
+        for (i32 tileY = primitive.minY / TILE_SIZE; tileY <= tileMaxY; ++tileY)
+        {
+            for (i32 tileX = primitive.minX / TILE_SIZE; tileX <= tileMaxX; ++tileX)
+            {
+                function(tileY * m_TileCountX + tileX);
+            }
+        }
+    };
+
+    for (const TPrimitive& primitive : primitives)
+    {
+        forEachTile(primitive, [&](i32 tileIdx) { ++m_TileOffsets[tileIdx + 1]; });
+    }
+
+    for (i32 tileIdx = 0; tileIdx < tileCount; ++tileIdx)
+    {
+        m_TileOffsets[tileIdx + 1] += m_TileOffsets[tileIdx];
+    }
+
+    m_TilePrimitives.resize(m_TileOffsets[tileCount]);
+    m_TileCursors.assign(m_TileOffsets.begin(), m_TileOffsets.end() - 1);
+    for (u32 primitiveIdx = 0; primitiveIdx < (u32)primitives.size(); ++primitiveIdx)
+    {
+        forEachTile(primitives[primitiveIdx], [&](i32 tileIdx) { m_TilePrimitives[m_TileCursors[tileIdx]++] = primitiveIdx; });
+    }
+}
+
+template<typename TPrimitive, typename TFunction>
+void TileRasterizer::RasterizeTiles(const std::vector<TPrimitive>& primitives, TFunction&& rasterize)
+{
+    ZoneScoped;
+
+    const u32 tileCount = (u32)(m_TileCountX * m_TileCountY);
+    m_JobSystem.ParallelFor(tileCount, 1, [&](u32 begin, u32 end) {
+        ZoneScopedN("Tile");
+
+        for (u32 tileIdx = begin; tileIdx < end; ++tileIdx)
+        {
+            const i32 tileX = (i32)tileIdx % m_TileCountX;
+            const i32 tileY = (i32)tileIdx / m_TileCountX;
+
+            TileRect tile {};
+            tile.minX = tileX * TILE_SIZE;
+            tile.minY = tileY * TILE_SIZE;
+            tile.maxX = glm::min(tile.minX + TILE_SIZE, (i32)m_Width);
+            tile.maxY = glm::min(tile.minY + TILE_SIZE, (i32)m_Height);
+
+            for (u32 i = m_TileOffsets[tileIdx]; i < m_TileOffsets[tileIdx + 1]; ++i)
+            {
+                rasterize(primitives[m_TilePrimitives[i]], tile, m_Pixels.data(), m_Width);
+            }
+        }
+    });
+}
+
+}
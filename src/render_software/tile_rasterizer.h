@@ -0,0 +1,110 @@
+#pragma once
+
+namespace cgt
+{
+class JobSystem;
+}
+
+namespace cgt::render
+{
+
+// RGBA8 with red in the lowest byte, the same layout as ImGui vertex colors
+struct SoftwareTexture
+{
+    u32 width = 0;
+    u32 height = 0;
+    std::vector<u32> texels;
+};
+
+/*
+ * Sprite quad set up for rasterization, everything is an affine function of the pixel position.
+ * The quad coordinates are within [0, 1) inside the quad, the texel coordinates are what the point sampler reads.
+ */
+struct RasterSprite
+{
+    const SoftwareTexture* texture = nullptr;
+
+    glm::vec2 quadOrigin;
+    glm::vec2 quadStepX;
+    glm::vec2 quadStepY;
+    // 0 for steps of 0, spans are clipped by multiplying with it
+    glm::vec2 inverseQuadStepX;
+
+    glm::vec2 texelOrigin;
+    glm::vec2 texelStepX;
+    glm::vec2 texelStepY;
+
+    // 8.8 fixed point rgba, 256 is 1.0
+    u16 tint[4];
+
+    // pixel bounds clipped to the target, max is exclusive and empty bounds skip the sprite
+    i32 minX = 0;
+    i32 minY = 0;
+    i32 maxX = 0;
+    i32 maxY = 0;
+};
+
+// screen space triangle with interpolated UVs and colors, what ImGui and Im3d get drawn with
+struct RasterTriangle
+{
+    // null samples as opaque white
+    const SoftwareTexture* texture = nullptr;
+
+    glm::vec2 positions[3];
+    glm::vec2 uvs[3];
+    glm::vec4 colors[3];
+
+    // the same as for sprites, already includes the clip rect
+    i32 minX = 0;
+    i32 minY = 0;
+    i32 maxX = 0;
+    i32 maxY = 0;
+};
+
+/*
+ * Color target split into square tiles that are rasterized in parallel, one job per tile.
+ * Primitives are binned into all of the tiles their bounds touch and drawn in submission order within a tile,
+ * so blending gives the same result as drawing them one after another.
+ * Everything is blended as non-premultiplied alpha and sampled with a point clamp sampler, like the DX11 sprite pipeline.
+ */
+class TileRasterizer : private NonCopyable
+{
+public:
+    static constexpr i32 TILE_SIZE = 128;
+
+    explicit TileRasterizer(JobSystem& jobSystem);
+
+    void Resize(u32 width, u32 height);
+    void Clear(u32 color);
+
+    void DrawSprites(const std::vector<RasterSprite>& sprites);
+    void DrawTriangles(const std::vector<RasterTriangle>& triangles);
+
+    u32 GetWidth() const { return m_Width; }
+    u32 GetHeight() const { return m_Height; }
+
+    // RGBA8 rows without any padding
+    const u32* GetPixels() const { return m_Pixels.data(); }
+
+private:
+    template<typename TPrimitive>
+    void BinPrimitives(const std::vector<TPrimitive>& primitives);
+
+    template<typename TPrimitive, typename TFunction>
+    void RasterizeTiles(const std::vector<TPrimitive>& primitives, TFunction&& rasterize);
+
+    JobSystem& m_JobSystem;
+
+    u32 m_Width = 0;
+    u32 m_Height = 0;
+    i32 m_TileCountX = 0;
+    i32 m_TileCountY = 0;
+    std::vector<u32> m_Pixels;
+
+    // primitive indices of all tiles back to back, the ones of tile i start at m_TileOffsets[i]
+    std::vector<u32> m_TileOffsets;
+    std::vector<u32> m_TilePrimitives;
+    std::vector<u32> m_TileCursors;
+};
+
+}